@@ -1,2198 +1,1494 @@
 /*
- * Kód k bakalářské práci v jazyce C++.
+ * Kód k bakalářské práci v jazyce C++ - program bakalarka, klient knihovny libbakalarka (bakalarka.h).
  * Autor: Ondřej Polanský
  * FIT VUT
  * Brno 24.04.2020
  * Obsah:
-        datové struktury
-        parsování automatů ze vstupu
-        výpisové funkce
-        jednotlivé implementace algoritmů
-        funkce main a měření
+        počítání alokací
+        měření
+        pipeline a server
+        funkce main
 */
 
-#include <iostream>
-#include <vector>
-#include <list>
-#include <queue>
-#include <stack>
-#include <map>
-#include <set>
-#include <unordered_set>
+#include "bakalarka.h"
+
 #include <unordered_map>
-#include <utility>
-#include <string>
 #include <algorithm>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <new>
+#include <cstdlib>
+#include <malloc.h>
+#include <functional>
+#include <cctype>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <unistd.h>
+
+using bakalarka::stats;       // counters of the library (--stats, --memory)
+using bakalarka::memory;
 
 //#define MAIN_DEBUG
-//#define PARSE_DEBUG
-//#define EMPTINESS_DEBUG
-//#define USELESS_DEBUG
-//#define INTERSECTION_DEBUG
-//#define DETERMINIZATION_DEBUG
-//#define MINIMALIZATION_DEBUG
-//#define REDUCTION_DEBUG
-//#define UNIVERSALITY_DEBUG
-//#define INCLUSION_DEBUG
-
-//#define DETERMINIZATION_FAIL_SWITCH
 
 
 // --------------------------------------------------------------------------------
 //                              DATA STRUCTURES
 // --------------------------------------------------------------------------------
 
-// structure containing information about state
-typedef struct st{
-    std::string name;                                               // name of the state
-    std::multimap<std::string, struct st *> transit_states_p;              // map of following states and transition rules - (alphabet letter,pointer)
-    std::multimap<std::string, struct st *> reversed_transit_states_p;     // map of reversed transit. states and transition rules - (alphabet letter,pointer)
-    bool final_st = false;                                          // true -> state is final, else -> false
-    bool start_st = false;                                          // true -> state is start, else -> false
-    bool visited = false;                                           // true -> state was visited, else -> false
-    short int flag = 0;                                             // flag for multiple purposes
-    std::map<std::string, int> card;                                // compute cardinality (NFA reduction - Ilie)
-} State;
-
-// structure containing information about finite automaton
+// node of the pipeline expression DAG (-q)
 typedef struct {
-    std::string name;                                       // name of the automaton
-    std::list<State> states;
-    std::vector<std::string> alphabet;                      // vector of alphabet
-    std::multimap<std::pair<std::string, std::string>, std::string> transitions;   // table of transitions - not used
-    std::multimap<std::pair<std::string, std::string>, std::string> reversed_transitions;   // table of reversed transitions - not used
-    std::vector<State *> start_states;                      // vector of starting states - pointers
-    std::set<State *> final_states;                         // set of final states - pointers
-} FA;
-
-// structure used in Intersection algorithm
+    std::string op;                     // "input", "&", "|" or the name of a unary operation (det, detc, min, trim, reduce, bisim, compl)
+    std::vector<std::size_t> children;  // indexes of operand nodes
+    std::size_t uses;                   // number of consumers that did not use the value yet
+    bool evaluated;
+    Shared_FA value;                    // result of the node, released when uses drops to 0
+} Pipeline_node;
+
+// automaton of the server store with derived data computed on the first use
 typedef struct {
-    State * first;                  // state from FA A
-    State * second;                 // state from FA B
-    State * source;                 // already pushed state from FA A&B
-} Inters_help;
-
-// structure used in Determinization algorithm
+    FA original;
+    FA reduced;                     // Reduction_NFA of the automaton
+    bool reduced_ready = false;
+    std::unordered_set<std::pair<std::string,std::string>, pair_hash> preorder;    // simulation on the reduced automaton
+    bool preorder_ready = false;
+    FA minimal;                     // minimal DFA (membership)
+    bool minimal_ready = false;
+} Stored_FA;
+
+// pair of automatons of the server store prepared for inclusion (copies, their union and simulation on the union)
 typedef struct {
-    std::vector<State *> states;    // states to merge
-    State * source;                 // already pushed merged state
-} Determin_help;
+    FA first;
+    FA second;
+    FA united;
+    std::unordered_set<std::pair<std::string,std::string>, pair_hash> preorder;
+} Inclusion_pair;
 
-// structure used in Minimalization algorithm
-typedef struct {
-    State * source;
-    std::string letter;
-    State * target;
-} Minimal_help;
+// --------------------------------------------------------------------------------
+//                              MEMORY ACCOUNTING
+// --------------------------------------------------------------------------------
 
-// structure used in Universality and Inclusion algorithm
-typedef struct {
-    std::vector<State *> states;    // states of a macro state
-    bool rejecting;                 // indicates if macro state is accepting or rejecting
-} Macro_state;
+// The allocation hook (global operator new/delete) is compiled only into the instrumented program bakalarka_memory
+// (make bakalarka_memory, -DMEMORY_HOOK). Every allocation pays the header of the block, malloc_usable_size and an atomic
+// add (5-20 % of the run time of -s on a 150-state NFA), so the benchmarked program bakalarka is built without it and
+// its --memory prints only peak RSS and footprints of the structures. The std::align_val_t forms are not replaced,
+// over-aligned allocations (the program makes none) are not counted.
+#ifdef MEMORY_HOOK
+const bool memory_hook = true;
 
-// structure used in Inclusion algorithm
+// live bytes of the blocks allocated by the threads of one slot, a block freed by another thread (batch workers free
+// the parsed automatons, the main thread frees their results) is subtracted from the slot of its owner
 typedef struct {
-    State *a1_st;                   // state from first automaton
-    Macro_state macro_st;           // macro state in second automaton
-    bool rejecting;                 // indicates if product state is accepting or rejecting
-} Product_state;
-
-// rule for computing hash in unordered_set
-struct pair_hash
+    alignas(64) std::atomic<std::int64_t> bytes;    // own cache line, threads do not share it
+} Live_slot;
+
+const std::size_t memory_header = 16;               // slot of the owner stored before the block, keeps the alignment of malloc
+const std::uint32_t memory_slots = 256;             // threads share slots modulo memory_slots
+Live_slot live_bytes[memory_slots];
+std::atomic<std::uint32_t> memory_next_slot(0);
+thread_local std::uint32_t memory_slot = memory_next_slot++ % memory_slots;
+
+// Function returns live bytes of the blocks allocated by the calling thread.
+// returns: bytes
+inline std::int64_t Live_bytes()
 {
-    std::size_t operator () (std::pair<std::string,std::string> const &p) const
-    {
-        std::size_t h1 = std::hash<std::string>()(p.first);
-        std::size_t h2 = std::hash<std::string>()(p.second);
-
-        return h1^h2;
-    }
-};
-
-// --------------------------------------------------------------------------------
-//                              AUTOMATON PARSER
-// --------------------------------------------------------------------------------
+    return live_bytes[memory_slot].bytes.load(std::memory_order_relaxed);
+}
 
-// Parses automaton from stdin and saves them into corresponding structures. Saves automatons into Automatons. Expects correct format.
-// input: Automatons - reference to vector<FA>
-// returns: void
-void parse_FA_stdin(std::vector<FA> &Automatons)
+// Global allocation functions count all allocations of the program. Sizes are taken from malloc_usable_size, the header
+// of the block holds the slot of the allocating thread. Array, nothrow and sized forms call these by default.
+// They are not inlined into the containers (GCC would report malloc/free as mismatched with new/delete).
+[[gnu::noinline]] void *operator new(std::size_t size)
 {
-    std::vector<std::string> alphabet;  // vector of alphabet
-    std::string word;                   // word received from stdin
-    int state = 0;                      // state of the parsing automaton
-    short int counter = 0;              // variable for transition parsing
-    bool start_state = false;           // variable for start state parsing
-    std::string transit_letter;         // variable for transition parsing
-    std::string source_state;           // variable for transition parsing
-    std::string target_state;           // variable for transition parsing
-
-    // reads words from stdin and parses them
-    while(std::cin >> word)
-    {
-        #ifdef PARSE_DEBUG
-            std::cout << word << std::endl;
-        #endif
-
-        // states of the automaton
-        if(word == "Ops" && state == 6) {alphabet.clear();state = 1;continue;}              // idle
-        else if(word == "Ops" && state == 0) {state = 1;continue;}                          // alphabet
-        else if(word == "Automaton" && (state == 1 || state == 6)) {state = 2;continue;}    // automaton name
-        else if(word == "States" && state == 2) {state = 3;continue;}                       // states
-        else if(word == "Final" && state == 3) {state = 4;continue;}
-        else if(word == "States" && state == 4) {state = 5;continue;}                       // final states
-        else if(word == "Transitions" && state == 5) {state = 6;continue;}                  // transitions
-
-        if(state == 1) // reads alphabet
-        {
-            if(word[word.find(":")+1] != '1') continue;    // automaton accepts only unary symbols (a:1)
-            alphabet.push_back(word.substr(0, word.find(":")));    // alphabet symbol is the first one
-        }
-        else if(state == 2) // reads name of the automaton and assigns the alphabet
-        {
-            FA automaton;
-            Automatons.push_back(automaton);
-            Automatons.back().name = word;
-            std::sort(alphabet.begin(), alphabet.end());
-            Automatons.back().alphabet = alphabet;
-        }
-        else if(state == 3) // reads a list of states
-        {
-            State st;
-            st.name = word;
-            st.visited = false;
-            st.start_st = false;
-            st.final_st = false;
-            st.flag = 0;
-            Automatons.back().states.push_back(st);
-        }
-        else if(state == 5) // reads a list of final states
-        {
-            // finds state in the vector of states and pushes pointer to the state
-            for(auto i = Automatons.back().states.begin(); i != Automatons.back().states.end();++i)
-                if(i->name == word)
-                {
-                    i->final_st = true;
-                    Automatons.back().final_states.insert(&(*i));
-                    break;
-                }
-        }
-        else if(state == 6) // parses transitions
-        {
-            if(counter == 0)                                        // left side of a(p)->q
-            {
-                if(word.find("(") == std::string::npos)             // start state
-                {
-                    start_state = true;
-                }
-                else                                                // normal transition
-                {
-                    std::size_t bracket_start = word.find("(");
-                    std::size_t bracket_end = word.find(")");
-                    transit_letter = word.substr(0, bracket_start);// word = "a01(p)"
-                    source_state = word.substr(bracket_start+1, bracket_end-bracket_start-1);
-                    #ifdef PARSE_DEBUG
-                        std::cout << "TRANSIT: " << transit_letter << " SOURCE STATE: " + source_state << std::endl;
-                    #endif
-                }
-                counter++;
-            }
-            else if(counter == 1)                                   // arrow in a(p)->q
-            {
-                counter++;
-                continue;
-            }
-            else                                                    // right side of a(p)->q
-            {
-                target_state = word;
-                #ifdef PARSE_DEBUG
-                    std::cout << "TARGET: " + target_state << std::endl;
-                #endif
-
-                if(!start_state)    // is not a start state
-                {
-                    Automatons.back().transitions.insert({{source_state,transit_letter},target_state}); // fill the transition multimap
-                    Automatons.back().reversed_transitions.insert({{target_state,transit_letter},source_state}); // fill the reversed transition multimap
-
-                    for(auto i = Automatons.back().states.begin(); i != Automatons.back().states.end(); ++i)                    // fill the optimalised transition tree
-                        if(i->name == source_state)
-                        {
-                            for(auto j = Automatons.back().states.begin(); j != Automatons.back().states.end(); ++j)
-                                if(j->name == target_state)
-                                {
-                                    i->transit_states_p.insert({transit_letter, &(*j)});
-                                    j->reversed_transit_states_p.insert({transit_letter, &(*i)});
-                                }
-                        }
-                }
-                else                // is a start state
-                {
-                    for(auto i = Automatons.back().states.begin(); i != Automatons.back().states.end(); ++i)                    // fill the start_states vector
-                        if(i->name == target_state)
-                        {
-                            i->start_st = true;
-                            Automatons.back().start_states.push_back(&(*i));
-                        }
-                    start_state = false;
-                }
-                counter = 0;
-            }
-        }
-    }
+    void *raw = std::malloc(size + memory_header);
+    if(raw == nullptr) throw std::bad_alloc();
+    std::int64_t usable = malloc_usable_size(raw) - memory_header;
+    *static_cast<std::uint32_t *>(raw) = memory_slot;
+    ++memory.allocations;
+    memory.allocated += usable;
+    std::int64_t live = live_bytes[memory_slot].bytes.fetch_add(usable, std::memory_order_relaxed) + usable;
+    if(live > memory.peak) memory.peak = live;
+    return static_cast<char *>(raw) + memory_header;
+}
 
-    if(state != 6) {throw "Parsing error!";}    // parsing must end with transitions
+[[gnu::noinline]] void operator delete(void *p) noexcept
+{
+    if(p == nullptr) return;
+    void *raw = static_cast<char *>(p) - memory_header;
+    std::int64_t usable = malloc_usable_size(raw) - memory_header;
+    live_bytes[*static_cast<std::uint32_t *>(raw)].bytes.fetch_sub(usable, std::memory_order_relaxed);
+    std::free(raw);
 }
 
-// --------------------------------------------------------------------------------
-//                         OUTPUT AND PRINT FUNCTIONS
-// --------------------------------------------------------------------------------
+void operator delete(void *p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+#else
+const bool memory_hook = false;
 
-// Function prints all automatons to stdout. It is meant for debug purposes - prints more information.
-// input: automatons - vector<FA>
-// returns: void
-void print_FA(std::vector<FA> automatons)
+// Function returns live bytes of the blocks allocated by the calling thread, they are counted only by the hook.
+// returns: 0
+inline std::int64_t Live_bytes()
 {
-    for(auto i = automatons.begin();i != automatons.end();++i)
-    {
-        std::cout << "Printing automaton " + i->name << std::endl;
+    return 0;
+}
+#endif
 
-        std::cout << "Q = {" << std::endl;
-        for(auto j = i->states.begin(); j != i->states.end(); ++j)
-        {
-            if(j->flag == -1) continue; // deleted state
-            std::cout << std::boolalpha << "\t" << j->name << " (final: " << j->final_st << ", start: " << j->start_st << ", visited: " << j->visited << ", flag: " << j->flag << "):" << std::endl;
-            for(auto const& x : j->transit_states_p)
-                std::cout << "\t\tNext state: (" << x.first << ", " << x.second->name << ")" << std::endl;
-            for(auto const& x : j->reversed_transit_states_p)
-                std::cout << "\t\tPrev state: (" << x.first << ", " << x.second->name << ")" << std::endl;
-        }
-        std::cout << "}" << std::endl;
-
-        std::cout << "A = {";
-        for(auto j = i->alphabet.begin(); j != i->alphabet.end(); ++j)
-            std::cout << *j << ", ";
-        std::cout << "}" << std::endl;
-
-        std::cout << "r = {";
-        for(auto j = i->transitions.begin(); j != i->transitions.end(); ++j)
-            std::cout << j->first.first << "(" << j->first.second << ")" << "->" << j->second << ", ";
-        std::cout << "}" << std::endl;
-
-        std::cout << "rr = {";
-        for(auto j = i->reversed_transitions.begin(); j != i->reversed_transitions.end(); ++j)
-            std::cout << j->first.first << "(" << j->first.second << ")" << "->" << j->second << ", ";
-        std::cout << "}" << std::endl;
-
-        std::cout << "s = {";
-        for(auto j = i->start_states.begin(); j != i->start_states.end(); ++j)
-            std::cout << (*j)->name << ", ";
-        std::cout << "}" << std::endl;
-
-        std::cout << "F = {";
-        for(auto j = i->final_states.begin(); j != i->final_states.end(); ++j)
-            std::cout << (*j)->name << ", ";
-        std::cout << "}" << std::endl;
-
-        std::cout << std::endl << std::endl;
-    }
+// structure containing memory consumption of one phase of the program
+typedef struct {
+    std::string name;
+    std::uint64_t allocations;              // allocations during the phase
+    std::uint64_t allocated;                // bytes allocated during the phase
+    std::uint64_t peak;                     // maximum of live bytes during the phase
+    std::uint64_t live;                     // live bytes at the end of the phase
+    long rss_kb;                            // peak resident set size of the process at the end of the phase
+} Memory_phase_record;
+
+std::vector<Memory_phase_record> memory_phases;    // finished phases
+Memory_phase_record memory_open_phase;              // currently measured phase (empty name -> none)
+std::thread::id memory_phase_thread;                // phases are recorded only by the main thread (not by batch workers)
+
+// Function returns peak resident set size of the process (VmHWM from /proc/self/status).
+// returns: peak RSS in kB, -1 if it is not available
+long Peak_RSS_kb()
+{
+    std::ifstream status("/proc/self/status");
+    std::string word;
+    long kb = -1;
+    while(status >> word)
+        if(word == "VmHWM:") { status >> kb; break; }
+    return kb;
 }
 
-// Function prints automaton to stdout. Main printing function meant for printing results.
-// input: automaton - FA
-// input: alg_flag - bool - if true, does not print states with flag = -1
+// Function ends the current phase and starts a new one. Does nothing outside the instrumentation mode
+// or if the phase is already measured.
+// input: name - name of the new phase, empty -> only ends the current one
 // returns: void
-void Print_result_FA(FA &automaton, bool alg_flag = false)
+void Memory_phase(const std::string &name)
 {
-    std::cout << "Printing automaton " + automaton.name << std::endl;
-
-    std::cout << "Q = {";
-    for(auto j = automaton.states.begin(); j != automaton.states.end(); ++j)
-    {
-        if(j->flag == -1) continue; // deleted state
-        std::cout << j->name << ", ";
-    }
-    std::cout << "}" << std::endl;
-
-    std::cout << "A = {";
-    for(auto j = automaton.alphabet.begin(); j != automaton.alphabet.end(); ++j)
-        std::cout << *j << ", ";
-    std::cout << "}" << std::endl;
-
-    std::cout << "r = {";
-    for(auto j = automaton.states.begin(); j != automaton.states.end(); ++j)
-    {
-        if(j->flag == -1) continue; // deleted state
-        for(auto const& x : j->transit_states_p)
-            if(alg_flag)
-                { if(x.second->flag != -1) std::cout << j->name << "(" << x.first << ")" << "->" << x.second->name << ", "; } // transition to deleted state
-            else std::cout << j->name << "(" << x.first << ")" << "->" << x.second->name << ", "; // transition to deleted state
-
-    }
-    std::cout << "}" << std::endl;
-
-    std::cout << "s = {";
-    for(auto j = automaton.start_states.begin(); j != automaton.start_states.end(); ++j)
-        if((*j)->flag != -1) std::cout << (*j)->name << ", ";
-    std::cout << "}" << std::endl;
-
-    std::cout << "F = {";
-    for(auto j = automaton.final_states.begin(); j != automaton.final_states.end(); ++j)
-        if((*j)->flag != -1) std::cout << (*j)->name << ", ";
-    std::cout << "}" << std::endl;
-
-    std::cout << std::endl << std::endl;
+    if(!memory.enabled || std::this_thread::get_id() != memory_phase_thread) return;
+    if(name == memory_open_phase.name) return;     // the same phase continues
+    if(!memory_open_phase.name.empty())
+    {
+        memory_open_phase.allocations = memory.allocations - memory_open_phase.allocations;
+        memory_open_phase.allocated = memory.allocated - memory_open_phase.allocated;
+        memory_open_phase.peak = memory.peak;
+        memory_open_phase.live = Live_bytes();
+        memory_open_phase.rss_kb = Peak_RSS_kb();
+        memory_phases.push_back(memory_open_phase);
+    }
+    memory_open_phase.name = name;
+    memory_open_phase.allocations = memory.allocations;
+    memory_open_phase.allocated = memory.allocated;
+    memory.peak = Live_bytes();
 }
 
-// Function prints state queue to stdout. It is meant for debug purposes.
-// input: q - queue<State *>
+// Function adds footprints of the structures measured by another thread (batch worker), the maximum of every structure stays.
+// input: into - reference to footprints of the caller
+// input: from - reference to footprints of the other thread
 // returns: void
-void Print_state_queue(std::queue<State *> q)
+void Merge_footprints(Memory_stats &into, const Memory_stats &from)
 {
-    std::cout << "Printing queue: {";
-    while(!q.empty())
-    {
-        std::cout << q.front()->name << ", ";
-        q.pop();
-    }
-    std::cout << "}" << std::endl;
+    into.result_states = std::max(into.result_states, from.result_states);
+    into.preorder_N = std::max(into.preorder_N, from.preorder_N);
+    into.preorder_relation = std::max(into.preorder_relation, from.preorder_relation);
+    into.det_opt_Q = std::max(into.det_opt_Q, from.det_opt_Q);
+    into.antichains = std::max(into.antichains, from.antichains);
 }
 
-// Function prints state stack to stdout. It is meant for debug purposes.
-// input: q - stack<State *>
+// Function prints memory consumption of all phases and footprints of the major structures.
 // returns: void
-void Print_state_stack(std::stack<State *> q)
+void Print_memory()
 {
-    std::cout << "Printing queue: {";
-    while(!q.empty())
+    if(memory_hook)
+    {
+        std::cout << "memory (phase: allocations, allocated bytes, peak live bytes, live bytes at the end, peak RSS kB):" << std::endl;
+        for(auto i = memory_phases.begin(); i != memory_phases.end(); ++i)
+            std::cout << "\t" << i->name << ": " << i->allocations << ", " << i->allocated << ", " << i->peak << ", " << i->live << ", " << i->rss_kb << std::endl;
+    }
+    else
     {
-        std::cout << q.top()->name << ", ";
-        q.pop();
+        std::cout << "memory (phase: peak RSS kB, allocations are counted only by bakalarka_memory):" << std::endl;
+        for(auto i = memory_phases.begin(); i != memory_phases.end(); ++i)
+            std::cout << "\t" << i->name << ": " << i->rss_kb << std::endl;
     }
-    std::cout << "}" << std::endl;
+    std::cout << "footprints (bytes):";
+    for(auto f : {std::make_pair("result states", memory.result_states), std::make_pair("preorder N", memory.preorder_N),
+                  std::make_pair("preorder relation", memory.preorder_relation), std::make_pair("determinization opt_Q", memory.det_opt_Q),
+                  std::make_pair("antichains", memory.antichains)})
+        if(f.second != 0) std::cout << " " << f.first << ": " << f.second;
+    std::cout << std::endl;
 }
 
-// Function prints language partition to stdout (minimalization). It is meant for debug purposes.
-// input: Partition_lan - reference to list<vector<State *>>
-// returns: void
-void Partition_print(std::list<std::vector<State *>> &Partition_lan)
+// ---------------------------------------- MEASUREMENT -----------------------------------------
+
+// structure containing settings of the measurement (command line options)
+typedef struct {
+    long warmup = 1;                // number of runs before the measurement (not measured)
+    long iterations = 0;            // number of measured runs, 0 -> runs are measured until time_ms runs out
+    long time_ms = 500;             // how long should the measurement last (if iterations == 0)
+    std::string format = "text";    // format of the result of the measurement - text, json or csv
+    std::string output;             // file the result of the measurement is appended to, empty -> stdout
+    std::string words;              // file of words for membership (-w), one word per line
+    std::string header;             // file of the generated matcher (-c)
+    std::string cache;              // directory of the result cache (Result_cache), empty -> no cache
+    long cache_mb = 64;             // size limit of the result cache (MB)
+    bool stats = false;             // print work counters of the last run
+    bool memory = false;            // print allocations of the last run and memory of all phases
+    bool summary = false;           // print only a summary of the result automaton (counts and hash)
+    bool minterms = false;          // one-automaton modes run over classes of letters with identical transitions
+    long jobs = 0;                  // worker threads of the batch mode (-j), 0 -> only the first input automaton is used
+} Bench_config;
+
+// structure containing the result of the measurement
+typedef struct {
+    std::vector<double> wall;       // wall time of every measured run (ms)
+    std::vector<double> cpu;        // cpu time of every measured run (ms)
+    std::uint64_t allocations = 0;  // allocations of the last run
+    std::uint64_t allocated = 0;    // bytes allocated by the last run
+    std::uint64_t peak = 0;         // peak of live bytes during the last run above live bytes before the run
+} Bench_result;
+
+// additional named columns of a measurement record
+typedef std::vector<std::pair<std::string, double>> Bench_fields;
+
+// Function returns cpu time of the calling thread in milliseconds (the whole process in modes without workers).
+// returns: cpu time (ms)
+inline double Cpu_time_ms()
 {
-    std::cout << "Partition print:\n";
-    for(auto x  = Partition_lan.begin(); x != Partition_lan.end(); ++x)
-    {
-        std::cout << "\t{";
-        for(auto y = x->begin(); y != x->end(); ++y)
-        {
-            std::cout << (*y)->name << ", ";
-        }
-        std::cout << "}" << std::endl;
-    }
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
 }
 
-// Function prints minimalization queue to stdout. It is meant for debug purposes.
-// input: W - reference to list<pair<string, vector<State *> *>>
-// returns: void
-void Minim_queue_print(std::list<std::pair<std::string, std::vector<State *> *>> &W)
+// Function measures an operation. Before every run it calls setup, which is not measured (copies of automatons,
+// cleaning of results). First config.warmup runs are not measured at all.
+// input: config - reference to settings of the measurement
+// input: setup - function called before every run, it is not measured
+// input: run - measured function
+// input: phase - name of the memory phase of the measurement
+// returns: times of all measured runs
+template <class Setup, class Run>
+Bench_result Benchmark(const Bench_config &config, Setup setup, Run run, const std::string &phase = "benchmark")
 {
-    std::cout << "Queue print:\n\t{";
-    for(auto i = W.begin(); i != W.end(); ++i)
-    {
-        std::cout << "(" << i->first << ",[";
-        for(auto j = i->second->begin(); j != i->second->end(); ++j)
-        {
-            std::cout << (*j)->name << ", ";
-        }
-        std::cout << "]), ";
-    }
-    std::cout << "}" << std::endl;
+    Bench_result result;
+    double total = 0;
+
+    Memory_phase(phase);
+    for(long i = 0; i < config.warmup; ++i)
+    {
+        setup();
+        run();
+    }
+    // counters are reset before every run, the printed ones belong to the last run
+    // at least one run is measured, the result of the last run stays for printing
+    do
+    {
+        setup();
+        stats = Stats();
+        std::uint64_t allocations = memory.allocations, allocated = memory.allocated;
+        std::int64_t live = Live_bytes(), peak = memory.peak;
+        memory.peak = live;
+        auto startsw = std::chrono::steady_clock::now();
+        double startCPUtime = Cpu_time_ms();
+        run();
+        double endCPUtime = Cpu_time_ms();
+        auto endsw = std::chrono::steady_clock::now();
+        result.allocations = memory.allocations - allocations;
+        result.allocated = memory.allocated - allocated;
+        result.peak = memory.peak - live;
+        memory.peak = std::max(memory.peak, peak);
+
+        result.wall.push_back(std::chrono::duration<double, std::milli>(endsw - startsw).count());
+        result.cpu.push_back(endCPUtime - startCPUtime);
+        total += result.wall.back();
+    }
+    while(config.iterations > 0 ? (long)result.wall.size() < config.iterations : total < config.time_ms);
+    return result;
 }
 
-// Function prints list or vector of states to stdout. It is meant for debug purposes.
-// input: data_struct - reference to T
-// returns: void
-template <class T>
-void Print_iter(T &data_struct)
+// Function returns percentile of measured times (nearest rank).
+// input: times - sorted vector of times
+// input: p - percentile (0-100)
+// returns: time
+inline double Percentile(const std::vector<double> &times, double p)
 {
-    std::cout << "{";
-    for(auto i = data_struct.begin(); i != data_struct.end(); ++i)
-        std::cout << (*i)->name << ", ";
-    std::cout << "}";
+    std::size_t rank = (std::size_t)std::ceil(p / 100.0 * times.size());
+    if(rank > 0) --rank;
+    return times[std::min(rank, times.size() - 1)];
 }
 
-// Function prints <st_name,st_name> container in preorder to stdout. It is meant for debug purposes.
-// input: data_struct - reference to Tmpl
-// returns: void
-template <class Tmpl>
-void Print_reduct(Tmpl &data_struct)
+// Function returns work counters of the algorithms as named columns of a measurement record.
+// returns: counters
+Bench_fields Stats_fields()
 {
-    std::cout << "{";
-    for(auto i = data_struct.begin(); i != data_struct.end(); ++i)
-        std::cout << "(" << i->first << "," << i->second << "), ";
-        //if(i->first != nullptr && i->second != nullptr) std::cout << "(" << i->first->name << "," << i->second->name << "), ";
-    std::cout << "}" << std::endl;
+    return {{"emptiness_visited", stats.emptiness_visited}, {"product_states", stats.product_states},
+            {"product_transitions", stats.product_transitions}, {"det_macro_states", stats.det_macro_states},
+            {"det_duplicates", stats.det_duplicates}, {"det_pruned", stats.det_pruned},
+            {"det_dead_letters", stats.det_dead_letters},
+            {"hopcroft_splitters", stats.hopcroft_splitters}, {"hopcroft_splits", stats.hopcroft_splits},
+            {"preorder_updates", stats.preorder_updates},
+            {"preorder_removed", stats.preorder_removed}, {"reduction_merged", stats.reduction_merged},
+            {"reduction_removed", stats.reduction_removed}, {"bisimulation_splitters", stats.bisimulation_splitters},
+            {"bisimulation_splits", stats.bisimulation_splits}, {"subset_calls", stats.subset_calls},
+            {"antichain_processed", stats.antichain_processed}, {"antichain_pruned", stats.antichain_pruned},
+            {"antichain_removed", stats.antichain_removed}, {"equivalence_pairs", stats.equivalence_pairs},
+            {"equivalence_macro_states", stats.equivalence_macro_states}};
 }
 
-// Function prints macro state to stdout. It is meant for debug purposes.
-// input: m - reference to Macro_state
+// Function prints the result of the measurement in a format chosen by config.format.
+// With config.stats the work counters of the last run are printed too (only nonzero ones in text format).
+// input: config - reference to settings of the measurement
+// input: operation - name of the measured operation
+// input: result - reference to the result of the measurement
+// input: states - number of states of input automatons
+// input: transitions - number of transitions of input automatons
+// input: extra - additional columns of the record (e.g. point of the sweep, size of the output)
 // returns: void
-void Print_MacroState(Macro_state &m)
+void Print_benchmark(const Bench_config &config, const std::string &operation, Bench_result &result, long states, long transitions, const Bench_fields &fields = Bench_fields())
 {
-    std::cout << "[";
-    for(auto i = m.states.begin(); i != m.states.end(); ++i)
+    static bool stdout_header = true;   // csv header on stdout is written only once (sweep prints more records)
+    std::ofstream file;
+    std::ostream *out = &std::cout;
+    bool header = true;     // csv header is written only once per file
+    std::vector<double> wall = result.wall, cpu = result.cpu;
+    Bench_fields extra = fields;
+    Bench_fields counters = Stats_fields();
+    if(config.stats && config.format != "text") extra.insert(extra.end(), counters.begin(), counters.end());
+    if(config.memory && memory_hook && config.format != "text")
+        extra.insert(extra.end(), {{"alloc_count", result.allocations}, {"alloc_bytes", result.allocated}, {"peak_bytes", result.peak}});
+    Memory_phase("output");
+    std::sort(wall.begin(), wall.end());
+    std::sort(cpu.begin(), cpu.end());
+
+    if(!config.output.empty())
+    {
+        std::ifstream existing(config.output);
+        header = !existing || existing.peek() == std::ifstream::traits_type::eof();
+        file.open(config.output, std::ios::app);
+        if(!file) { std::cerr << "Cannot open " << config.output << std::endl; return; }
+        out = &file;
+    }
+    else
     {
-        std::cout << (*i)->name << ", ";
+        header = stdout_header;
+        stdout_header = false;
     }
-    std::cout << "] " << m.rejecting << std::endl;
-}
-
-// -------------------------------------------------------------------------------------------------
-//                                       AUTOMATON ALGORITHMS
-// -------------------------------------------------------------------------------------------------
-
-// ---------------------------------------- EMPTINESS -----------------------------------------
+    *out << std::fixed << std::setprecision(6);
 
-// Function checks if automaton is empty. It is basically a Depth-first search (DFS) in a tree of states.
-// input: automaton - reference to FA
-// returns: true - automaton language is empty, false - automaton language is not empty
-bool Emptiness_test(FA &automaton)
-{
-    std::stack<State *>state_q;
-    State * st;
-    std::unordered_set<std::string> visited_htab;
-
-    // pushes all start states to the state stack (pointers)
-    for(auto i = automaton.start_states.begin(); i != automaton.start_states.end();++i)
+    if(config.format == "json")
     {
-        visited_htab.insert((*i)->name);
-        state_q.push(*i);
+        *out << "{\"operation\": \"" << operation << "\", \"states\": " << states << ", \"transitions\": " << transitions
+             << ", \"warmup\": " << config.warmup << ", \"runs\": " << wall.size();
+        for(auto e = extra.begin(); e != extra.end(); ++e)
+            *out << ", \"" << e->first << "\": " << std::defaultfloat << std::setprecision(12) << e->second << std::fixed << std::setprecision(6);
+        for(auto t : {std::make_pair("wall_ms", &wall), std::make_pair("cpu_ms", &cpu)})
+            *out << ", \"" << t.first << "\": {\"min\": " << t.second->front() << ", \"median\": " << Percentile(*t.second, 50)
+                 << ", \"p95\": " << Percentile(*t.second, 95) << ", \"p99\": " << Percentile(*t.second, 99) << "}";
+        *out << "}" << std::endl;
     }
-
-    // takes states from stack and looks if they are final
-    // if yes -> return false
-    // if no  -> push all forward states onto the stack and keep checking
-    while(!state_q.empty())
+    else if(config.format == "csv")
     {
-        #ifdef EMPTINESS_DEBUG
-            Print_state_stack(state_q);
-        #endif
-
-        st = state_q.top();
-        state_q.pop();
-        if(st->final_st) return false;
-        for(auto const& transition : st->transit_states_p)
+        if(header)
         {
-            if(visited_htab.find(transition.second->name) == visited_htab.end()) // do not push an already visited state again
-            {
-                visited_htab.insert(transition.second->name);
-                state_q.push(transition.second);
-            }
+            *out << "operation,states,transitions,warmup,runs";
+            for(auto e = extra.begin(); e != extra.end(); ++e)
+                *out << "," << e->first;
+            *out << ",wall_min,wall_median,wall_p95,wall_p99,cpu_min,cpu_median,cpu_p95,cpu_p99" << std::endl;
         }
+        *out << operation << "," << states << "," << transitions << "," << config.warmup << "," << wall.size();
+        for(auto e = extra.begin(); e != extra.end(); ++e)
+            *out << "," << std::defaultfloat << std::setprecision(12) << e->second << std::fixed << std::setprecision(6);
+        for(auto t : {&wall, &cpu})
+            *out << "," << t->front() << "," << Percentile(*t, 50) << "," << Percentile(*t, 95) << "," << Percentile(*t, 99);
+        *out << std::endl;
     }
-    return true;
+    else
+    {
+        *out << "states: " << states << " transitions: " << transitions;
+        for(auto e = extra.begin(); e != extra.end(); ++e)
+            *out << " " << e->first << ": " << std::defaultfloat << std::setprecision(12) << e->second << std::fixed << std::setprecision(6);
+        *out << " cpu: " << Percentile(cpu, 50) << " wall: " << Percentile(wall, 50) << std::endl;
+        *out << "runs: " << wall.size() << " (warmup: " << config.warmup << ") wall min: " << wall.front() << " median: " << Percentile(wall, 50)
+             << " p95: " << Percentile(wall, 95) << " p99: " << Percentile(wall, 99) << std::endl;
+        if(config.stats)
+        {
+            *out << "stats:";
+            for(auto c = counters.begin(); c != counters.end(); ++c)
+                if(c->second != 0) *out << " " << c->first << ": " << std::defaultfloat << std::setprecision(12) << c->second << std::fixed << std::setprecision(6);
+            *out << std::endl;
+        }
+        if(config.memory && memory_hook)
+            *out << "memory: allocations: " << result.allocations << " bytes: " << result.allocated << " peak: " << result.peak << std::endl;
+        *out << std::endl;
+    }
+    if(out == &std::cout) std::cout << std::defaultfloat;
 }
-// ---------------------------------------- USELESS STATES -----------------------------------------
 
-// Function returns iterator pointing to a state with a specific name.
-// input: start_states - reference to vector<State *>
-// input: name - string - name of the state
-// returns: iterator to a vector of states
-inline std::vector<State *>::iterator find_in_start_states(std::vector<State *> &start_states, std::string name)
-{
-    auto st = start_states.begin();
-    for(; st != start_states.end(); ++st)
-        if((*st)->name == name) break;
-    return st;
-}
-// Function removes relations with states that should be removed.
-// input: state - iterator into list of states
-// returns: void
-inline void Remove_relations(std::list<State>::iterator state)
-{
-    std::pair<std::multimap<std::string, State *>::iterator,std::multimap<std::string, State *>::iterator> range1;
 
-    for(auto rel = state->transit_states_p.begin(); rel != state->transit_states_p.end(); ++rel)
-    {
-        range1 = rel->second->reversed_transit_states_p.equal_range(rel->first);    // update reversed relations of all next states
-        for(auto i = range1.first; i != range1.second; ++i)
-            if(i->second->name == state->name) { rel->second->reversed_transit_states_p.erase(i); break; }
-    }
-    for(auto rel = state->reversed_transit_states_p.begin(); rel != state->reversed_transit_states_p.end(); ++rel)
+// Function splits comma separated list of numbers (grid of the sweep).
+// input: list - string "10,20,50"
+// returns: vector of numbers
+std::vector<double> Parse_list(const std::string &list)
+{
+    std::vector<double> values;
+    std::size_t start = 0, end;
+    do
     {
-        range1 = rel->second->transit_states_p.equal_range(rel->first);    // update outgoing relations of all previous states
-        for(auto i = range1.first; i != range1.second; ++i)
-            if(i->second->name == state->name) { rel->second->transit_states_p.erase(i); break; }
+        end = list.find(',', start);
+        values.push_back(std::stod(list.substr(start, end - start)));
+        start = end + 1;
     }
-    state->transit_states_p.clear();            // clear relations of a useless state
-    state->reversed_transit_states_p.clear();
+    while(end != std::string::npos);
+    return values;
 }
 
-// Function takes automaton with states that need to be removed and removes those states.
-// input: automaton - reference to automaton
-// input: alg - id of algorithm calling this function (0 - useless, 1 - reduction)
-// input: visited_htab - reference to hash table of state names (from start states)
-// input: flag_htab - reference to hash table of state names (from final states)
-// returns: void
-void Restore_FA(FA &automaton, short int alg, std::unordered_set<std::string> &visited_htab, std::unordered_set<std::string> &flag_htab)
+// Function runs operation on random automatons for every point of the grid sizes x densities and prints
+// the measurement together with the size of the output. Operations with two operands get two automatons
+// generated with seeds seed and seed + 1.
+// input: config - reference to settings of the measurement
+// input: random - parameters of the generator (states and density are taken from the grid)
+// input: sizes - numbers of states
+// input: densities - transition densities
+// input: operation - mode of the program (-e, -n, -p, -d, -dc, -ds, -m, -mb, -s, -r, -b, -u, -i, -o)
+// returns: false if the operation is not supported
+bool Sweep(const Bench_config &config, Random_config random, const std::vector<double> &sizes, const std::vector<double> &densities, const std::string &operation)
 {
-    // remove states that should be removed
-    for(auto state = automaton.states.begin(); state != automaton.states.end();)
+    const std::vector<std::string> supported = {"-e", "-n", "-p", "-d", "-dc", "-ds", "-m", "-mb", "-s", "-r", "-b", "-u", "-i", "-o"};
+    if(std::find(supported.begin(), supported.end(), operation) == supported.end()) return false;
+    bool binary = (operation == "-p" || operation == "-i" || operation == "-o");
+
+    for(auto size = sizes.begin(); size != sizes.end(); ++size)
     {
-        // if state was not visited both from beginning (visited_htab) and end (flag_htab)
-        // it is complicated because it is being used from two functions
-        if( (alg == 0 && !(flag_htab.find(state->name) != flag_htab.end() && visited_htab.find(state->name) != visited_htab.end())) || (alg == 1 && state->flag == -1) )
+        for(auto density = densities.begin(); density != densities.end(); ++density)
         {
-            if(state->start_st)     // remove the state from start states
+            std::vector<FA> automatons(binary ? 2 : 1);
+            Random_config point = random;
+            point.states = (long)*size;
+            point.density = *density;
+            for(auto autom = automatons.begin(); autom != automatons.end(); ++autom, ++point.seed)
+                Generate_FA(*autom, point);
+
+            long states = 0, transitions = 0, output = 0;
+            for(auto autom = automatons.begin(); autom != automatons.end(); ++autom)
             {
-                for(auto st = automaton.start_states.begin(); st != automaton.start_states.end(); ++st)
-                {
-                    if((*st)->name == state->name)
-                    {
-                        *st = *(automaton.start_states.rbegin());
-                        automaton.start_states.pop_back();
-                        break;
-                    }
-                }
+                states += Count_states(*autom);
+                transitions += Count_transitions(*autom);
+            }
+
+            FA result_automaton, determinized;
+            std::unordered_set<std::pair<std::string,std::string>, pair_hash> preorder;
+            Bench_result times;
+            std::string name;
+            if(operation == "-e")
+            {
+                name = "emptiness";
+                times = Benchmark(config, []{}, [&]{ output = Emptiness_test(automatons[0]); });
+            }
+            else if(operation == "-n" || operation == "-r" || operation == "-b")
+            {
+                name = (operation == "-n") ? "useless" : (operation == "-r") ? "reduction" : "bisimulation";
+                times = Benchmark(config, [&]{ result_automaton = FA(); }, [&]{
+                    if(operation == "-n") Remove_useless_states(automatons[0], result_automaton);
+                    else if(operation == "-r") Reduction_NFA(automatons[0], result_automaton);
+                    else Bisimulation_NFA(automatons[0], result_automaton);
+                });
+                output = Count_states(result_automaton);
+            }
+            else if(operation == "-p" || operation == "-o")
+            {
+                name = (operation == "-p") ? "intersection" : "union";
+                times = Benchmark(config, [&]{ result_automaton = FA(); }, [&]{
+                    if(operation == "-p") Intersection_FA(automatons[0], automatons[1], result_automaton);
+                    else Union_FA(automatons[0], automatons[1], result_automaton);
+                });
+                output = Count_states(result_automaton);
             }
-            if(state->final_st)     // remove the state from final states
+            else if(operation == "-d" || operation == "-dc" || operation == "-ds")
             {
-                automaton.final_states.erase(&(*state));
+                name = (operation == "-d") ? "determinization" : (operation == "-dc") ? "determinization_complete" : "determinization_simulation";
+                if(operation == "-ds") Preorder(automatons[0], preorder);
+                times = Benchmark(config, [&]{ result_automaton = FA(); }, [&]{
+                    Determinization_FA(automatons[0], result_automaton, operation == "-dc", operation == "-ds" ? &preorder : nullptr);
+                });
+                output = Count_states(result_automaton);
             }
-            Remove_relations(state);
-            state = automaton.states.erase(state);
+            else if(operation == "-m")
+            {
+                name = "minimalization";
+                Determinization_FA(automatons[0], determinized);
+                times = Benchmark(config, [&]{ result_automaton = FA(); }, [&]{ Minimalization_FA(determinized, result_automaton); });
+                output = Count_states(result_automaton);
+            }
+            else if(operation == "-mb")
+            {
+                name = "minimalization_brzozowski";
+                times = Benchmark(config, [&]{ result_automaton = FA(); }, [&]{ Brzozowski_FA(automatons[0], result_automaton); });
+                output = Count_states(result_automaton);
+            }
+            else if(operation == "-s")
+            {
+                name = "simulation";
+                times = Benchmark(config, [&]{ preorder.clear(); }, [&]{ Preorder(automatons[0], preorder); });
+                output = preorder.size();
+            }
+            else if(operation == "-u")
+            {
+                name = "universality";
+                Preorder(automatons[0], preorder);
+                times = Benchmark(config, []{}, [&]{ output = Universality_NFA(automatons[0], preorder); });
+            }
+            else
+            {
+                name = "inclusion";
+                Union_FA(automatons[0], automatons[1], result_automaton);
+                Preorder(result_automaton, preorder);
+                times = Benchmark(config, []{}, [&]{ output = Inclusion_NFA(automatons[0], automatons[1], preorder); });
+            }
+            Print_benchmark(config, name, times, states, transitions, {{"size", *size}, {"density", *density}, {"output", (double)output}});
         }
-        else ++state;
     }
+    return true;
 }
 
-// Function implements the Remove useless states algorithm. Removes all non-ending and non-reachable states.
-// Has three parts - breadth-first search from start states (saves into visited_htab), breadth-first search
-// from final states andreversed automaton (saves into flag_htab), remove states that are not in both tables.
-// input: automaton - reference to automaton
-// returns: void
-void Remove_useless_states(FA &automaton)
+// ---------------------------------------- PIPELINE -----------------------------------------
+
+// Function returns node of the expression DAG, equal subexpressions share one node.
+// input: nodes - reference to nodes of the DAG
+// input: unique - reference to hash table of already created nodes (key: operation and operands)
+// input: op - operation of the node
+// input: children - operands of the node
+// returns: index of the node
+std::size_t Pipeline_node_get(std::vector<Pipeline_node> &nodes, std::unordered_map<std::string,std::size_t> &unique, const std::string &op, const std::vector<std::size_t> &children)
 {
-    std::queue<State *>state_q;
-    State * st;
-    std::unordered_set<std::string> visited_htab;
-    std::unordered_set<std::string> flag_htab;
+    std::string key = op;
+    for(auto c = children.begin(); c != children.end(); ++c)
+        key = key + "#" + std::to_string(*c);
+    auto seek = unique.find(key);
+    if(seek != unique.end()) return seek->second;
+
+    nodes.push_back({op, children, 0, false, Shared_FA()});
+    unique.insert({key, nodes.size() - 1});
+    return nodes.size() - 1;
+}
 
-    // -------------- finding non-reachable states ------------------
+// Function parses the pipeline expression into a DAG. Grammar (& binds tighter than |):
+//      pipeline = union { ";" unary }
+//      union    = inters { "|" inters }
+//      inters   = primary { "&" primary }
+//      primary  = name | "(" union ")" | unary "(" union ")"
+//      unary    = det | detc | min | trim | reduce | bisim | compl
+// Leaves are input automatons (by name), their nodes take the automatons over.
+// input: text - the expression, e.g. "A1 & A2 | A3 ; det ; min ; trim"
+// input: automatons - reference to input automatons
+// input: nodes - reference to nodes of the DAG (output)
+// returns: index of the root node
+std::size_t Parse_pipeline(const std::string &text, std::vector<FA> &automatons, std::vector<Pipeline_node> &nodes)
+{
+    const std::vector<std::string> unary = {"det", "detc", "min", "trim", "reduce", "bisim", "compl"};
+    std::unordered_map<std::string,std::size_t> unique;
+    std::vector<std::string> tokens;
+    std::size_t pos = 0;
 
-    // pushes all start states to the state queue (pointers)
-    for(auto i = automaton.start_states.begin(); i != automaton.start_states.end();++i)
+    // tokens are operators, brackets and names (everything else between white space and operators)
+    for(std::size_t i = 0; i < text.size();)
     {
-        visited_htab.insert((*i)->name);     // start states are reachable from start
-        state_q.push(*i);
+        if(std::isspace((unsigned char)text[i])) { ++i; continue; }
+        if(std::string("&|();").find(text[i]) != std::string::npos) { tokens.push_back(text.substr(i, 1)); ++i; continue; }
+        std::size_t start = i;
+        while(i < text.size() && !std::isspace((unsigned char)text[i]) && std::string("&|();").find(text[i]) == std::string::npos) ++i;
+        tokens.push_back(text.substr(start, i - start));
     }
 
-    // goes through all transitions from start and marks visited states
-    // not visited states are non-reachable and will be removed
-    while(!state_q.empty())
+    auto is_unary = [&](const std::string &op) { return std::find(unary.begin(), unary.end(), op) != unary.end(); };
+    auto expect = [&](const std::string &token)
     {
-        #ifdef USELESS_DEBUG
-            std::cout << "start: ";
-            Print_state_queue(state_q);
-            print_FA({automaton});
-        #endif
+        if(pos >= tokens.size() || tokens[pos] != token) throw Parse_error("Pipeline: expected " + token);
+        ++pos;
+    };
 
-        st = state_q.front();
-        for(auto const& transition : st->transit_states_p)
+    std::function<std::size_t()> parse_union, parse_inters, parse_primary;
+    parse_primary = [&]() -> std::size_t
+    {
+        if(pos >= tokens.size()) throw Parse_error("Pipeline: unexpected end of the expression");
+        std::string token = tokens[pos++];
+        if(token == "(")
         {
-            if(visited_htab.find(transition.second->name) == visited_htab.end()) // do not push an already visited state again
-            {
-                visited_htab.insert(transition.second->name);
-                state_q.push(transition.second);
-            }
+            std::size_t node = parse_union();
+            expect(")");
+            return node;
         }
-        state_q.pop();
-    }
-
-    // -------------- finding non-ending states ------------------
+        if(is_unary(token) && pos < tokens.size() && tokens[pos] == "(")
+        {
+            ++pos;
+            std::size_t node = parse_union();
+            expect(")");
+            return Pipeline_node_get(nodes, unique, token, {node});
+        }
+        if(std::string("&|);").find(token) != std::string::npos) throw Parse_error("Pipeline: unexpected " + token);
 
-    // pushes all final states to the state queue (pointers)
-    for(auto i = automaton.final_states.begin(); i != automaton.final_states.end();++i)
+        // input automaton - the node takes the automaton over when it is created
+        std::size_t size = nodes.size();
+        std::size_t node = Pipeline_node_get(nodes, unique, "input:" + token, {});
+        if(nodes.size() != size)
+        {
+            auto input = std::find_if(automatons.begin(), automatons.end(), [&](const FA &autom) { return autom.name == token; });
+            if(input == automatons.end()) throw Parse_error("Pipeline: unknown automaton " + token);
+            nodes[node].op = "input";
+            nodes[node].value = Shared_FA(std::move(*input));
+            nodes[node].evaluated = true;
+        }
+        return node;
+    };
+    parse_inters = [&]() -> std::size_t
     {
-        flag_htab.insert((*i)->name);       // final states are reachable from end
-        state_q.push(*i);
-    }
-
-    // goes through all transitions from final states and marks visited states
-    // not visited states are non-ending and will be removed
-    while(!state_q.empty())
+        std::size_t node = parse_primary();
+        while(pos < tokens.size() && tokens[pos] == "&")
+        {
+            ++pos;
+            node = Pipeline_node_get(nodes, unique, "&", {node, parse_primary()});
+        }
+        return node;
+    };
+    parse_union = [&]() -> std::size_t
     {
-        #ifdef USELESS_DEBUG
-            std::cout << "final: ";
-            Print_state_queue(state_q);
-            print_FA({automaton});
-        #endif
-
-        st = state_q.front();
-        for(auto const& transition : st->reversed_transit_states_p)
+        std::size_t node = parse_inters();
+        while(pos < tokens.size() && tokens[pos] == "|")
         {
-            if(flag_htab.find(transition.second->name) == flag_htab.end()) // do not push an already visited state again
-            {
-                flag_htab.insert(transition.second->name);
-                state_q.push(transition.second);
-            }
+            ++pos;
+            node = Pipeline_node_get(nodes, unique, "|", {node, parse_inters()});
         }
-        state_q.pop();
+        return node;
+    };
+
+    std::size_t root = parse_union();
+    while(pos < tokens.size() && tokens[pos] == ";")
+    {
+        ++pos;
+        if(pos >= tokens.size() || !is_unary(tokens[pos])) throw Parse_error("Pipeline: expected an operation after ;");
+        root = Pipeline_node_get(nodes, unique, tokens[pos++], {root});
     }
+    if(pos != tokens.size()) throw Parse_error("Pipeline: unexpected " + tokens[pos]);
 
-    // ------------------------------ setting flag and modifying automaton -----------------------------------
-    Restore_FA(automaton, 0, visited_htab, flag_htab);  // modify automaton
+    // every edge of the DAG is one use of the operand, the root is used by the output
+    for(auto n = nodes.begin(); n != nodes.end(); ++n)
+        for(auto c = n->children.begin(); c != n->children.end(); ++c)
+            ++nodes[*c].uses;
+    ++nodes[root].uses;
+    return root;
 }
 
-// ---------------------------------------- INTERSECTION -----------------------------------------
-
-// Function implements the Intersection algorithm. Computes intersection of two automatons by making pairs of states.
-// input: automaton1 - reference to first automaton, used to compute intersection
-// input: automaton2 - reference to second automaton, used to compute intersection
-// input: result_automaton - reference to result automaton, used to store result automaton
+// result of one evaluated node of the pipeline
+typedef struct {
+    std::size_t node;               // index of the node
+    Bench_result times;             // measurement of the evaluation
+    Stats counters;                 // work counters of the evaluation
+    long states;                    // states of operands
+    long transitions;               // transitions of operands
+    long output;                    // states of the result
+} Pipeline_stage;
+
+// Function evaluates the node of the DAG (operands first). Every evaluation is measured as one run, the value of an operand
+// is released as soon as its last consumer used it, so the complement (the only operation in place) does not copy it.
+// trim, reduce and bisim only read their operand and build the surviving states.
+// input: nodes - reference to nodes of the DAG
+// input: node - index of the evaluated node
+// input: config - reference to settings of the measurement (only stats and memory are used)
+// input: stages - reference to results of evaluated nodes (output)
 // returns: void
-void Intersection_FA(FA &automaton1, FA &automaton2, FA &result_automaton)
+void Evaluate_pipeline(std::vector<Pipeline_node> &nodes, std::size_t node, const Bench_config &config, std::vector<Pipeline_stage> &stages)
 {
-    std::queue<Inters_help> W;      // queue W from algorithm
-    Inters_help st_pair;            // structure pushed to the queue
-    State st;                       // the state structure
-    std::string a;                  // alphabet letter - main loop
-    std::unordered_map<std::string,State *> optim_Q;  // optimalization of finding state in Q - hash table of state names
-    std::pair<std::multimap<std::string,State *>::iterator, std::multimap<std::string,State *>::iterator> range1, range2; // iterator pairs for equal_range
-
-    #ifdef INTERSECTION_DEBUG
-        std::cout << "\nIntersection: printing input automatons..." << std::endl;
-        Print_result_FA(automaton1);
-        Print_result_FA(automaton2);
-    #endif // INTERSECTION_DEBUG
-
-    // checking if alphabets are the same - they are sorted
-    //if(automaton1.alphabet != automaton2.alphabet) {throw "Intersection: alphabets are different!";}
-    if(automaton1.alphabet.size() < automaton2.alphabet.size())
-        result_automaton.alphabet = automaton1.alphabet;
-    else
-        result_automaton.alphabet = automaton2.alphabet;
-
-    // building a new automaton that will be returned
-    result_automaton.name = automaton1.name + "&" + automaton2.name;
+    Bench_config once = config;     // every stage runs exactly once
+    once.warmup = 0;
+    once.iterations = 1;
+    std::vector<Shared_FA> operands;
+    Pipeline_stage stage = {node, Bench_result(), Stats(), 0, 0, 0};
 
-    // cartesian product of starting states - push them to Q, S, F and W
-    for(auto i = automaton1.start_states.begin(); i != automaton1.start_states.end(); ++i)
+    for(auto c = nodes[node].children.begin(); c != nodes[node].children.end(); ++c)
     {
-        for(auto j = automaton2.start_states.begin(); j != automaton2.start_states.end(); ++j)
+        if(!nodes[*c].evaluated) Evaluate_pipeline(nodes, *c, config, stages);
+        operands.push_back(nodes[*c].value);
+        stage.states += Count_states(operands.back().read());
+        stage.transitions += Count_transitions(operands.back().read());
+        if(--nodes[*c].uses == 0) nodes[*c].value.release();      // dead value, only operands hold it now
+    }
+
+    Pipeline_node &n = nodes[node];
+    FA result_automaton;
+    stage.times = Benchmark(once, []{}, [&]{
+        if(n.op == "&") Intersection_FA(operands[0].write_shared(), operands[1].write_shared(), result_automaton);
+        else if(n.op == "|") Union_FA(operands[0].write_shared(), operands[1].write_shared(), result_automaton);
+        else if(n.op == "det" || n.op == "detc") Determinization_FA(operands[0].write_shared(), result_automaton, n.op == "detc");
+        else if(n.op == "min")
         {
-            st.name = (*i)->name + (*j)->name;      // create a name for a new state
-            st.start_st = true;
-            result_automaton.states.push_back(st);  // push the state to Q
-            optim_Q.insert({st.name,&result_automaton.states.back()});                    // push the state name and pointer to hash table
-            result_automaton.start_states.push_back(&(result_automaton.states.back()));     // push the state to S
-            if((*i)->final_st && (*j)->final_st)    // set the final state variable
+            if(Is_deterministic(operands[0].read())) Minimalization_FA(operands[0].write_shared(), result_automaton);
+            else
             {
-                result_automaton.final_states.insert(&(result_automaton.states.back()));    // mozna to neni potreba
-                result_automaton.states.back().final_st = true;
+                FA determinized;
+                Determinization_FA(operands[0].write_shared(), determinized);
+                Minimalization_FA(determinized, result_automaton);
             }
-            else
-                result_automaton.states.back().final_st = false;
-            W.push({*i,*j,&(result_automaton.states.back())});    // push the state to W
         }
-    }
-
-    #ifdef INTERSECTION_DEBUG
-        Print_result_FA(result_automaton);
-    #endif // INTERSECTION_DEBUG
-
-    // main loop - until queue is empty
-    while(!W.empty())
-    {
-        st_pair = W.front();
-        #ifdef INTERSECTION_DEBUG
-            std::cout << "\nIntersection - st_pair: " << st_pair.first->name << ", " << st_pair.second->name << ", " << st_pair.source->name << std::endl;
-        #endif // INTERSECTION_DEBUG
-
-        // it looks only at the alphabet of the first state instead of running through the entire alphabet of the automaton
-        for(auto it = st_pair.first->transit_states_p.begin(); it != st_pair.first->transit_states_p.end(); it = range1.second)
+        else if(n.op == "trim") Remove_useless_states(operands[0].read(), result_automaton);
+        else if(n.op == "reduce") Reduction_NFA(operands[0].read(), result_automaton);
+        else if(n.op == "bisim") Bisimulation_NFA(operands[0].read(), result_automaton);
+        else if(n.op == "compl")
         {
-            a = it->first;
-            #ifdef INTERSECTION_DEBUG
-                std::cout << "\nIntersection - main loop: " << "letter: " << a << "\n";
-            #endif // INTERSECTION_DEBUG
-
-            // find all states accessible from the current pair
-            range1 = st_pair.first->transit_states_p.equal_range(a);
-            range2 = st_pair.second->transit_states_p.equal_range(a);
-
-            // cartesian product of accessible states
-            for(auto i = range1.first; i != range1.second; ++i)
+            // complement is correct only for a complete DFA, DFA is completed by the implicit sink
+            // (an automaton without start states is completed by determinization, it gets the start sink)
+            if(operands[0].read().start_states.size() == 1 && Is_deterministic(operands[0].read())) operands[0].write().sink = true;
+            else
             {
-                #ifdef INTERSECTION_DEBUG
-                    std::cout << "\t" << i->first << ", " << i->second->name << "\n";
-                #endif // INTERSECTION_DEBUG
-                for(auto j = range2.first; j != range2.second; ++j)
-                {
-                    #ifdef INTERSECTION_DEBUG
-                        std::cout << "\t\t" << j->first << ", " << j->second->name << std::endl;
-                    #endif // INTERSECTION_DEBUG
-
-                    st.name = i->second->name + j->second->name;
-                    st.start_st = false;
-
-                    // add state only if it is not already in Q (new automaton)
-                    //if(k == result_automaton.states.rend())
-                    auto seek = optim_Q.find(st.name);
-                    if(seek == optim_Q.end())
-                    {
-                        result_automaton.states.push_back(st);          // insert the new state
-                        optim_Q.insert({st.name,&result_automaton.states.back()});   // push the state name and pointer to hash table
-                        if(i->second->final_st && j->second->final_st)  // insert state into final state set
-                        {
-                            result_automaton.states.back().final_st = true;
-                            result_automaton.final_states.insert(&result_automaton.states.back());
-                        }
-                        else
-                            result_automaton.states.back().final_st = false;
-                        W.push({i->second,j->second,&result_automaton.states.back()});    // push the state to W
-
-                        // always push relations
-                        st_pair.source->transit_states_p.insert({a,&result_automaton.states.back()});
-                        result_automaton.states.back().reversed_transit_states_p.insert({a,st_pair.source});    // reversed mozna neni potreba
-                    }
-                    else
-                    {
-                        // always push relations
-                        st_pair.source->transit_states_p.insert({a,seek->second});
-                        seek->second->reversed_transit_states_p.insert({a,st_pair.source});    // reversed mozna neni potreba
-                    }
-                }
+                Determinization_FA(operands[0].write_shared(), result_automaton, true);
+                operands[0] = Shared_FA(std::move(result_automaton));
             }
+            Complement_FA(operands[0].write());
         }
-        W.pop();
-        #ifdef INTERSECTION_DEBUG
-            std::cout << "\nIntersection - endloop: \n";
-            Print_result_FA(result_automaton);
-        #endif // INTERSECTION_DEBUG
-    }
+    }, "stage " + std::to_string(stages.size() + 1) + " " + n.op);
+
+    if(n.op == "compl") n.value = operands[0];     // operation in place
+    else n.value = Shared_FA(std::move(result_automaton));
+    n.evaluated = true;
+    stage.counters = stats;
+    stage.output = Count_states(n.value.read());
+    stages.push_back(stage);
 }
 
-// ---------------------------------------- DETERMINIZATION -----------------------------------------
-
-// Function implements the Determinization algorithm. Computes deterministic version of input automaton.
-// input: automaton1 - reference to source automaton, used to compute determinization
-// input: result_automaton - reference to result automaton, used to store result automaton
+// Function prints measurements of all stages of the pipeline.
+// input: nodes - reference to nodes of the DAG
+// input: stages - reference to results of evaluated nodes
+// input: config - reference to settings of the measurement
 // returns: void
-void Determinization_FA(FA &automaton1, FA &result_automaton)
+void Print_pipeline(const std::vector<Pipeline_node> &nodes, const std::vector<Pipeline_stage> &stages, const Bench_config &config)
 {
-    std::queue<Determin_help> W;    // queue W from algorithm
-    Determin_help st_vect;          // structure pushed to the queue - contains vector of source states and a pointer to a new state created from source states
-    State st;                       // the state structure
-    std::vector<State *> storage;
-    std::pair<std::multimap<std::string,State *>::iterator, std::multimap<std::string,State *>::iterator> range1; // iterator pair for equal_range
-    #ifdef DETERMINIZATION_FAIL_SWITCH
-    State * fail = nullptr;         // pointer to a fail state
-    #endif
-    std::vector<std::string> opt_name;              // optimizes dealing with S1S2S3, S2S1S3, S3S2S1, ... states - it is the same state
-    std::unordered_set<std::string> opt_storage;    // optimizes searching in storage - prevents states like S1S1S1S2S3 or S1S1S2S3S3
-    std::unordered_map<std::string,State *> opt_Q;  // optimizes searching in Q
-
-    #ifdef DETERMINIZATION_DEBUG
-        std::cout << "\nDeterminization: printing input automaton..." << std::endl;
-        Print_result_FA(automaton1);
-        print_FA({automaton1});
-    #endif
+    const std::unordered_map<std::string,std::string> names = {{"&", "intersection"}, {"|", "union"}, {"det", "determinization"},
+        {"detc", "determinization_complete"}, {"min", "minimalization"}, {"trim", "useless"}, {"reduce", "reduction"}, {"bisim", "bisimulation"},
+        {"compl", "complement"}};
+    Bench_config once = config;
+    once.warmup = 0;
+    for(auto st = stages.begin(); st != stages.end(); ++st)
+    {
+        Bench_result times = st->times;
+        stats = st->counters;   // Print_benchmark prints the global counters
+        if(config.format == "text") std::cout << "stage " << st - stages.begin() + 1 << ": " << names.at(nodes[st->node].op) << std::endl;
+        Print_benchmark(once, names.at(nodes[st->node].op), times, st->states, st->transitions,
+                        {{"stage", (double)(st - stages.begin() + 1)}, {"output", (double)st->output}});
+    }
+}
 
-    // building a new automaton that will be returned
-    result_automaton.name = "det" + automaton1.name;
-    result_automaton.alphabet = automaton1.alphabet;
+// ---------------------------------------- SERVER -----------------------------------------
 
-    // create the new start state by merging all start states
-    st.name = "|";
-    st.start_st = true;
-    st.final_st = false;
-    // optimalization - find all state names and push them into a vector
-    for(auto i = automaton1.start_states.begin(); i != automaton1.start_states.end(); ++i)
+// Function returns the reduced form of the stored automaton, computes it on the first use.
+// input: stored - reference to an automaton of the store
+// returns: reference to the reduced automaton
+FA &Stored_reduced(Stored_FA &stored)
+{
+    if(!stored.reduced_ready)
     {
-        opt_name.push_back((*i)->name);
-        if((*i)->final_st) st.final_st = true;  // if atleast one state is final, the new state is final too
+        Reduction_NFA(stored.original, stored.reduced);
+        stored.reduced_ready = true;
     }
-    std::sort(opt_name.begin(), opt_name.end());    // sort the vector of state names
-    for(auto i = opt_name.begin(); i != opt_name.end(); ++i)
-        st.name = st.name + *i + "|";         // create a name for the new state by merging names
-
-    result_automaton.states.push_back(st);  // push the state to Q
-    opt_Q.insert({st.name,&result_automaton.states.back()});
-    result_automaton.start_states.push_back(&result_automaton.states.back());    // push the state to S
-    if(st.final_st) result_automaton.final_states.insert(&result_automaton.states.back());   // mozna to neni potreba
-    W.push({automaton1.start_states,&result_automaton.states.back()});   // push the state to W
-
-    #ifdef DETERMINIZATION_DEBUG
-        Print_result_FA(result_automaton);
-    #endif
+    return stored.reduced;
+}
+
+// Function answers requests of the server protocol, one request per line, one response line per request:
+//      load                    - Timbuk automatons follow until a line "end", they are stored under their names -> ok names
+//      drop <name>             - removes automaton from the store -> ok
+//      list                    - names of stored automatons -> ok names
+//      empty <name>            - emptiness -> yes | no
+//      universal <name>        - universality (antichains with simulation) -> yes | no
+//      include <name1> <name2> - inclusion L(name1) <= L(name2) -> yes | no
+//      member <name> [a b ..]  - membership of the word (symbols separated by spaces) -> yes | no
+//      stats                   - number of queries and queries per second -> ok ...
+//      quit
+// Derived data (reduced automaton, simulation, minimal DFA, union and simulation of inclusion pairs) are computed
+// on the first query and stay resident until the automaton is loaded again or dropped. Errors are answered by "error <message>".
+// input: in - reference to input stream of requests
+// input: out - reference to output stream of responses
+// returns: void
+void Server(std::istream &in, std::ostream &out)
+{
+    std::unordered_map<std::string, Stored_FA> store;
+    std::unordered_map<std::string, Inclusion_pair> pairs;     // key: name1 + "\n" + name2
+    std::string line;
+    long queries = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    auto seconds = [&]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+    auto summary = [&]() { return "queries: " + std::to_string(queries) + " time: " + std::to_string(seconds()) + " s qps: " + std::to_string(queries / seconds()); };
+    auto find = [&](const std::string &name) -> Stored_FA &
+    {
+        auto seek = store.find(name);
+        if(seek == store.end()) throw Operation_error("unknown automaton " + name);
+        return seek->second;
+    };
+    auto forget_pairs = [&](const std::string &name)     // derived data of pairs with the automaton are invalid
+    {
+        for(auto p = pairs.begin(); p != pairs.end();)
+        {
+            if(p->first.substr(0, p->first.find('\n')) == name || p->first.substr(p->first.find('\n') + 1) == name) p = pairs.erase(p);
+            else ++p;
+        }
+    };
 
-    // main loop - until queue is empty
-    while(!W.empty())
+    while(std::getline(in, line))
     {
-        st_vect = W.front();
-        #ifdef DETERMINIZATION_DEBUG
-            std::cout << "\nDeterminization - st_vect: ";
-            for(auto i = st_vect.states.begin(); i != st_vect.states.end(); ++i)
-                std::cout << (*i)->name << ", ";
-            std::cout << "|| " << st_vect.source->name << std::endl;
-        #endif
+        std::istringstream request(line);
+        std::string command;
+        std::vector<std::string> args;
+        if(!(request >> command)) continue;     // empty line
+        for(std::string arg; request >> arg;) args.push_back(arg);
 
-        // for every letter of the alphabet
-        for(auto a = result_automaton.alphabet.begin(); a != result_automaton.alphabet.end(); ++a)
+        try
         {
-            #ifdef DETERMINIZATION_DEBUG
-                std::cout << "\nDeterminization - main loop: letter: " << *a << "\n";
-            #endif
-
-            st.name = "|";           // create and initialize a new state
-            st.final_st = false;
-            opt_name.clear();
-            opt_storage.clear();
-            // goes through all source states
-            for(auto i = st_vect.states.begin(); i != st_vect.states.end(); ++i)
+            if(command == "quit") break;
+            else if(command == "load")
             {
-                // for every state finds states reachable by the letter
-                range1 = (*i)->transit_states_p.equal_range(*a);
-                for(auto j = range1.first; j != range1.second; ++j)
+                std::string block;
+                while(std::getline(in, line) && line != "end") block = block + line + "\n";
+                std::istringstream timbuk(block);
+                std::vector<FA> automatons;
+                parse_FA(automatons, timbuk);
+
+                std::string names;
+                for(auto autom = automatons.begin(); autom != automatons.end(); ++autom)
                 {
-                    // insert the same state only once
-                    if(opt_storage.insert(j->second->name).second)
-                    {
-                        opt_name.push_back(j->second->name);    // push name of the state to optimalizing vector
-                        if(j->second->final_st) st.final_st = true;     // if atleast one state is final, the new state is final too
-                        storage.push_back(j->second);           // push to W later
-                    }
+                    std::string name = autom->name;
+                    forget_pairs(name);
+                    store.erase(name);
+                    store[name].original = std::move(*autom);
+                    names = names + " " + name;
                 }
+                out << "ok" << names << std::endl;
+            }
+            else if(command == "drop" && args.size() == 1)
+            {
+                find(args[0]);
+                forget_pairs(args[0]);
+                store.erase(args[0]);
+                out << "ok" << std::endl;
+            }
+            else if(command == "list")
+            {
+                out << "ok";
+                for(auto i = store.begin(); i != store.end(); ++i) out << " " << i->first;
+                out << std::endl;
             }
-            std::sort(opt_name.begin(), opt_name.end());        // sort names
-            for(auto i = opt_name.begin(); i != opt_name.end(); ++i)
-                st.name = st.name + *i + "|";            // create a name for the new state by merging names
-
-            // NEBO PRIDAT FAIL STAV? MUSI MIT DFA  PRO KAZDY STAV VSECHNY PRECHODY?
-            #ifndef DETERMINIZATION_FAIL_SWITCH
-            if(storage.empty()) continue;   // if no state can be reached by chosen letter -> continue to the next letter
-            #else
-            if(storage.empty())
+            else if(command == "stats")
             {
-                if(fail == nullptr)     // adds a fail state if it does not exist
+                out << "ok " << summary() << std::endl;
+            }
+            else if(command == "empty" && args.size() == 1)
+            {
+                ++queries;
+                out << (Emptiness_test(Stored_reduced(find(args[0]))) ? "yes" : "no") << std::endl;
+            }
+            else if(command == "universal" && args.size() == 1)
+            {
+                ++queries;
+                Stored_FA &stored = find(args[0]);
+                FA &reduced = Stored_reduced(stored);
+                if(!stored.preorder_ready)
                 {
-                    st.name = "fail";
-                    st.start_st = false;
-                    st.final_st = false;
-                    result_automaton.states.push_back(st);
-                    fail = &result_automaton.states.back();
-
-                    // add transitions from fail to fail for every letter
-                    for(auto alph = automaton1.alphabet.begin(); alph != automaton1.alphabet.end(); ++alph)
-                    {
-                        fail->transit_states_p.insert({*alph,fail});
-                        fail->reversed_transit_states_p.insert({*alph,fail});
-                    }
+                    Preorder(reduced, stored.preorder);
+                    stored.preorder_ready = true;
                 }
-                st_vect.source->transit_states_p.insert({*a,fail});
-                fail->reversed_transit_states_p.insert({*a,st_vect.source});
-                continue;
+                out << (Universality_NFA(reduced, stored.preorder) ? "yes" : "no") << std::endl;
             }
-            #endif // DETERMINIZATION_FAIL_SWITCH
-
-            // add state only if it is not already in Q (new automaton)
-            auto seek = opt_Q.find(st.name);
-            if(seek == opt_Q.end())
+            else if(command == "include" && args.size() == 2)
             {
-                st.start_st = false;
-                result_automaton.states.push_back(st);  // push the state to Q
-                opt_Q.insert({st.name,&result_automaton.states.back()});
-                if(st.final_st) result_automaton.final_states.insert(&result_automaton.states.back());   // mozna to neni potreba
-                W.push({storage,&result_automaton.states.back()});   // push the state to W
-
-                // always push relations
-                st_vect.source->transit_states_p.insert({*a,&result_automaton.states.back()});
-                result_automaton.states.back().reversed_transit_states_p.insert({*a,st_vect.source});    // reversed mozna neni potreba
+                ++queries;
+                std::string key = args[0] + "\n" + args[1];
+                auto seek = pairs.find(key);
+                if(seek == pairs.end())
+                {
+                    // Union_FA renames states of the second automaton, the pair has its own copies
+                    Inclusion_pair &pair = pairs[key];
+                    pair.first = Stored_reduced(find(args[0]));
+                    pair.second = Stored_reduced(find(args[1]));
+                    Union_FA(pair.first, pair.second, pair.united);
+                    Preorder(pair.united, pair.preorder);
+                    seek = pairs.find(key);
+                }
+                out << (Inclusion_NFA(seek->second.first, seek->second.second, seek->second.preorder) ? "yes" : "no") << std::endl;
             }
-            else
+            else if(command == "member" && args.size() >= 1)
             {
-                // always push relations
-                st_vect.source->transit_states_p.insert({*a,seek->second});
-                seek->second->reversed_transit_states_p.insert({*a,st_vect.source});    // reversed mozna neni potreba
+                ++queries;
+                Stored_FA &stored = find(args[0]);
+                if(!stored.minimal_ready)
+                {
+                    FA determinized;
+                    Determinization_FA(Stored_reduced(stored), determinized);
+                    Minimalization_FA(determinized, stored.minimal);
+                    stored.minimal_ready = true;
+                }
+                out << (Member_DFA(stored.minimal, std::vector<std::string>(args.begin() + 1, args.end())) ? "yes" : "no") << std::endl;
             }
-            storage.clear();
+            else out << "error unknown request " << line << std::endl;
         }
-        W.pop();
-        #ifdef DETERMINIZATION_DEBUG
-            std::cout << "\nDeterminization - endloop: \n";
-            Print_result_FA(result_automaton);
-        #endif
+        catch(const Automaton_error &error) { out << "error " << error.what() << std::endl; }
     }
+    std::cerr << summary() << std::endl;
 }
 
-// ---------------------------------------- MINIMALIZATION -----------------------------------------
+// ---------------------------------------- UNARY MODES AND BATCH -----------------------------------------
+
+// headings of the modes with one input automaton, -j applies them to every input automaton
+const std::map<std::string, std::string> unary_modes = {
+    {"-e", "EMPTINESS"}, {"-n", "REMOVE USELESS STATES"}, {"-d", "DETERMINIZATION"}, {"-dc", "DETERMINIZATION WITH COMPLETION"},
+    {"-ds", "DETERMINIZATION"}, {"-dcs", "DETERMINIZATION WITH COMPLETION"}, {"-m", "MINIMALIZATION"},
+    {"-mb", "MINIMALIZATION BRZOZOWSKI"}, {"-ma", "MINIMALIZATION (AUTOMATIC)"}, {"-s", "SIMULATION RELATION"}, {"-r", "REDUCTION"},
+    {"-b", "BISIMULATION REDUCTION"}, {"-bb", "BACKWARD BISIMULATION REDUCTION"},
+    {"-u", "UNIVERSALITY"}, {"-ui", "UNIVERSALITY IDENTITY"}, {"-uc", "UNIVERSALITY COMPLEMENT"}, {"-uic", "UNIVERSALITY IDENTITY COMPLEMENT"}};
+
+// result of a mode with one input automaton
+typedef struct {
+    std::string operation;          // name of the measured operation
+    Bench_result times;             // measurement of the operation
+    Stats counters;                 // work counters of the last run
+    Bench_fields fields;            // additional columns of the measurement record
+    std::string answer;             // answer of a decision procedure, empty -> the automaton or the relation is printed
+    FA automaton;                   // result automaton
+    bool relation = false;          // true -> preorder is the result (-s)
+    State_relation preorder;
+} Unary_result;
+
+// automaton of the batch (-j) and its formatted result
+typedef struct {
+    std::string name;               // name of the input automaton
+    long states = 0;                // size of the input automaton
+    long transitions = 0;
+    Unary_result result;
+    std::string text;               // formatted answer or result automaton
+    bool failed = false;            // the operation threw, text contains the error
+    bool done = false;              // the worker finished the automaton
+} Batch_item;
+
+// modes that use the result cache (--cache)
+const std::set<std::string> cached_modes = {"-s", "-ds", "-dcs", "-m", "-r", "-u", "-uc", "-i"};
+
+// Function returns the size limit of the result cache in bytes.
+// input: config - reference to settings of the measurement (--cache-limit)
+// returns: limit in bytes
+std::uintmax_t Cache_limit(const Bench_config &config)
+{
+    return (std::uintmax_t)config.cache_mb << 20;
+}
 
-// Function implements the Hopcroft algorithm. Computes the language partition, which is a list of blocks of states.
-// input: automaton1 - reference to source automaton, used to compute language partition
-// input: Partition_lan - result language partition
+// Function computes the simulation preorder of automaton (not measured). With --cache the relation is loaded
+// from the result cache, a miss computes it and stores it.
+// input: config - reference to settings of the measurement
+// input: automaton - reference to FA
+// input: preorder - reference to relation (output)
+// input: fields - reference to additional columns of the measurement record, cache_hit is added with --cache
 // returns: void
-void Hopcroft(FA &automaton1, std::list<std::vector<State *>> &Partition_lan)
+void Cached_preorder(const Bench_config &config, FA &automaton, State_relation &preorder, Bench_fields &fields)
 {
-    std::vector<State *> block1, block2;                    // block of the partition
-    std::pair<std::string, std::vector<State *> *> splitter;         // (a,B) splitter
-    std::list<std::pair<std::string, std::vector<State *> *>> W;     // list of (a,B) splitters
-    std::vector<State *> *bl1, *bl2;                        // pointers to blocks in the partition
-    bool splits_in, splits_out;                             // if both are true -> splitter splits a block
-    std::vector<State *> missing_block;
-
-    std::multimap<std::string, State *>::iterator iter;
-
-    // first condition of the algorithm - initializing partition
-    if(automaton1.final_states.empty() || automaton1.final_states.size() == automaton1.states.size())
-    {
-        for(auto i = automaton1.states.begin(); i != automaton1.states.end(); ++i)
-            block1.push_back(&(*i));
-        Partition_lan.push_back(block1);    // Q
-        #ifdef MINIMALIZATION_DEBUG
-            std::cout << "Minimalization: F=={} or Q-F=={}" << std::endl;
-        #endif // MINIMALIZATION_DEBUG
+    if(config.cache.empty())
+    {
+        Preorder(automaton, preorder);
         return;
     }
-    else
+    Result_cache cache(config.cache, Cache_limit(config));
+    std::string key = Fingerprint_FA(automaton);
+    bool hit = cache.load(key, preorder);
+    if(!hit)
     {
-        Partition_lan.push_back({});        // F
-        Partition_lan.push_back({});        // Q-F
-        for(auto i = automaton1.states.begin(); i != automaton1.states.end(); ++i)
-        {
-            if(i->final_st) Partition_lan.front().push_back(&(*i));
-            else Partition_lan.back().push_back(&(*i));
-        }
+        Preorder(automaton, preorder);
+        cache.store(key, preorder);
     }
-    #ifdef MINIMALIZATION_DEBUG
-        std::cout << "Partition print - first condition:\n";
-        Partition_print(Partition_lan);
-    #endif // MINIMALIZATION_DEBUG
+    fields.push_back({"cache_hit", hit});
+}
+
+// Function runs the mode with one input automaton and measures it (see Benchmark). Relations needed by the operation
+// (simulation, determinized automaton for -m) are computed before the measurement.
+// input: mode - -e, -n, -d, -dc, -ds, -dcs, -m, -mb, -ma, -s, -r, -b, -bb, -u, -ui, -uc or -uic
+// input: automaton - reference to input automaton, -n, -r, -b and -bb only read it and build the result anew in every run
+// input: config - reference to settings of the measurement
+// input: result - reference to result of the mode (output)
+// returns: void
+void Run_unary(const std::string &mode, FA &automaton, const Bench_config &config, Unary_result &result)
+{
+    State_relation preorder;
+    Alphabet_classes classes;
+    bool answer = false;
 
-    // fill W queue - (a,min{F,Q-F})
-    if(Partition_lan.front().size() < Partition_lan.back().size())
+    // --minterms: the operation runs over one representative of every class of letters, the result is expanded back
+    if(config.minterms)
     {
-        for(auto a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
-            W.push_back({*a,&Partition_lan.front()});
+        long letters = automaton.alphabet.size();
+        auto start = std::chrono::steady_clock::now();
+        long count = Compress_alphabet(automaton, classes);
+        double compress = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        result.fields = {{"letters", (double)letters}, {"classes", (double)count}, {"compress_ms", compress}};
     }
-    else
+
+    if(mode == "-e")
     {
-        for(auto a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
-            W.push_back({*a,&Partition_lan.back()});
+        result.operation = "emptiness";
+        result.times = Benchmark(config, []{}, [&]{ answer = Emptiness_test(automaton); });
+        result.answer = answer ? "Automaton is empty!" : "Automaton is not empty!";
     }
-
-    // main loop - while there are splitters
-    while(!W.empty())
+    else if(mode == "-n" || mode == "-r")
     {
-        splitter = W.front();           // splitter zmenen: misto pointeru na vektor nyni obsahuje hodnotovou kopii vektoru (mazani bloku pozdeji)
-        #ifdef MINIMALIZATION_DEBUG
-            std::cout << "Splitter print: (" << splitter.first << ", ";
-            Print_iter(*splitter.second);
-            std::cout << ")" << std::endl;
-        #endif // MINIMALIZATION_DEBUG
+        bool useless = (mode == "-n");
+        result.operation = useless ? "useless" : "reduction";
 
-        // go through all blocks in partition
-        for(auto i = Partition_lan.begin(); i != Partition_lan.end(); ++i)
+        std::string key;
+        bool hit = false;
+        if(!useless && !config.cache.empty())     // a hit replaces the reduction by loading of the reduced automaton (measured)
         {
-            splits_in = false;
-            splits_out = false;
-            block1.clear();
-            block2.clear();
-            // for every state of the block check where do its transitions lead
-            // i - block vector, j - state pointer
-            for(auto j = i->begin(); j != i->end(); ++j)
-            {
-                iter = (*j)->transit_states_p.find(splitter.first); // it is DFA so there can be only one transition using one letter
-                if(iter != (*j)->transit_states_p.end())            // mozna zbytecne, v DFA musi byt prechod pro kazde pismeno?
-                {
-                    // check if found transit state is in splitter block
-                    // creates blocks B0 and B1 that might split B
-                    auto k = splitter.second->begin();
-                    for(; k != splitter.second->end(); ++k)
-                    {
-                        if(iter->second->name == (*k)->name)    // it is in splitter block
-                        {
-                            splits_in = true;
-                            block1.push_back(*j);
-                            break;
-                        }
-                    }
-                    if(k == splitter.second->end())             // it is out of splitter block
-                    {
-                        splits_out = true;
-                        block2.push_back(*j);
-                    }
-                }
-                else    // if there is no transition for a letter, split the block (???)
-                {
-                    splits_out = true;
-                    block2.push_back(*j);
-                }
-            }
-            #ifdef MINIMALIZATION_DEBUG
-                std::cout << "Two blocks print: " << "(splits_in: " << splits_in << ", splits_out: " << splits_out << ")\n";
-                Print_iter(block1);
-                Print_iter(block2);
-                std::cout << std::endl;
-            #endif // MINIMALIZATION_DEBUG
-
-            // if there are transitions to both outside and inside of the splitter (if it actually splits B)
-            // -> erase B from partition list -> add B0 and B1
-            // pozor pointery!
-            if(splits_in && splits_out)
+            Result_cache cache(config.cache, Cache_limit(config));
+            key = Fingerprint_FA(automaton);
+            hit = cache.load("reduced", key, result.automaton);
+            result.fields.push_back({"cache_hit", hit});
+            if(hit)
             {
-                i = Partition_lan.insert(i, block1);        // insert new block before the old one, i points to the new block
-                bl1 = &(*i);                                // remember the pointer to the block
-                i = Partition_lan.insert(i, block2);        // insert second new block
-                bl2 = &(*i);                                // remember the pointer to the block
-                ++i;    // added two elements -> incrementing iterator by two to get back to the old block
-                ++i;
-
-                // posledni faze - upravy W
-                // for every letter of the alphabet
-                for(auto a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
-                {
-                    // goes through split queue
-                    auto split = ++W.begin();       // ignores first element (the already picked one)
-                    for(; split != W.end(); ++split)
-                    {
-                        // if splitter (a,B) exists -> replace it with (a,B0) and (a,B1)
-                        if(split->second == &(*i) && *a == split->first)
-                        {
-                            W.erase(split);     // pro jistotu
-                            W.insert(W.end(), {*a,bl1});
-                            split = W.insert(W.end(), {*a,bl2});
-                            break;
-                        }
-                    }
-                    // if splitter (a,B) does not exist -> insert (a,min{B0,B1})
-                    if(split == W.end())
-                    {
-                        if(bl1->size() < bl2->size()) W.push_back({*a,bl1});
-                        else W.push_back({*a,bl2});
-                    }
-                }
-                if(splitter.second == &(*i))    // if a block wants to split itself, it needs to temporarily save itself and redirect pointer
-                {
-                    missing_block = *i;              // temporary vector of deleted elements (function might delete block that will still be used in the future)
-                    splitter.second = &missing_block;// redirect pointer to this variable for the rest of the loop (alphabet)
-                }
-                i = Partition_lan.erase(i);     // returns iterator pointing to the next element but the for loop will increment again
-                --i;                            // therefore i decrement it here
+                result.times = Benchmark(config, [&]{ result.automaton = FA(); }, [&]{ cache.load("reduced", key, result.automaton); });
+                result.automaton.name = automaton.name;
             }
-            #ifdef MINIMALIZATION_DEBUG
-                std::cout << "Partition print - end:\n";
-                Partition_print(Partition_lan);
-            #endif // MINIMALIZATION_DEBUG
         }
-        W.pop_front();
-        #ifdef MINIMALIZATION_DEBUG
-            Minim_queue_print(W);
-        #endif // MINIMALIZATION_DEBUG
+        if(!hit)
+        {
+            // the input is only read, no run copies it
+            result.times = Benchmark(config, [&]{ result.automaton = FA(); }, [&]{
+                if(useless) Remove_useless_states(automaton, result.automaton);
+                else Reduction_NFA(automaton, result.automaton);
+            });
+            if(!key.empty()) Result_cache(config.cache, Cache_limit(config)).store("reduced", key, result.automaton);
+        }
+        automaton = FA();
     }
-}
+    else if(mode == "-b" || mode == "-bb")
+    {
+        bool backward = (mode == "-bb");
+        result.operation = backward ? "bisimulation_backward" : "bisimulation";
+        result.times = Benchmark(config, [&]{ result.automaton = FA(); }, [&]{ Bisimulation_NFA(automaton, result.automaton, backward); });
+        automaton = FA();
+    }
+    else if(mode == "-d" || mode == "-dc" || mode == "-ds" || mode == "-dcs")
+    {
+        bool complete = (mode == "-dc" || mode == "-dcs");
+        bool simulation = (mode == "-ds" || mode == "-dcs");     // macro states are pruned by the simulation preorder
+        result.operation = std::string(complete ? "determinization_complete" : "determinization") + (simulation ? "_simulation" : "");
+        if(simulation) Cached_preorder(config, automaton, preorder, result.fields);
 
-// Function implements the Minimalization algorithm. Computes minimal automaton from source automaton.
-// input: automaton1 - reference to source automaton, used to compute its minimal version
-// input: result_automaton - reference to result automaton, used to store result automaton
-// returns: void
-void Minimalization_FA(FA &automaton1, FA &result_automaton)
-{
-    std::list<std::vector<State *>> Partition_lan;
-    std::multimap<std::string, std::pair<std::string,State *>> relations;  // UNORDERED?
-    State st;
-    State * st_p;
-
-    std::vector<State *>::iterator it;
-    std::pair<std::multimap<std::string, std::pair<std::string,State *>>::iterator,std::multimap<std::string, std::pair<std::string,State *>>::iterator> it_range;
-    std::multimap<std::string, std::pair<std::string,State *>>::iterator range;
-    std::multimap<std::string, State *>::iterator seek;
-
-    Hopcroft(automaton1, Partition_lan);
-    #ifdef MINIMALIZATION_DEBUG
-        std::cout << "\nMINIMALIZATION:-------------------------------------\n";
-        Partition_print(Partition_lan);
-    #endif // MINIMALIZATION_DEBUG
-
-    // building a new minimal automaton
-    result_automaton.alphabet = automaton1.alphabet;
-    result_automaton.name = "min-" + automaton1.name;
-
-    // goes through all partitions, creates corresponding state in result_automaton and inserts requests for relations
-    for(auto block = Partition_lan.begin(); block != Partition_lan.end(); ++block)
-    {
-        st.name = "";
-        st.start_st = false;
-        st.final_st = false;
-        result_automaton.states.push_back(st);
-
-        // filling relations
-        st_p = &result_automaton.states.back();
-        it = block->begin();    // use just the first element in each block since all elements in the same block must have similar relations with blocks
-
-        // for every letter check where the first state points and save (name_of_the_state,{letter,pointer_to_partition_state}) into relations
-        for(auto a = result_automaton.alphabet.begin(); a != result_automaton.alphabet.end(); ++a)
+        result.times = Benchmark(config, [&]{ result.automaton = FA(); }, [&]{
+            Determinization_FA(automaton, result.automaton, complete, simulation ? &preorder : nullptr);
+        });
+    }
+    else if(mode == "-m")
+    {
+        FA determinized;
+        std::string key;
+        bool hit = false;
+        result.operation = "minimalization";
+        if(!config.cache.empty())     // a hit replaces determinization and minimalization by loading of the minimal DFA (measured)
         {
-            seek = (*it)->transit_states_p.find(*a);
-            if(seek != (*it)->transit_states_p.end())
-                relations.insert({seek->second->name,{*a,st_p}});
+            Result_cache cache(config.cache, Cache_limit(config));
+            key = Fingerprint_FA(automaton);
+            hit = cache.load("minimal", key, result.automaton);
+            result.fields.push_back({"cache_hit", hit});
+            if(hit)
+            {
+                result.times = Benchmark(config, [&]{ result.automaton = FA(); }, [&]{ cache.load("minimal", key, result.automaton); });
+                result.automaton.name = "min-det" + automaton.name;   // names given by Determinization_FA and Minimalization_FA
+            }
         }
-
-        // setting up the state
-        for(auto state = block->begin(); state != block->end(); ++state)
+        if(!hit)
         {
-            st_p->name = st_p->name + (*state)->name;
-            if((*state)->final_st) st_p->final_st = true;
-            if((*state)->start_st) st_p->start_st = true;
+            Determinization_FA(automaton, determinized);
+            result.times = Benchmark(config, [&]{ result.automaton = FA(); }, [&]{ Minimalization_FA(determinized, result.automaton); });
+            if(!key.empty()) Result_cache(config.cache, Cache_limit(config)).store("minimal", key, result.automaton);
         }
-        if(st_p->start_st) result_automaton.start_states.push_back(&result_automaton.states.back());
-        if(st_p->final_st) result_automaton.final_states.insert(&result_automaton.states.back());
     }
+    else if(mode == "-mb" || mode == "-ma")
+    {
+        bool automatic = (mode == "-ma");    // Brzozowski or Hopcroft is chosen by nondeterminism of the automaton and its reverse
+        Minimalization_report report;
+        result.operation = automatic ? "minimalization_automatic" : "minimalization_brzozowski";
 
-    // goes through all states again and connects name_of_the_state with letter and pointer_to_partition_state
-    // partitions correspond to states in result_automaton
-    std::list<State>::iterator iter;// = result_automaton.states.begin();
-    std::list<std::vector<State *>>::iterator block;// = Partition_lan.begin();
-    for(block = Partition_lan.begin(), iter = result_automaton.states.begin(); block != Partition_lan.end() && iter != result_automaton.states.end(); ++block, ++iter)
+        // the whole minimalization of NFA is measured, including determinization
+        result.times = Benchmark(config, [&]{ result.automaton = FA(); }, [&]{
+            report = Minimalization_NFA(automaton, result.automaton, automatic ? AUTOMATIC : BRZOZOWSKI);
+        });
+        result.fields.insert(result.fields.end(), {{"brzozowski", report.method == BRZOZOWSKI}, {"intermediate", (double)report.intermediate},
+                         {"output", (double)Count_states(result.automaton)}});
+    }
+    else if(mode == "-s")
     {
-        for(auto state = block->begin(); state != block->end(); ++state)
+        result.operation = "simulation";
+        result.relation = true;
+        if(!config.cache.empty())     // a hit replaces the computation by loading of the relation (measured)
         {
-            it_range = relations.equal_range((*state)->name);
-            for(range = it_range.first; range != it_range.second; ++range)
+            Result_cache cache(config.cache, Cache_limit(config));
+            std::string key = Fingerprint_FA(automaton);
+            bool hit = cache.load(key, result.preorder);
+            result.fields.push_back({"cache_hit", hit});
+            if(hit) result.times = Benchmark(config, [&]{ result.preorder.clear(); }, [&]{ cache.load(key, result.preorder); });
+            else
             {
-                // create relations
-                range->second.second->transit_states_p.insert({range->second.first,&(*iter)});
-                iter->reversed_transit_states_p.insert({range->second.first,range->second.second});
+                result.times = Benchmark(config, [&]{ result.preorder.clear(); }, [&]{ Preorder(automaton, result.preorder); });
+                cache.store(key, result.preorder);
             }
         }
+        else result.times = Benchmark(config, [&]{ result.preorder.clear(); }, [&]{ Preorder(automaton, result.preorder); });
     }
-}
-
-// ---------------------------------------- REDUCTION ILIE -----------------------------------------
-
-// Function implements the Simulation relation algorithm. Computes simulation relation of an automaton.
-// input: automaton1 - reference to source automaton, used to compute its minimal version
-// input: preorder - reference to result preorder, used to store simulation relation
-// returns: void
-void Preorder(FA &automaton1, std::unordered_set<std::pair<std::string,std::string>, pair_hash> &preorder)
-{
-    // sim, N(a)ik = card()
-
-    size_t counter = 0;                                     // counts indexes for states
-    // basically: int N[alphabet][state][state] = {0}
-    std::vector<std::vector<std::vector<int>>> N(automaton1.alphabet.size(),std::vector<std::vector<int>>
-                                                (automaton1.states.size(),std::vector<int>
-                                                (automaton1.states.size(),0)));
-    std::queue<std::pair<State *,State *>> W;               // queue of state pairs
-    std::pair<State *,State *> st_pair, st_pair2;           // inserting or removing pairs from W and preord
-    std::unordered_set<std::pair<std::string,std::string>, pair_hash> preord;
-
-    std::vector<std::string>::iterator a;      // iterates through alphabet
-    std::pair<std::multimap<std::string, State *>::iterator,std::multimap<std::string, State *>::iterator> range1, range2; // for .equal_range()
-
-    // initializing preord and W
-    for(auto i = automaton1.states.begin(); i != automaton1.states.end(); ++i)
+    else    // -u, -ui, -uc, -uic
     {
-        // preprocessing --------------------------
-        for(a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
+        bool identity = (mode == "-ui" || mode == "-uic");
+        bool complement = (mode == "-uc" || mode == "-uic");
+        result.operation = std::string("universality") + (identity ? "_identity" : "") + (complement ? "_complement" : "");
+        if(complement)
         {
-            // reversed relations are already computed inside reversed_transit_states_p (multimap)
-            // compute cardinality(rel(state,a))
-            i->card.insert({*a,i->transit_states_p.count(*a)});     // mozna zbytecne, toto muzu vypocitat i na miste
+            Complement_FA(automaton);
+            Materialize_FA(automaton);  // the relation is computed on the explicit automaton
         }
-        i->flag = counter;  // flag contains an index to N array
-        ++counter;
+        if(identity) Get_identity_relation(automaton, preorder);
+        else Cached_preorder(config, automaton, preorder, result.fields);
 
-        // W initialization -----------------------
-        for(auto j = automaton1.states.begin(); j != automaton1.states.end(); ++j)
-        {
-            if(i->final_st)     // add all pairs Fx(Q-F)
-            {
-                if(!j->final_st)// i=F, j=(Q-F)
-                {
-                    st_pair.first = &(*i);
-                    st_pair.second = &(*j);
-                    preord.insert({st_pair.first->name,st_pair.second->name});
-                    W.push(st_pair);
-                    continue;
-                }
-            }
-            // {(q,r)| Ea in alphabet: d(q,a)!=0 and d(r,a)==0}
-            for(auto a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
-            {
-                if((i->transit_states_p.count(*a) > 0) && (j->transit_states_p.count(*a) == 0) && preord.find({i->name,j->name}) == preord.end())
-                {
-                    st_pair.first = &(*i);
-                    st_pair.second = &(*j);
-                    preord.insert({st_pair.first->name,st_pair.second->name});
-                    W.push(st_pair);
-                }
-            }
-        }
-    }
-
-    #ifdef REDUCTION_DEBUG
-        std::cout << "Reduction - printing preord: ";
-        Print_reduct(preord);
-    #endif // REDUCTION_DEBUG
-
-    // main loop
-    while(!W.empty())
-    {
-        st_pair = W.front();    // (i,j)
-
-        #ifdef REDUCTION_DEBUG
-            std::cout << "Reduction - printing W pair: (" << st_pair.first->name << "," << st_pair.second->name << ")" << std::endl;
-        #endif // REDUCTION_DEBUG
-
-        for(a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
-        {
-            // get rd(j,a)
-            range1 = st_pair.second->reversed_transit_states_p.equal_range(*a);
-            for(auto k = range1.first; k != range1.second; ++k)
-            {
-                // N(a)ik <- N(a)ik + 1
-                N[a - automaton1.alphabet.begin()][st_pair.first->flag][k->second->flag]++;
-                if(N[a - automaton1.alphabet.begin()][st_pair.first->flag][k->second->flag] == k->second->card.find(*a)->second)
-                {
-                    // get rd(i,a)
-                    range2 = st_pair.first->reversed_transit_states_p.equal_range(*a);
-                    for(auto l = range2.first; l != range2.second; ++l)
-                    {
-                        st_pair2.first = l->second;
-                        st_pair2.second = k->second;
-                        if(preord.find({st_pair2.first->name,st_pair2.second->name}) == preord.end())   // if (l,k) not in preord
-                        {
-                            preord.insert({st_pair2.first->name,st_pair2.second->name});                // insert (l,k) into preord
-                            W.push(st_pair2);                       // insert (l,k) into queue
-
-                            #ifdef REDUCTION_DEBUG
-                                std::cout << "Reduction - pushing pair into preord and W: (" << st_pair2.first->name << "," << st_pair2.second->name << ")" << std::endl;
-                            #endif // REDUCTION_DEBUG
-                        }
-                    }
-                }
-            }
-        }
-        W.pop();
-    }
-
-    preorder.clear(); // clear preorder set
-    // converting complement preorder (preord) to preorder (preorder)
-    for(auto i = automaton1.states.begin(); i != automaton1.states.end(); ++i)
-    {
-        for(auto j = automaton1.states.begin(); j != automaton1.states.end(); ++j)
-        {
-            st_pair.first = &(*i);
-            st_pair.second = &(*j);
-            if(preord.find({st_pair.first->name,st_pair.second->name}) == preord.end()) preorder.insert({st_pair.first->name,st_pair.second->name});
-        }
+        result.times = Benchmark(config, []{}, [&]{ answer = Universality_NFA(automaton, preorder); });
+        result.answer = answer ? "Automaton is universal!" : "Automaton is not universal!";
     }
+    if(config.minterms && result.answer.empty() && !result.relation) Expand_alphabet(result.automaton, classes);
+    result.counters = stats;
 }
 
-// find a state with specific name in a list of states - help function
-State * find_in_states(std::list<State> &states, std::string name)
+// Function formats the answer or the result of the mode with one input automaton.
+// input: config - reference to settings of the measurement (--summary)
+// input: result - reference to result of the mode
+// input: out - reference to output buffer
+// returns: void
+void Format_unary(const Bench_config &config, const Unary_result &result, Output_buffer &out)
 {
-    for(auto temp = states.begin(); temp != states.end(); ++temp)
-        if(temp->name == name) return &(*temp);
-    return nullptr;
+    if(!result.answer.empty()) out << result.answer << "\n";
+    else if(result.relation) Print_reduct(result.preorder, out);
+    else if(config.summary) Format_summary_FA(result.automaton, out);
+    else Format_result_FA(result.automaton, out);
 }
 
-// Ilie - NFA reduction
-void Reduction_NFA(FA &automaton1)
+// Function applies the mode to every input automaton on config.jobs worker threads. Workers take the automatons in the input
+// order and format their results, the main thread prints every result (measurement record with the index of the automaton
+// and the formatted result) in the input order as soon as it is ready. Work and memory counters are kept per thread,
+// so every record contains counters of its own automaton.
+// input: mode - mode with one input automaton
+// input: automatons - reference to input automatons, they are freed by the workers
+// input: config - reference to settings of the measurement
+// returns: void
+void Batch(const std::string &mode, std::vector<FA> &automatons, const Bench_config &config)
 {
-    std::unordered_set<std::pair<std::string,std::string>, pair_hash> preorder_r, preorder_l;
-    std::multimap<std::string, State *> swap_tr;
-    std::pair<State *,State *> st_pair;
-    State *st, *st2;
-    std::string st_p1, st_p2;
-
-    std::unordered_set<std::pair<std::string,std::string>, pair_hash>::iterator seek, seek2;
-    std::pair<std::multimap<std::string, State *>::iterator,std::multimap<std::string, State *>::iterator> range1;
-
-    // get preorder R
-    Preorder(automaton1, preorder_r);
-
-    #ifdef REDUCTION_DEBUG
-        std::cout << "Reduction NFA - final r-preord: ";
-        Print_reduct(preorder_r);
-    #endif // REDUCTION_DEBUG
-
-
-    // construct a reverse automaton
-    for(auto state = automaton1.states.begin(); state != automaton1.states.end(); ++state)
-    {
-        swap_tr = state->transit_states_p;
-        state->transit_states_p = state->reversed_transit_states_p;
-        state->reversed_transit_states_p = swap_tr;
-        state->card.clear();
-
-        if(state->final_st)
-        {
-            state->final_st = state->start_st;
-            state->start_st = true;
-        }
-        else if(state->start_st)
-        {
-            state->start_st = state->final_st;
-            state->final_st = true;
-        }
-    }
-    auto help = automaton1.final_states;
-    automaton1.final_states.clear();
-    for(auto i = automaton1.start_states.begin(); i != automaton1.start_states.end(); ++i)
-        automaton1.final_states.insert(*i);
-
-    // get preorder L
-    Preorder(automaton1, preorder_l);
-
-    #ifdef REDUCTION_DEBUG
-        std::cout << "Reduction NFA - final l-preord: ";
-        Print_reduct(preorder_l);
-    #endif // REDUCTION_DEBUG
-
-    // construct a reverse automaton
-    for(auto state = automaton1.states.begin(); state != automaton1.states.end(); ++state)
-    {
-        swap_tr = state->transit_states_p;
-        state->transit_states_p = state->reversed_transit_states_p;
-        state->reversed_transit_states_p = swap_tr;
-
-        if(state->final_st)
+    std::vector<Batch_item> items(automatons.size());
+    std::atomic<std::size_t> next(0);
+    std::mutex lock;
+    std::condition_variable ready;
+    std::vector<std::thread> workers;
+    Memory_stats footprints;                // footprints of all workers
+    auto start = std::chrono::steady_clock::now();
+
+    auto work = [&]()
+    {
+        memory.enabled = config.memory;     // the counters are thread_local, every worker measures itself
+        for(std::size_t i = next++; i < automatons.size(); i = next++)
         {
-            state->final_st = state->start_st;
-            state->start_st = true;
-        }
-        else if(state->start_st)
-        {
-            state->start_st = state->final_st;
-            state->final_st = true;
-        }
-    }
-    automaton1.final_states = help;
-
-    /*
-    // converting complement preorder (preord) to preorder (preorder)
-    for(auto i = automaton1.states.begin(); i != automaton1.states.end(); ++i)
-    {
-        for(auto j = automaton1.states.begin(); j != automaton1.states.end(); ++j)
-        {
-            st_pair.first = &(*i);
-            st_pair.second = &(*j);
-            if(preord_r.find({st_pair.first->name,st_pair.second->name}) == preord_r.end()) preorder_r.insert({st_pair.first->name,st_pair.second->name});
-            if(preord_l.find({st_pair.first->name,st_pair.second->name}) == preord_l.end()) preorder_l.insert({st_pair.first->name,st_pair.second->name});
-        }
-    }*/
-    #ifdef REDUCTION_DEBUG
-        std::cout << "Reduction NFA - final r-preorder: ";
-        Print_reduct(preorder_r);
-        std::cout << "Reduction NFA - final l-preorder: ";
-        Print_reduct(preorder_l);
-    #endif // REDUCTION_DEBUG
-
-    // 1) p-q, q-p ve stejnem preorderu
-    // 2) p-q, p-q v rozdilnych preorderech
-    for(auto i = preorder_r.begin(); i != preorder_r.end(); ++i)
-    {
-        if(i->first == i->second) continue; // (p,p)
-        seek = preorder_r.find({i->second,i->first});
-        if(seek != preorder_r.end())    // found (p,q) (q,p) duo
-        {
-            // merging states p and q - transfering relations from p to q
-            st = find_in_states(automaton1.states, i->first);
-            for(auto j = st->reversed_transit_states_p.begin(); j != st->reversed_transit_states_p.end(); ++j)
+            Batch_item &item = items[i];
+            item.name = automatons[i].name;
+            item.states = Count_states(automatons[i]);
+            item.transitions = Count_transitions(automatons[i]);
+            try
             {
-                for(auto k = j->second->transit_states_p.begin(); k != j->second->transit_states_p.end(); ++k)
+                std::ostringstream text;
+                Run_unary(mode, automatons[i], config, item.result);
                 {
-                    if(k->second->name == i->first)
-                    {
-                        range1 = j->second->transit_states_p.equal_range(k->first);
-                        auto r = range1.first;
-                        for(; r != range1.second; ++r)
-                        {
-                            if(r->second->name == i->second) break;
-                        }
-                        if(r == range1.second) k->second = find_in_states(automaton1.states, i->second);
-                        else
-                        {
-                            k = j->second->transit_states_p.erase(k);
-                            --k;
-                        }
-                    }
+                    Output_buffer out(text);
+                    Format_unary(config, item.result, out);
                 }
+                item.text = text.str();
             }
-            st2 = find_in_states(automaton1.states, i->second);
-            for(auto j = st->transit_states_p.begin(); j != st->transit_states_p.end(); ++j)
+            catch(const std::exception &error)
             {
-                range1 = st2->transit_states_p.equal_range(j->first);
-                auto r = range1.first;
-                for(; r != range1.second; ++r)
-                {
-                    if(r->second == j->second) break;
-                }
-                if(r == range1.second) st2->transit_states_p.insert(*j);
-
-                range1 = j->second->reversed_transit_states_p.equal_range(j->first);
-                for(auto r = range1.first; r != range1.second; ++r)
-                {
-                    if(r->second == st) r->second = st2;
-                }
+                item.failed = true;
+                item.text = std::string("error ") + error.what() + "\n";
             }
-            st->transit_states_p.clear();
+            item.result.automaton = FA();       // only the text is printed
+            item.result.preorder.clear();
+            automatons[i] = FA();
 
-            // removing pairs from both preorders according to Ilie algorithm
-            st_p1 = i->first;
-            st_p2 = i->second;
-            for(auto j = automaton1.states.begin(); j != automaton1.states.end(); ++j)
-            {
-                seek2 = preorder_r.find({st_p2,j->name});
-                if(seek2 != preorder_r.end())
-                {
-                    if(preorder_r.find({st_p1,j->name}) == preorder_r.end())
-                        preorder_r.erase(seek2);
-                }
-                seek2 = preorder_l.find({st_p2,j->name});
-                if(seek2 != preorder_l.end())
-                {
-                    if(preorder_l.find({st_p1,j->name}) == preorder_l.end())
-                        preorder_l.erase(seek2);
-                }
-            }
-            // erasing (p,q) and (q,p) pairs from preorder_r
-            seek2 = preorder_r.find({st_p1,st_p2});
-            if(seek2 != preorder_r.end()) preorder_r.erase(seek2);
-            seek2 = preorder_r.find({st_p2,st_p1});
-            if(seek2 != preorder_r.end()) preorder_r.erase(seek2);
-
-            // erasing all pairs that contain deleted state p from both preorders
-            for(auto x = preorder_r.begin();x != preorder_r.end();)
-            {
-                if(x->first == st_p1 || x->second == st_p1)
-                {
-                    x = preorder_r.erase(x);
-                }
-                else ++x;
-            }
-            for(auto x = preorder_l.begin();x != preorder_l.end();)
-            {
-                if(x->first == st_p1 || x->second == st_p1)
-                {
-                    x = preorder_l.erase(x);
-                }
-                else ++x;
-            }
-
-            //Print_reduct(preorder_r);
-            for(auto temp = automaton1.states.begin(); temp != automaton1.states.end(); ++temp)
-                if(temp->name == st_p1) { temp->flag = -1; break; }     // mark the state for removal
+            std::lock_guard<std::mutex> guard(lock);
+            item.done = true;
+            ready.notify_one();
         }
-    }
-    // --------------------------------------------------
-    for(auto i = preorder_l.begin(); i != preorder_l.end(); ++i)
+        std::lock_guard<std::mutex> guard(lock);
+        Merge_footprints(footprints, memory);
+    };
+    for(long j = 0; j < config.jobs; ++j)
+        workers.emplace_back(work);
+
+    for(std::size_t i = 0; i < items.size(); ++i)
     {
-        if(i->first == i->second) continue; // (p,p)
-        seek = preorder_l.find({i->second,i->first});
-        if(seek != preorder_l.end())    // found (p,q) (q,p) duo
         {
-            // merging states p and q - transfering relations from p to q
-            st = find_in_states(automaton1.states, i->first);
-            for(auto j = st->reversed_transit_states_p.begin(); j != st->reversed_transit_states_p.end(); ++j)
-            {
-                for(auto k = j->second->transit_states_p.begin(); k != j->second->transit_states_p.end(); ++k)
-                {
-                    if(k->second->name == i->first)
-                    {
-                        range1 = j->second->transit_states_p.equal_range(k->first);
-                        auto r = range1.first;
-                        for(; r != range1.second; ++r)
-                        {
-                            if(r->second->name == i->second) break;
-                        }
-                        if(r == range1.second) k->second = find_in_states(automaton1.states, i->second);
-                        else
-                        {
-                            k = j->second->transit_states_p.erase(k);
-                            --k;
-                        }
-                    }
-                }
-            }
-            st2 = find_in_states(automaton1.states, i->second);
-            for(auto j = st->transit_states_p.begin(); j != st->transit_states_p.end(); ++j)
-            {
-                range1 = st2->transit_states_p.equal_range(j->first);
-                auto r = range1.first;
-                for(; r != range1.second; ++r)
-                {
-                    if(r->second == j->second) break;
-                }
-                if(r == range1.second) st2->transit_states_p.insert(*j);
-
-                range1 = j->second->reversed_transit_states_p.equal_range(j->first);
-                for(auto r = range1.first; r != range1.second; ++r)
-                {
-                    if(r->second == st) r->second = st2;
-                }
-            }
-            st->transit_states_p.clear();
-
-            // removing pairs from both preorders according to Ilie algorithm
-            st_p1 = i->first;
-            st_p2 = i->second;
-            for(auto j = automaton1.states.begin(); j != automaton1.states.end(); ++j)
-            {
-                seek2 = preorder_l.find({st_p2,j->name});
-                if(seek2 != preorder_l.end())
-                {
-                    if(preorder_l.find({st_p1,j->name}) == preorder_l.end())
-                        preorder_l.erase(seek2);
-                }
-                seek2 = preorder_r.find({st_p2,j->name});
-                if(seek2 != preorder_r.end())
-                {
-                    if(preorder_r.find({st_p1,j->name}) == preorder_r.end())
-                        preorder_r.erase(seek2);
-                }
-            }
-            // erasing (p,q) and (q,p) pairs from preorder_l
-            seek2 = preorder_l.find({st_p1,st_p2});
-            if(seek2 != preorder_l.end()) preorder_l.erase(seek2);
-            seek2 = preorder_l.find({st_p2,st_p1});
-            if(seek2 != preorder_l.end()) preorder_l.erase(seek2);
-
-            // erasing all pairs that contain deleted state p from both preorders
-            for(auto x = preorder_l.begin();x != preorder_l.end();)
-            {
-                if(x->first == st_p1 || x->second == st_p1)
-                {
-                    x = preorder_l.erase(x);
-                }
-                else ++x;
-            }
-            for(auto x = preorder_r.begin();x != preorder_r.end();)
-            {
-                if(x->first == st_p1 || x->second == st_p1)
-                {
-                    x = preorder_r.erase(x);
-                }
-                else ++x;
-            }
-
-            //Print_reduct(preorder_l);
-            for(auto temp = automaton1.states.begin(); temp != automaton1.states.end(); ++temp)
-                if(temp->name == st_p1) { temp->flag = -1; break; }     // mark the state for removal
+            std::unique_lock<std::mutex> guard(lock);
+            ready.wait(guard, [&]{ return items[i].done; });
         }
-    }
-    // ----------------------------------------------
-    for(auto i = preorder_r.begin(); i != preorder_r.end(); ++i)
-    {
-        if(i->first == i->second) continue; // (p,p)
-        seek = preorder_l.find({i->first,i->second});
-        if(seek != preorder_l.end())    // found (p,q) (p,q) duo
+        Batch_item &item = items[i];
+        if(config.format == "text") std::cout << "automaton " << i + 1 << ": " << item.name << std::endl;
+        if(!item.failed)
         {
-            // merging states p and q - transfering relations from p to q
-            st = find_in_states(automaton1.states, i->first);
-            for(auto j = st->reversed_transit_states_p.begin(); j != st->reversed_transit_states_p.end(); ++j)
-            {
-                for(auto k = j->second->transit_states_p.begin(); k != j->second->transit_states_p.end(); ++k)
-                {
-                    if(k->second->name == i->first)
-                    {
-                        range1 = j->second->transit_states_p.equal_range(k->first);
-                        auto r = range1.first;
-                        for(; r != range1.second; ++r)
-                        {
-                            if(r->second->name == i->second) break;
-                        }
-                        if(r == range1.second) k->second = find_in_states(automaton1.states, i->second);
-                        else
-                        {
-                            k = j->second->transit_states_p.erase(k);
-                            --k;
-                        }
-                    }
-                }
-            }
-            st2 = find_in_states(automaton1.states, i->second);
-            for(auto j = st->transit_states_p.begin(); j != st->transit_states_p.end(); ++j)
-            {
-                range1 = st2->transit_states_p.equal_range(j->first);
-                auto r = range1.first;
-                for(; r != range1.second; ++r)
-                {
-                    if(r->second == j->second) break;
-                }
-                if(r == range1.second) st2->transit_states_p.insert(*j);
-
-                range1 = j->second->reversed_transit_states_p.equal_range(j->first);
-                for(auto r = range1.first; r != range1.second; ++r)
-                {
-                    if(r->second == st) r->second = st2;
-                }
-            }
-            st->transit_states_p.clear();
-
-            st_p1 = i->first;
-            st_p2 = i->second;
-
-            // erasing (p,q) from preorder_r and preorder_l
-            preorder_r.erase(preorder_r.find({st_p1,st_p2}));
-            preorder_l.erase(preorder_l.find({st_p1,st_p2}));
-
-            for(auto temp = automaton1.states.begin(); temp != automaton1.states.end(); ++temp)
-                if(temp->name == st_p1) { temp->flag = -1; break; }     // mark the state for removal
+            Bench_fields fields = {{"automaton", (double)(i + 1)}};
+            fields.insert(fields.end(), item.result.fields.begin(), item.result.fields.end());
+            stats = item.result.counters;   // Print_benchmark prints the counters of the calling thread
+            Print_benchmark(config, item.result.operation, item.result.times, item.states, item.transitions, fields);
         }
+        std::cout << item.text;
+        item.text = std::string();
     }
-    // remove states - preorder function sets flag to some positive number, only states set to -1 by this function can have flag -1
-    //Restore_FA(automaton1, 1);
+    for(auto worker = workers.begin(); worker != workers.end(); ++worker)
+        worker->join();
+    Merge_footprints(memory, footprints);
+
+    if(config.format == "text")
+        std::cout << "batch: automatons: " << items.size() << " jobs: " << config.jobs << " wall: "
+                  << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
 }
 
-// --------------------------- UNIVERSALITY AND INCLUSION ----------------------
+// ---------------------------------------- TREE AUTOMATA -----------------------------------------
 
-// Function iterates (i,j are iterators) through macro state and if there is (i,j) pair in preorder, it deletes i from macro state. Implements second optimization.
-// input: macro_R - reference to source macro state
-// input: preorder - reference to simulation relation
-// returns: void
-void Minimize(Macro_state &macro_R, std::unordered_set<std::pair<std::string,std::string>, pair_hash> &preorder)
+// headings of the modes with tree automatons
+const std::map<std::string, std::string> tree_modes = {
+    {"-te", "TREE EMPTINESS"}, {"-tn", "TREE REMOVE USELESS STATES"}, {"-tp", "TREE PRODUCT (INTERSECTION)"},
+    {"-td", "TREE DETERMINIZATION"}, {"-ti", "TREE INCLUSION"}};
+
+// Function runs a mode with tree automatons - they are parsed from stdin with symbols of any arity (parse_TA).
+// input: mode - -te, -tn, -tp, -td or -ti
+// input: config - reference to settings of the measurement
+// returns: exit code of the program
+int Tree_mode(const std::string &mode, const Bench_config &config)
 {
-    for(auto i = macro_R.states.begin(); i != macro_R.states.end(); ++i)
+    std::vector<TA> automatons;
+    TA result_automaton;
+    Bench_result times;
+    std::string operation;
+    bool answer = false;
+    long number_of_states = 0;
+    long number_of_transitions = 0;
+
+    try
     {
-        for(auto j = macro_R.states.begin(); j != macro_R.states.end(); ++j)
-        {
-            if(i == j) continue;        // identity cannot remove state
-            if(preorder.find({(*i)->name,(*j)->name}) != preorder.end())  // if there is a pair (i,j) in preorder
-            {
-                i = --macro_R.states.erase(i); // remove i (because i is simulated by j)
-                break;
-            }
-        }
+        parse_TA(automatons);
     }
-}
-
-// Function checks if first macro state (macroSubs) is subset of second macro state (macroSuper).
-// For every state sub_st in first macro state there must be state super_st in second macro state such that (sub_st, super_st) are in preorder.
-// input: macroSubs - reference to first macro state
-// input: macroSuper - reference to second macro state
-// input: preorder - reference to simulation relation
-// returns: True if macroSubs is subset of macroSuper, false otherwise.
-bool Is_subset(Macro_state &macroSubs, Macro_state &macroSuper, std::unordered_set<std::pair<std::string,std::string>, pair_hash> &preorder)
-{
-    // for every state of subset
-    for(auto sub_st = macroSubs.states.begin(); sub_st != macroSubs.states.end(); ++sub_st)
+    catch(const Parse_error &error)
     {
-        // there must be a state in superset
-        auto super_st = macroSuper.states.begin();
-        for(; super_st != macroSuper.states.end(); ++super_st)
-        {
-            // such that sub_st <= super_st in preorder
-            if(preorder.find({(*sub_st)->name,(*super_st)->name}) != preorder.end()) break;
-        }
-        if(super_st == macroSuper.states.end()) return false;
+        std::cerr << error.what() << std::endl;
+        return 1;
     }
-    return true;
-}
-
-// Function implements the Universality algorithm.
-// input: automaton1 - reference to source automaton
-// input: preorder - reference to simulation relation
-// returns: True if automaton is universal, false if automaton is not universal
-bool Universality_NFA(FA &automaton1, std::unordered_set<std::pair<std::string,std::string>, pair_hash> &preorder)
-{
-    Macro_state macro_R, macro_P;               // macro states R and P
-    std::vector<Macro_state> processed, next;   // processed and next vectors
-    std::unordered_set<std::string> redundant;  // used to prevent redundancy of states when creating new macro states
-    bool exists_S;                              // used to check if S exists
-
-    std::vector<Macro_state>::iterator macro_S; // macro state S
-    std::pair<std::multimap<std::string, State *>::iterator,std::multimap<std::string, State *>::iterator> range1;    // .equal_range()
-
-    // if a macro state of start states is rejecting -> automaton does not recognise empty string (epsilon) as a part of the language
-    // -> language is not universal
-    macro_R.states = automaton1.start_states;
-    macro_R.rejecting = true;
-    for(auto state = macro_R.states.begin(); state != macro_R.states.end(); ++state)
+    bool binary = (mode == "-tp" || mode == "-ti");
+    if(automatons.size() < (binary ? 2 : 1))
     {
-        if((*state)->final_st) { macro_R.rejecting = false; break; }
+        std::cout << "The algorithm requires " << (binary ? "two automatons" : "one automaton") << " from stdin!" << std::endl;
+        return 4;
     }
-    if(macro_R.rejecting) return false;
-
-    // next = {Minimize(I)};
-    Minimize(macro_R, preorder);
-    next.push_back(macro_R);
-
-    // main loop
-    while(!next.empty())
+    for(std::size_t i = 0; i < (binary ? 2 : 1); ++i)
     {
-        macro_R = next.back();
-        next.pop_back();
-        processed.push_back(macro_R);
-
-        #ifdef UNIVERSALITY_DEBUG
-            std::cout << "Universality - printing current macro state: ";
-            Print_MacroState(macro_R);
-        #endif // UNIVERSALITY_DEBUG
-
-        // get adjacent macro states
-        for(auto a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
-        {
-            // getting Post(R) for specific letter *a
-            redundant.clear();
-            macro_P.states.clear();
-            macro_P.rejecting = true;
-            for(auto state = macro_R.states.begin(); state != macro_R.states.end(); ++state)
-            {
-                range1 = (*state)->transit_states_p.equal_range(*a);
-                for(auto next_st = range1.first; next_st != range1.second; ++next_st)
-                {
-                    if(redundant.insert(next_st->second->name).second)  // does not push redundant states - fast searching
-                    {
-                        macro_P.states.push_back(next_st->second);
-                        if(next_st->second->final_st) macro_P.rejecting = false;    // sets the rejecting flag
-                    }
-                }
-            }
-            #ifdef UNIVERSALITY_DEBUG
-                std::cout << "\tUniversality - printing new macro state (" << *a << ") before minimalization:\n\t\t";
-                Print_MacroState(macro_P);
-            #endif // UNIVERSALITY_DEBUG
-
-            Minimize(macro_P, preorder);
-
-            #ifdef UNIVERSALITY_DEBUG
-                std::cout << "\tUniversality - printing new macro state (" << *a << ") after minimalization:\n\t\t";
-                Print_MacroState(macro_P);
-            #endif // UNIVERSALITY_DEBUG
-
-            if(macro_P.rejecting) return false;
-
-            // search in processed for S such that S <= P
-            exists_S = false;
-            for(macro_S = processed.begin(); macro_S != processed.end();)
-            {
-                if(Is_subset(*macro_S, macro_P, preorder)) { exists_S = true; break; }
-
-                // remove all S from processed such that P <= S
-                if(Is_subset(macro_P, *macro_S, preorder))
-                    macro_S = processed.erase(macro_S);
-                else ++macro_S;
-            }
-            if(!exists_S)   // if not found yet
-            {
-                // search in next for S such that S <= P
-                for(macro_S = next.begin(); macro_S != next.end();)
-                {
-                    if(Is_subset(*macro_S, macro_P, preorder)) { exists_S = true; break; }
-
-                    // remove all S from next such that P <= S
-                    if(Is_subset(macro_P, *macro_S, preorder))
-                        macro_S = next.erase(macro_S);
-                    else ++macro_S;
-                }
-            }
-            // if no such S was found
-            if(!exists_S)
-            {
-                // add P to next
-                next.push_back(macro_P);
-                #ifdef UNIVERSALITY_DEBUG
-                    std::cout << "\tUniversality - pushing (into next) macro state ";
-                    Print_MacroState(macro_P);
-                #endif // UNIVERSALITY_DEBUG
-            }
-        }
+        number_of_states += automatons[i].states.size();
+        number_of_transitions += automatons[i].transitions.size();
     }
-    return true;
-}
-
-// Function implements the Inclusion algorithm. Checks if L(automaton1) is subset of L(automaton2).
-// input: automaton1 - reference to first automaton
-// input: automaton2 - reference to second automaton
-// input: preorder - reference to simulation relation of (automaton1 union automaton2)
-// returns: True if L(automaton1) is subset of L(automaton2), false otherwise.
-bool Inclusion_NFA(FA &automaton1, FA &automaton2, std::unordered_set<std::pair<std::string,std::string>, pair_hash> &preorder)
-{
-    Product_state prod_st1, prod_st2;
-    Macro_state macro_R, macro_P;               // macro states R and P
-    std::vector<Product_state> processed, next; // processed and next vectors
-    std::unordered_set<std::string> redundant;  // used to prevent redundancy of states when creating new macro states
-    bool exists_S;                              // used to check if S exists
-
-    std::vector<Product_state>::iterator prod_S; // product state S
-    std::pair<std::multimap<std::string, State *>::iterator,std::multimap<std::string, State *>::iterator> range1, range2;    // .equal_range()
-
-    // algorithm is meant for automatons with same alphabets!!!
-    // following code picks a smaller alphabet (that will be used for computation) - error prevention
-    std::vector<std::string> alphabet;
-    if(automaton1.alphabet.size() < automaton2.alphabet.size())
-        alphabet = automaton1.alphabet;
-    else
-        alphabet = automaton2.alphabet;
-    //if(automaton1.alphabet != automaton2.alphabet) {throw "Inclusion: alphabets are different!";}
 
-    // if a product state of p and start states is accepting -> automaton1 overlaps with complement of automaton2
-    // -> L(automaton1) (not)<= L(automaton2)
-    prod_st1.macro_st.states = automaton2.start_states;
-    prod_st1.macro_st.rejecting = true;
-    for(auto state = prod_st1.macro_st.states.begin(); state != prod_st1.macro_st.states.end(); ++state)
+    std::cout << "------------------------- " << tree_modes.at(mode) << " -------------------------\n";
+    if(mode == "-te")
     {
-        if((*state)->final_st) { prod_st1.macro_st.rejecting = false; break; }  // compute if macro state is rejecting
+        operation = "tree_emptiness";
+        times = Benchmark(config, []{}, [&]{ answer = Emptiness_TA(automatons[0]); });
     }
-
-    prod_st1.rejecting = true;              // if program does not end, product state must be rejecting for every start state from automaton1
-    Minimize(prod_st1.macro_st, preorder);  // minimize the macro state for initialization
-
-    for(auto a1_state = automaton1.start_states.begin(); a1_state != automaton1.start_states.end(); ++a1_state)
+    else if(mode == "-tn")
     {
-        if((*a1_state)->final_st && prod_st1.macro_st.rejecting) return false;  // if q from (q,I) is accepting and I is not accepting, return false
-        prod_st1.a1_st = *a1_state;
-        next.push_back(prod_st1);   // push product_state to next, later apply initialization
+        operation = "tree_useless";
+        times = Benchmark(config, [&]{ result_automaton = automatons[0]; }, [&]{ Remove_useless_TA(result_automaton); });
     }
-
-    // initialize(next) part
-    for(auto p_state = next.begin(); p_state != next.end();)
+    else if(mode == "-tp")
     {
-        // initialize(): condition (2)
-        auto m_state = p_state->macro_st.states.begin();
-        for(; m_state != p_state->macro_st.states.end(); ++m_state)
-            if(preorder.find({p_state->a1_st->name,(*m_state)->name}) != preorder.end()) break;   // found
-
-        if(m_state != p_state->macro_st.states.end())   // pair p<=q from (p,Q), q in Q, was found in preorder
-        {
-            p_state = next.erase(p_state);  // delete product state from next
-            continue;
-        }
-
-        // initialize(): condition (1)
-        for(auto p_state_2 = next.begin(); p_state_2 != next.end(); ++p_state_2)
-        {
-            if(p_state == p_state_2) continue;  // do not compare same elements
-            // (p,P),(q,Q) from next:               p <= q                           &&                         Q <= P
-            if( (preorder.find({p_state->a1_st->name,p_state_2->a1_st->name}) != preorder.end()) && Is_subset(p_state_2->macro_st, p_state->macro_st, preorder) )
-            {
-                p_state = next.erase(p_state);  // delete product state from next
-                --p_state;
-                break;
-            }
-        }
-        ++p_state;
+        operation = "tree_intersection";
+        times = Benchmark(config, [&]{ result_automaton = TA(); }, [&]{ Intersection_TA(automatons[0], automatons[1], result_automaton); });
     }
-
-    // main loop
-    while(!next.empty())
+    else if(mode == "-td")
     {
-        prod_st1 = next.back();
-        next.pop_back();
-        processed.push_back(prod_st1);
-
-        #ifdef INCLUSION_DEBUG
-            std::cout << "Inclusion - printing current product state: " << prod_st1.a1_st->name << ",";
-            Print_MacroState(prod_st1.macro_st);
-        #endif // INCLUSION_DEBUG
-
-        // get adjacent product states - for all a in alphabet
-        for(auto a = alphabet.begin(); a != alphabet.end(); ++a)
-        {
-            // getting Post(R) for specific letter *a
-            redundant.clear();
-            prod_st2.macro_st.states.clear();
-            prod_st2.macro_st.rejecting = true;
-            for(auto state = prod_st1.macro_st.states.begin(); state != prod_st1.macro_st.states.end(); ++state)
-            {
-                range1 = (*state)->transit_states_p.equal_range(*a);
-                for(auto next_st = range1.first; next_st != range1.second; ++next_st)
-                {
-                    if(redundant.insert(next_st->second->name).second)  // does not push redundant states - fast searching
-                    {
-                        prod_st2.macro_st.states.push_back(next_st->second);
-                        if(next_st->second->final_st) prod_st2.macro_st.rejecting = false;    // sets the rejecting flag
-                    }
-                }
-            }
-
-            #ifdef INCLUSION_DEBUG
-                std::cout << "\tInclusion - printing new macro state (" << *a << ") before minimalization:\n\t\t";
-                Print_MacroState(prod_st2.macro_st);
-            #endif // INCLUSION_DEBUG
-
-            Minimize(prod_st2.macro_st, preorder);  // optimization 1(a), mozny problem - rejecting kontroluju pred minimalizaci a ne az po
-
-            #ifdef INCLUSION_DEBUG
-                std::cout << "\tInclusion - printing new macro state (" << *a << ") after minimalization:\n\t\t";
-                Print_MacroState(prod_st2.macro_st);
-            #endif // INCLUSION_DEBUG
-
-            // for all Post(r) for specific letter *a and macro state Post(R)
-            range2 = prod_st1.a1_st->transit_states_p.equal_range(*a);
-            for(auto next_a1_st = range2.first; next_a1_st != range2.second; ++next_a1_st)
-            {
-                prod_st2.a1_st = next_a1_st->second;
-                if(next_a1_st->second->final_st && prod_st2.macro_st.rejecting) return false;
-                //else prod_st2.rejecting = true;
-                // optimization 1(b)
-                auto p = prod_st2.macro_st.states.begin();
-                for(; p != prod_st2.macro_st.states.end(); ++p)
-                {
-                    if(preorder.find({prod_st2.a1_st->name,(*p)->name}) != preorder.end()) break;
-                }
-                if(p == prod_st2.macro_st.states.end())    // optimization 2
-                {
-                    // search in processed for (s,S) such that p <= s && S <= P
-                    exists_S = false;
-                    for(prod_S = processed.begin(); prod_S != processed.end(); ++prod_S)
-                    {
-                        if( (preorder.find({prod_st2.a1_st->name,prod_S->a1_st->name}) != preorder.end()) &&
-                            Is_subset(prod_S->macro_st, prod_st2.macro_st, preorder) )
-                        { exists_S = true; break; }
-                    }
-                    if(!exists_S)   // if not found yet
-                    {
-                        // search in next for (s,S) such that p <= s && S <= P
-                        for(prod_S = next.begin(); prod_S != next.end(); ++prod_S)
-                        {
-                            if( (preorder.find({prod_st2.a1_st->name,prod_S->a1_st->name}) != preorder.end()) &&
-                                 Is_subset(prod_S->macro_st, prod_st2.macro_st, preorder) )
-                            { exists_S = true; break; }
-                        }
-                    }
-                    // if no such (s,S) was found
-                    if(!exists_S)
-                    {
-                        // remove all (s,S) from processed such that s <= p && P <= S
-                        for(prod_S = processed.begin(); prod_S != processed.end();)
-                        {
-                            if( (preorder.find({prod_S->a1_st->name,prod_st2.a1_st->name}) != preorder.end()) &&
-                                 Is_subset(prod_st2.macro_st, prod_S->macro_st, preorder))
-                                prod_S = processed.erase(prod_S);
-                            else ++prod_S;
-                        }
-                        // remove all (s,S) from next such that s <= p && P <= S
-                        for(prod_S = next.begin(); prod_S != next.end();)
-                        {
-                            if( (preorder.find({prod_S->a1_st->name,prod_st2.a1_st->name}) != preorder.end()) &&
-                                 Is_subset(prod_st2.macro_st, prod_S->macro_st, preorder))
-                                prod_S = next.erase(prod_S);
-                            else ++prod_S;
-                        }
-                        // add (p,P) to next
-                        next.push_back(prod_st2);
-                        #ifdef INCLUSION_DEBUG
-                            std::cout << "\tInclusion - pushing (into next) product state " << prod_st2.a1_st->name << ",";
-                            Print_MacroState(prod_st2.macro_st);
-                        #endif // INCLUSION_DEBUG
-                    }
-                }
-            }
-        }
+        operation = "tree_determinization";
+        times = Benchmark(config, [&]{ result_automaton = TA(); }, [&]{ Determinization_TA(automatons[0], result_automaton); });
     }
-    return true;
+    else    // -ti
+    {
+        operation = "tree_inclusion";
+        times = Benchmark(config, []{}, [&]{ answer = Inclusion_TA(automatons[0], automatons[1]); });
+    }
+    Print_benchmark(config, operation, times, number_of_states, number_of_transitions);
+
+    std::cout.flush();
+    Output_buffer out(STDOUT_FILENO);
+    if(mode == "-te") out << (answer ? "Automaton is empty!" : "Automaton is not empty!") << "\n";
+    else if(mode == "-ti") out << (answer ? "Automaton inclusion A <= B is true!" : "Automaton inclusion A <= B is not true!") << " (A - first, B - second automaton)\n";
+    else if(config.summary)
+        out << "Summary of automaton " << result_automaton.name << "\nstates: " << (std::uint64_t)result_automaton.states.size()
+            << " transitions: " << (std::uint64_t)result_automaton.transitions.size() << "\n\n\n";
+    else Print_TA(result_automaton, out);
+    return 0;
 }
 
-// ---------------------------------------- ADDITIONAL FUNCTIONS -----------------------------------------
+// ---------------------------------------- MAIN FUNCTION -----------------------------------------
 
-// Function generates the identity relation from states of automaton. It can be used for special versions of universality and inclusion checking.
-// input: automaton - reference to source automaton
-// input: preorder - reference to result identity relation
+// Function prints the result automaton of the mode, only its summary with --summary.
+// input: config - reference to settings of the measurement
+// input: automaton - reference to the result automaton
 // returns: void
-void Get_identity_relation(FA &automaton, std::unordered_set<std::pair<std::string,std::string>, pair_hash> &preorder)
+void Print_result(const Bench_config &config, const FA &automaton)
 {
-    for(auto state = automaton.states.begin(); state != automaton.states.end(); ++state)
-        preorder.insert({state->name,state->name});
+    if(config.summary) Print_summary_FA(automaton);
+    else Print_result_FA(automaton);
 }
 
-// Function implements the Union algorithm. Computes automaton1 union automaton2.
-// input: automaton1 - reference to first automaton
-// input: automaton2 - reference to second automaton
-// input: result_automaton - reference to result automaton, used to save result
+// Function prints usage of the program.
 // returns: void
-void Union_FA(FA &automaton1, FA &automaton2, FA &result_automaton)
+void Print_usage()
 {
-    std::multimap<std::string, std::pair<std::string,State *>> relations;
-    std::unordered_set<std::string> opt_s;
-    State st;
-    State * st_p;
-
-    //std::vector<State *>::iterator it;
-    std::pair<std::multimap<std::string, std::pair<std::string,State *>>::iterator,std::multimap<std::string, std::pair<std::string,State *>>::iterator> it_range;
-    std::multimap<std::string, std::pair<std::string,State *>>::iterator range;
-    std::pair<std::multimap<std::string, State *>::iterator, std::multimap<std::string, State *>::iterator> seek;
-
-    //if(automaton1.alphabet != automaton2.alphabet) {throw "Union: alphabets are different!";}
-    if(automaton1.alphabet.size() > automaton2.alphabet.size())
-        result_automaton.alphabet = automaton1.alphabet;
-    else
-        result_automaton.alphabet = automaton2.alphabet;
-
-    // building a new automaton that will be returned
-    result_automaton.name = automaton1.name + "+" + automaton2.name;
+    std::cout << "Wrong arguments (use: -e | -n | -p | -pe | -d | -dc | -ds | -dcs | -m | -mb | -ma | -s | -r | -b | -bb | -u | -ui | -uc | -uic | -i | -ii | -eq | -o | -x [-j N] | -w --words file | -c --header file"
+                 " [--warmup N] [--iterations N] [--time-ms N] [--format text|json|csv] [--bench-out file] [--stats] [--memory] [--summary] [--minterms]"
+                 " [--cache dir [--cache-limit MB]] - cache of -s -ds -dcs -m -r -u -uc -i)" << std::endl;
+    std::cout << "Pipeline (use: -q \"A1 & A2 | A3 ; det ; min ; trim\" - operators & |, brackets, stages and functions"
+                 " det detc min trim reduce compl + measurement options)" << std::endl;
+    std::cout << "Tree automatons (use: -te | -tn | -tp | -td | -ti + measurement options and --summary)" << std::endl;
+    std::cout << "Server (use: -S - requests load, drop, list, empty, universal, include, member, stats, quit on stdin)" << std::endl;
+    std::cout << "Random automatons (use: -g [--states N] [--alphabet N] [--density R] [--final R] [--seed N] [--count N]"
+                 " | -sw -e|-n|-p|-d|-dc|-ds|-m|-mb|-s|-r|-u|-i|-o [--sizes N,N,..] [--densities R,R,..] + generator and measurement options)" << std::endl;
+}
 
-    // goes through all states of first automaton, creates corresponding state in result_automaton and inserts requests for relations
-    for(auto s = automaton1.states.begin(); s != automaton1.states.end(); ++s)
+// main function - used to parse arguments and call appropriate algorithms
+int main(int argc, char *argv[])
+{
+    std::vector<FA> automatons;
+    FA result_automaton;
+    FA result_automaton2;
+    std::unordered_set<std::pair<std::string,std::string>, pair_hash> preorder;
+    Bench_config config;
+    Bench_result times;
+    Random_config random;
+    long count = 1;                                         // number of generated automatons (-g)
+    std::vector<double> sizes = {10, 20, 50, 100};          // grid of the sweep (-sw)
+    std::vector<double> densities = {1.25};
+
+    // program wants the algorithm argument and optional measurement options
+    if(argc < 2) { Print_usage(); return 3; }
+    std::string str;
+    str = argv[1];
+    std::string mode_argument;
+    int first_option = 2;
+    if(str == "-sw" || str == "-q")     // sweep is followed by the measured operation, pipeline by the expression
     {
-        st.name = s->name;
-        opt_s.insert(st.name);
-        st.start_st = s->start_st;
-        st.final_st = s->final_st;
-        st.flag = 0;
-        st.visited = false;
-        result_automaton.states.push_back(st);
-
-        // filling relations
-        st_p = &result_automaton.states.back();
-
-        // for every letter check where the state points and save (name_of_the_state,{letter,pointer_to_state}) into relations
-        for(auto a = result_automaton.alphabet.begin(); a != result_automaton.alphabet.end(); ++a)
-        {
-            seek = s->transit_states_p.equal_range(*a);
-            for(auto targ_state = seek.first; targ_state != seek.second; ++targ_state)
-            {
-                relations.insert({targ_state->second->name,{*a,st_p}});
-            }
-        }
-        if(st_p->start_st) result_automaton.start_states.push_back(&result_automaton.states.back());
-        if(st_p->final_st) result_automaton.final_states.insert(&result_automaton.states.back());
+        if(argc < 3) { Print_usage(); return 3; }
+        mode_argument = argv[2];
+        first_option = 3;
     }
-    // goes through all states of second automaton, creates corresponding state in result_automaton and inserts requests for relations
-    for(auto s = automaton2.states.begin(); s != automaton2.states.end(); ++s)
+    try
     {
-        if(opt_s.find(s->name) == opt_s.end())
-            st.name = s->name;
-        else
-        {
-            st.name = s->name + "_copy";
-        }
-        st.start_st = s->start_st;
-        st.final_st = s->final_st;
-        result_automaton.states.push_back(st);
-
-        // filling relations
-        st_p = &result_automaton.states.back();
-
-        // for every letter check where the state points and save (name_of_the_state,{letter,pointer_to_state}) into relations
-        for(auto a = result_automaton.alphabet.begin(); a != result_automaton.alphabet.end(); ++a)
+        for(int i = first_option; i < argc; ++i)
         {
-            seek = s->transit_states_p.equal_range(*a);
-            for(auto targ_state = seek.first; targ_state != seek.second; ++targ_state)
-            {
-                if(opt_s.find(targ_state->second->name) == opt_s.end())
-                    relations.insert({targ_state->second->name,{*a,st_p}});
-                else
-                    relations.insert({targ_state->second->name + "_copy",{*a,st_p}});
-            }
+            std::string opt = argv[i];
+            if(opt == "--stats") { config.stats = true; continue; }
+            if(opt == "--memory") { config.memory = true; continue; }
+            if(opt == "--summary") { config.summary = true; continue; }
+            if(opt == "--minterms") { config.minterms = true; continue; }
+            if(i + 1 >= argc) throw std::invalid_argument(opt);
+            if(opt == "--warmup") config.warmup = std::stol(argv[++i]);
+            else if(opt == "--iterations") config.iterations = std::stol(argv[++i]);
+            else if(opt == "-j") config.jobs = std::stol(argv[++i]);
+            else if(opt == "--time-ms") config.time_ms = std::stol(argv[++i]);
+            else if(opt == "--format") config.format = argv[++i];
+            else if(opt == "--bench-out") config.output = argv[++i];
+            else if(opt == "--words") config.words = argv[++i];
+            else if(opt == "--header") config.header = argv[++i];
+            else if(opt == "--cache") config.cache = argv[++i];
+            else if(opt == "--cache-limit") config.cache_mb = std::stol(argv[++i]);
+            else if(opt == "--states") random.states = std::stol(argv[++i]);
+            else if(opt == "--alphabet") random.alphabet = std::stol(argv[++i]);
+            else if(opt == "--density") random.density = std::stod(argv[++i]);
+            else if(opt == "--final") random.final_density = std::stod(argv[++i]);
+            else if(opt == "--seed") random.seed = std::stoul(argv[++i]);
+            else if(opt == "--count") count = std::stol(argv[++i]);
+            else if(opt == "--sizes") sizes = Parse_list(argv[++i]);
+            else if(opt == "--densities") densities = Parse_list(argv[++i]);
+            else throw std::invalid_argument(opt);
         }
-        if(st_p->start_st) result_automaton.start_states.push_back(&result_automaton.states.back());
-        if(st_p->final_st) result_automaton.final_states.insert(&result_automaton.states.back());
+        if((str == "-w") != !config.words.empty()) throw std::invalid_argument("--words");    // membership needs the words and only it
+        if((str == "-c") != !config.header.empty()) throw std::invalid_argument("--header");  // export needs the file of the matcher
+        if(config.format != "text" && config.format != "json" && config.format != "csv") throw std::invalid_argument(config.format);
+        if(config.warmup < 0 || config.iterations < 0 || config.time_ms < 0 || config.jobs < 0 || config.cache_mb < 0) throw std::invalid_argument("negative number");
+        if(!config.cache.empty() && !cached_modes.count(str)) throw std::invalid_argument("--cache");
+        if((config.jobs > 0 || config.minterms) && !unary_modes.count(str)) throw std::invalid_argument("-j");     // batch and minterms work only with one-automaton modes
+        if(random.states < 1 || random.alphabet < 1 || random.density < 0 || random.final_density < 0 || random.final_density > 1 || count < 1)
+            throw std::invalid_argument("generator");
+        for(auto i = sizes.begin(); i != sizes.end(); ++i)
+            if(*i < 1) throw std::invalid_argument("size");
+        for(auto i = densities.begin(); i != densities.end(); ++i)
+            if(*i < 0) throw std::invalid_argument("density");
+    }
+    catch(const std::exception &)
+    {
+        Print_usage();
+        return 3;
     }
 
-    // goes through all states again and connects name_of_the_state with letter and pointer_to_state
-    for(auto s = result_automaton.states.begin(); s != result_automaton.states.end(); ++s)
+    // modes without input automatons ---------------------
+    if(str == "-g")
     {
-        it_range = relations.equal_range(s->name);
-        for(range = it_range.first; range != it_range.second; ++range)
-        {
-            // create relations
-            range->second.second->transit_states_p.insert({range->second.first,&(*s)});
-            s->reversed_transit_states_p.insert({range->second.first,range->second.second});
-        }
+        for(long i = 0; i < count; ++i, ++random.seed)
+            Automaton::random(random).serialize(std::cout);
+        return 0;
     }
-    for(auto s = automaton2.states.begin(); s != automaton2.states.end(); ++s)
+    else if(str == "-sw")
     {
-        if(opt_s.find(s->name) != opt_s.end()) s->name = s->name + "_copy";
+        if(!Sweep(config, random, sizes, densities, mode_argument)) { Print_usage(); return 3; }
+        return 0;
     }
-}
-
-// Function implements Copy algorithm. Creates a copy of source automaton.
-// input: automaton1 - reference to source automaton
-// returns: A copy of a source automaton.
-FA Copy_FA(FA &automaton1)
-{
-    FA result_automaton;
-    std::multimap<std::string, std::pair<std::string,State *>> relations;
-    State st;
-    State * st_p;
-
-    std::pair<std::multimap<std::string, std::pair<std::string,State *>>::iterator,std::multimap<std::string, std::pair<std::string,State *>>::iterator> it_range;
-    std::multimap<std::string, std::pair<std::string,State *>>::iterator range;
-    std::pair<std::multimap<std::string, State *>::iterator, std::multimap<std::string, State *>::iterator> seek;
-
-    // building a new automaton that will be returned
-    result_automaton.name = automaton1.name;
-    result_automaton.alphabet = automaton1.alphabet;
-
-    // goes through all states of first automaton, creates corresponding state in result_automaton and inserts requests for relations
-    for(auto s = automaton1.states.begin(); s != automaton1.states.end(); ++s)
+    else if(str == "-S")    // requests are read from stdin, see Server
     {
-        st.name = s->name;
-        st.start_st = s->start_st;
-        st.final_st = s->final_st;
-        st.flag = 0;
-        st.visited = false;
-        result_automaton.states.push_back(st);
-
-        // filling relations
-        st_p = &result_automaton.states.back();
-
-        // for every letter check where the state points and save (name_of_the_state,{letter,pointer_to_state}) into relations
-        for(auto a = result_automaton.alphabet.begin(); a != result_automaton.alphabet.end(); ++a)
-        {
-            seek = s->transit_states_p.equal_range(*a);
-            for(auto targ_state = seek.first; targ_state != seek.second; ++targ_state)
-            {
-                relations.insert({targ_state->second->name,{*a,st_p}});
-            }
-        }
-        if(st_p->start_st) result_automaton.start_states.push_back(&result_automaton.states.back());
-        if(st_p->final_st) result_automaton.final_states.insert(&result_automaton.states.back());
+        Server(std::cin, std::cout);
+        return 0;
     }
-
-    // goes through all states again and connects name_of_the_state with letter and pointer_to_state
-    for(auto s = result_automaton.states.begin(); s != result_automaton.states.end(); ++s)
+    else if(tree_modes.count(str))  // tree automatons are parsed by their own parser
     {
-        it_range = relations.equal_range(s->name);
-        for(range = it_range.first; range != it_range.second; ++range)
+        memory.enabled = config.memory;
+        memory_phase_thread = std::this_thread::get_id();
+        return Tree_mode(str, config);
+    }
+    if(!config.cache.empty())
+    {
+        try
         {
-            // create relations
-            range->second.second->transit_states_p.insert({range->second.first,&(*s)});
-            s->reversed_transit_states_p.insert({range->second.first,range->second.second});
+            Result_cache cache(config.cache, Cache_limit(config));
+        }
+        catch(const Automaton_error &error)
+        {
+            std::cerr << error.what() << std::endl;
+            return 2;
         }
     }
-    return result_automaton;
-}
 
-// Function creates a complement of a source automaton. It does not create a new automaton.
-// input: automaton1 - reference to source automaton
-// returns: void
-void Complement_FA(FA &automaton1)
-{
-    automaton1.final_states.clear();
-    for(auto state = automaton1.states.begin(); state != automaton1.states.end(); ++state)
-    {
-        state->final_st = !state->final_st;
-        if(state->final_st) automaton1.final_states.insert(&(*state));
-    }
-}
-
-// ---------------------------------------- MAIN FUNCTION -----------------------------------------
-
-// main function - used to parse arguments and call appropriate algorithms
-int main(int argc, char *argv[])
-{
-    // program wants one argument
-    if(argc != 2) { std::cout << "Wrong arguments (use: -e | -n | -p | -d | -m | -s | -u | -ui | -i | -ii | -o | -x)" << std::endl; return 3; }
-
-    std::vector<FA> automatons;
-    FA result_automaton;
-    FA result_automaton2;
-    std::unordered_set<std::pair<std::string,std::string>, pair_hash> preorder;
+    // memory of the phases is measured from here (the hook of bakalarka_memory counts always)
+    memory.enabled = config.memory;
+    memory_phase_thread = std::this_thread::get_id();
+    Memory_phase("parse");
 
     // parse and print automatons -------------------------
     try
     {
-        parse_FA_stdin(automatons);
+        parse_FA(automatons);
     }
-    catch(const char *msg)
+    catch(const Parse_error &error)
     {
-        std::cerr << msg << std::endl;
+        std::cerr << error.what() << std::endl;
         return 1;
     }
     #ifdef MAIN_DEBUG
@@ -2203,68 +1499,28 @@ int main(int argc, char *argv[])
     long number_of_transitions = 0;
     for(auto autom = automatons.begin(); autom != automatons.end(); ++autom)
     {
-        number_of_states += autom->states.size();
-        for(auto j = autom->states.begin(); j != autom->states.end(); ++j)
-        {
-            number_of_transitions += j->transit_states_p.size();
-        }
+        number_of_states += Count_states(*autom);
+        number_of_transitions += Count_transitions(*autom);
     }
-    //int measurement_const = 49;       // number of measurements - 1
-    long counter = 0;       // counts the number of algorithm completions performed during measuring
-    int length_ms = 500;    // how long should the measurement last
+
+    Memory_phase("preprocessing");
 
     // parse arguments ------------------------------------
-    std::string str;
-    str = argv[1];
-    if(str == "-e")
+    if(unary_modes.count(str))
     {
         if(automatons.size() < 1) { std::cout << "The algorithm requires one automaton from stdin!" << std::endl; return 4; }
-        std::cout << "------------------------- EMPTINESS -------------------------\n";
-
-        auto startsw = std::chrono::high_resolution_clock::now();
-        std::clock_t startCPUtime = std::clock();
-        std::clock_t whenEnd = startCPUtime + (length_ms/1000.0) * CLOCKS_PER_SEC;
-        while(std::clock() < whenEnd)
+        std::cout << "------------------------- " << unary_modes.at(str) << " -------------------------\n";
+        if(config.jobs > 0) Batch(str, automatons, config);      // every input automaton
+        else
         {
-            Emptiness_test(automatons[0]);
-            ++counter;
-        }
-        bool return_value = Emptiness_test(automatons[0]);
-        std::clock_t endCPUtime = std::clock();
-        auto endsw = std::chrono::high_resolution_clock::now();
-        long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-        long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
-
-        std::cout << "states: " << number_of_states << " transitions: " << number_of_transitions << " cpu: " << std::fixed << std::setprecision(6) << CPUduration/(counter+1) << " wall: " << duration/(counter+1) << std::endl << std::endl;
+            Unary_result result;
+            Run_unary(str, automatons[0], config, result);
+            Print_benchmark(config, result.operation, result.times, number_of_states, number_of_transitions, result.fields);
 
-        if(return_value) std::cout << "Automaton is empty!" << std::endl;
-        else std::cout << "Automaton is not empty!" << std::endl;
-    }
-    else if(str == "-n")
-    {
-        if(automatons.size() < 1) { std::cout << "The algorithm requires one automaton from stdin!" << std::endl; return 4; }
-        std::cout << "------------------------- REMOVE USELESS STATES -------------------------\n";
-        FA result_automaton2;
-        result_automaton2 = Copy_FA(automatons[0]);
-
-        auto startsw = std::chrono::high_resolution_clock::now();
-        std::clock_t startCPUtime = std::clock();
-        std::clock_t whenEnd = startCPUtime + (length_ms/1000.0) * CLOCKS_PER_SEC;
-        while(std::clock() < whenEnd)
-        {
-            Remove_useless_states(automatons[0]);
-            automatons[0] = Copy_FA(result_automaton2);
-            ++counter;
+            std::cout.flush();
+            Output_buffer out(STDOUT_FILENO);
+            Format_unary(config, result, out);
         }
-        Remove_useless_states(automatons[0]);
-        std::clock_t endCPUtime = std::clock();
-        auto endsw = std::chrono::high_resolution_clock::now();
-        long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-        long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
-
-        std::cout << "states: " << number_of_states << " transitions: " << number_of_transitions << " cpu: " << std::fixed << std::setprecision(6) << CPUduration/(counter+1) << " wall: " << duration/(counter+1) << std::endl << std::endl;
-
-        Print_result_FA(automatons[0]);
     }
     else if(str == "-p")
     {
@@ -2272,350 +1528,220 @@ int main(int argc, char *argv[])
         std::cout << "------------------------- PRODUCT (INTERSECTION) -------------------------\n";
         try
         {
-            auto startsw = std::chrono::high_resolution_clock::now();
-            std::clock_t startCPUtime = std::clock();
-            std::clock_t whenEnd = startCPUtime + (length_ms/1000.0) * CLOCKS_PER_SEC;
-            while(std::clock() < whenEnd)
-            {
-                FA result_automaton;
-                Intersection_FA(automatons[0], automatons[1], result_automaton);
-                ++counter;
-            }
-            Intersection_FA(automatons[0], automatons[1], result_automaton);
-            std::clock_t endCPUtime = std::clock();
-            auto endsw = std::chrono::high_resolution_clock::now();
-            long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-            long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
+            std::vector<FA *> operands;     // more than two automatons -> k-ary product of all of them
+            for(auto autom = automatons.begin(); autom != automatons.end(); ++autom)
+                operands.push_back(&(*autom));
 
-            std::cout << "states: " << number_of_states << " transitions: " << number_of_transitions << " cpu: " << std::fixed << std::setprecision(6) << CPUduration/(counter+1) << " wall: " << duration/(counter+1) << std::endl << std::endl;
+            times = Benchmark(config, [&]{ result_automaton = FA(); }, [&]{
+                if(operands.size() > 2) Intersection_k_FA(operands, result_automaton);
+                else Intersection_FA(automatons[0], automatons[1], result_automaton);
+            });
+            Print_benchmark(config, "intersection", times, number_of_states, number_of_transitions);
 
-            Print_result_FA(result_automaton);
+            Print_result(config, result_automaton);
         }
-        catch(const char *msg)
+        catch(const Automaton_error &error)
         {
-            std::cerr << msg << std::endl;
+            std::cerr << error.what() << std::endl;
             return 2;
         }
     }
-    else if(str == "-d")
+    else if(str == "-pe")
     {
-        if(automatons.size() < 1) { std::cout << "The algorithm requires one automaton from stdin!" << std::endl; return 4; }
-        std::cout << "------------------------- DETERMINIZATION -------------------------\n";
-
-        auto startsw = std::chrono::high_resolution_clock::now();
-        std::clock_t startCPUtime = std::clock();
-        std::clock_t whenEnd = startCPUtime + (length_ms/1000.0) * CLOCKS_PER_SEC;
-        while(std::clock() < whenEnd)
+        if(automatons.size() < 2) { std::cout << "The algorithm requires two automatons from stdin!" << std::endl; return 4; }
+        std::cout << "------------------------- PRODUCT EMPTINESS -------------------------\n";
+        try
         {
-            FA result_automaton;
-            Determinization_FA(automatons[0], result_automaton);
-            ++counter;
-        }
-        Determinization_FA(automatons[0], result_automaton);
-        std::clock_t endCPUtime = std::clock();
-        auto endsw = std::chrono::high_resolution_clock::now();
-        long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-        long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
-
-        std::cout << "states: " << number_of_states << " transitions: " << number_of_transitions << " cpu: " << std::fixed << std::setprecision(6) << CPUduration/(counter+1) << " wall: " << duration/(counter+1) << std::endl << std::endl;
+            std::vector<FA *> operands;
+            bool return_value = false;
+            for(auto autom = automatons.begin(); autom != automatons.end(); ++autom)
+                operands.push_back(&(*autom));
 
-        Print_result_FA(result_automaton);
-    }
-    else if(str == "-m")
-    {
-        if(automatons.size() < 1) { std::cout << "The algorithm requires one automaton from stdin!" << std::endl; return 4; }
-        std::cout << "------------------------- MINIMALIZATION -------------------------\n";
-        Determinization_FA(automatons[0], result_automaton2);
+            times = Benchmark(config, [&]{ result_automaton = FA(); }, [&]{ return_value = Intersection_k_FA(operands, result_automaton, true); });
+            Print_benchmark(config, "intersection_emptiness", times, number_of_states, number_of_transitions);
 
-        auto startsw = std::chrono::high_resolution_clock::now();
-        std::clock_t startCPUtime = std::clock();
-        std::clock_t whenEnd = startCPUtime + (length_ms/1000.0) * CLOCKS_PER_SEC;
-        while(std::clock() < whenEnd)
+            if(return_value) std::cout << "Intersection is empty!" << std::endl;
+            else std::cout << "Intersection is not empty!" << std::endl;
+        }
+        catch(const Automaton_error &error)
         {
-            FA result_automaton;
-            Minimalization_FA(result_automaton2, result_automaton);
-            ++counter;
+            std::cerr << error.what() << std::endl;
+            return 2;
         }
-        Minimalization_FA(result_automaton2, result_automaton);
-        std::clock_t endCPUtime = std::clock();
-        auto endsw = std::chrono::high_resolution_clock::now();
-        long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-        long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
-
-        std::cout << "states: " << number_of_states << " transitions: " << number_of_transitions << " cpu: " << std::fixed << std::setprecision(6) << CPUduration/(counter+1) << " wall: " << duration/(counter+1) << std::endl << std::endl;
-
-        Print_result_FA(result_automaton);
     }
-    else if(str == "-s")
+    else if(str == "-i" || str == "-ii")
     {
-        if(automatons.size() < 1) { std::cout << "The algorithm requires one automaton from stdin!" << std::endl; return 4; }
-        std::cout << "------------------------- SIMULATION RELATION -------------------------\n";
-
-        auto startsw = std::chrono::high_resolution_clock::now();
-        std::clock_t startCPUtime = std::clock();
-        std::clock_t whenEnd = startCPUtime + (length_ms/1000.0) * CLOCKS_PER_SEC;
-        while(std::clock() < whenEnd)
+        if(automatons.size() < 2) { std::cout << "The algorithm requires two automatons from stdin!" << std::endl; return 4; }
+        bool identity = (str == "-ii");
+        if(identity) std::cout << "------------------------- INCLUSION IDENTITY -------------------------\n";
+        else std::cout << "------------------------- INCLUSION -------------------------\n";
+        try
         {
-            std::unordered_set<std::pair<std::string,std::string>, pair_hash> preorder;
-            Preorder(automatons[0], preorder);
-            ++counter;
-        }
-        Preorder(automatons[0], preorder);
-        std::clock_t endCPUtime = std::clock();
-        auto endsw = std::chrono::high_resolution_clock::now();
-        long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-        long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
+            Bench_fields fields;
+            Union_FA(automatons[0], automatons[1], result_automaton);
+            if(identity) Get_identity_relation(result_automaton, preorder);
+            else Cached_preorder(config, result_automaton, preorder, fields);
+            bool result_variable = false;
 
-        std::cout << "states: " << number_of_states << " transitions: " << number_of_transitions << " cpu: " << std::fixed << std::setprecision(6) << CPUduration/(counter+1) << " wall: " << duration/(counter+1) << std::endl << std::endl;
+            times = Benchmark(config, []{}, [&]{ result_variable = Inclusion_NFA(automatons[0], automatons[1], preorder); });
+            Print_benchmark(config, identity ? "inclusion_identity" : "inclusion", times, number_of_states, number_of_transitions, fields);
 
-        Print_reduct(preorder);
+            if(result_variable) std::cout << "Automaton inclusion A <= B is true! (A - first, B - second automaton)" << std::endl;
+            else std::cout << "Automaton inclusion A <= B is not true! (A - first, B - second automaton)" << std::endl;
+        }
+        catch(const Automaton_error &error)
+        {
+            std::cerr << error.what() << std::endl;
+            return 2;
+        }
     }
-    else if(str == "-r")
+    else if(str == "-eq")
     {
-        if(automatons.size() < 1) { std::cout << "The algorithm requires one automaton from stdin!" << std::endl; return 4; }
-        std::cout << "------------------------- REDUCTION -------------------------\n";
-
-        auto startsw = std::chrono::high_resolution_clock::now();
-        std::clock_t startCPUtime = std::clock();
-        Reduction_NFA(automatons[0]);
-        std::clock_t endCPUtime = std::clock();
-        auto endsw = std::chrono::high_resolution_clock::now();
-        long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-        long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
-
-        std::cout << "states: " << number_of_states << " cpu: " << std::fixed << std::setprecision(6) << CPUduration << " wall: " << duration << std::endl << std::endl;
+        if(automatons.size() < 2) { std::cout << "The algorithm requires two automatons from stdin!" << std::endl; return 4; }
+        std::cout << "------------------------- EQUIVALENCE -------------------------\n";
+        std::vector<std::string> word;
+        bool deterministic = Is_deterministic(automatons[0]) && Is_deterministic(automatons[1]);
+        bool result_variable = false;
 
-        Print_result_FA(automatons[0]);
-    }
-    else if(str == "-u")
-    {
-        if(automatons.size() < 1) { std::cout << "The algorithm requires one automaton from stdin!" << std::endl; return 4; }
-        std::cout << "------------------------- UNIVERSALITY -------------------------\n";
-        Preorder(automatons[0], preorder);
+        times = Benchmark(config, [&]{ word.clear(); }, [&]{ result_variable = Equivalence_FA(automatons[0], automatons[1], &word); });
+        Print_benchmark(config, "equivalence", times, number_of_states, number_of_transitions, {{"deterministic", deterministic}});
 
-        auto startsw = std::chrono::high_resolution_clock::now();
-        std::clock_t startCPUtime = std::clock();
-        std::clock_t whenEnd = startCPUtime + (length_ms/1000.0) * CLOCKS_PER_SEC;
-        while(std::clock() < whenEnd)
+        if(result_variable) std::cout << "Automatons are equivalent!" << std::endl;
+        else
         {
-            Universality_NFA(automatons[0], preorder);
-            ++counter;
+            std::cout << "Automatons are not equivalent! Distinguishing word:";
+            for(auto a = word.begin(); a != word.end(); ++a)
+                std::cout << " " << *a;
+            if(word.empty()) std::cout << " (empty word)";
+            std::cout << std::endl;
         }
-        bool result_variable = Universality_NFA(automatons[0], preorder);
-        std::clock_t endCPUtime = std::clock();
-        auto endsw = std::chrono::high_resolution_clock::now();
-        long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-        long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
-
-        std::cout << "states: " << number_of_states << " transitions: " << number_of_transitions << " cpu: " << std::fixed << std::setprecision(6) << CPUduration/(counter+1) << " wall: " << duration/(counter+1) << std::endl << std::endl;
-
-        if(result_variable) std::cout << "Automaton is universal!" << std::endl;
-        else std::cout << "Automaton is not universal!" << std::endl;
     }
-    else if(str == "-ui")
+    else if(str == "-o")
     {
-        if(automatons.size() < 1) { std::cout << "The algorithm requires one automaton from stdin!" << std::endl; return 4; }
-        std::cout << "------------------------- UNIVERSALITY IDENTITY -------------------------\n";
-        Get_identity_relation(automatons[0], preorder);
-        //Print_reduct(preorder);
-
-        auto startsw = std::chrono::high_resolution_clock::now();
-        std::clock_t startCPUtime = std::clock();
-        std::clock_t whenEnd = startCPUtime + (length_ms/1000.0) * CLOCKS_PER_SEC;
-        while(std::clock() < whenEnd)
-        {
-            Universality_NFA(automatons[0], preorder);
-            ++counter;
-        }
-        bool result_variable = Universality_NFA(automatons[0], preorder);
-        std::clock_t endCPUtime = std::clock();
-        auto endsw = std::chrono::high_resolution_clock::now();
-        long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-        long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
+        if(automatons.size() < 2) { std::cout << "The algorithm requires two automatons from stdin!" << std::endl; return 4; }
+        std::cout << "------------------------- UNION -------------------------\n";
 
-        std::cout << "states: " << number_of_states << " transitions: " << number_of_transitions << " cpu: " << std::fixed << std::setprecision(6) << CPUduration/(counter+1) << " wall: " << duration/(counter+1) << std::endl << std::endl;
+        times = Benchmark(config, [&]{ result_automaton = FA(); }, [&]{ Union_FA(automatons[0], automatons[1], result_automaton); });
+        Print_benchmark(config, "union", times, number_of_states, number_of_transitions);
 
-        if(result_variable) std::cout << "Automaton is universal!" << std::endl;
-        else std::cout << "Automaton is not universal!" << std::endl;
+        Print_result(config, result_automaton);
     }
-    else if(str == "-uc")
+    else if(str == "-x")
     {
-        if(automatons.size() < 1) { std::cout << "The algorithm requires one automaton from stdin!" << std::endl; return 4; }
-        std::cout << "------------------------- UNIVERSALITY COMPLEMENT -------------------------\n";
-        Complement_FA(automatons[0]);
-        Preorder(automatons[0], preorder);
-
-        auto startsw = std::chrono::high_resolution_clock::now();
-        std::clock_t startCPUtime = std::clock();
-        std::clock_t whenEnd = startCPUtime + (length_ms/1000.0) * CLOCKS_PER_SEC;
-        while(std::clock() < whenEnd)
-        {
-            Universality_NFA(automatons[0], preorder);
-            ++counter;
-        }
-        bool result_variable = Universality_NFA(automatons[0], preorder);
-        std::clock_t endCPUtime = std::clock();
-        auto endsw = std::chrono::high_resolution_clock::now();
-        long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-        long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
+        if(automatons.size() < 3) { std::cout << "The algorithm requires three automatons from stdin!" << std::endl; return 4; }
+        std::cout << "------------------------- SEQUENCE -------------------------\n";
+        FA result_automaton_p, result_automaton_o;
 
-        std::cout << "states: " << number_of_states << " transitions: " << number_of_transitions << " cpu: " << std::fixed << std::setprecision(6) << CPUduration/(counter+1) << " wall: " << duration/(counter+1) << std::endl << std::endl;
+        times = Benchmark(config, [&]{ result_automaton_p = FA(); result_automaton_o = FA(); result_automaton = FA(); }, [&]{
+            Intersection_FA(automatons[0], automatons[1], result_automaton_p);
+            Union_FA(result_automaton_p, automatons[2], result_automaton_o);
+            Determinization_FA(result_automaton_o, result_automaton, true);
+            Complement_FA(result_automaton);
+        });
+        Print_benchmark(config, "sequence", times, number_of_states, number_of_transitions);
 
-        if(result_variable) std::cout << "Automaton is universal!" << std::endl;
-        else std::cout << "Automaton is not universal!" << std::endl;
+        Print_result(config, result_automaton);
     }
-    else if(str == "-uic")
+    else if(str == "-w")
     {
         if(automatons.size() < 1) { std::cout << "The algorithm requires one automaton from stdin!" << std::endl; return 4; }
-        std::cout << "------------------------- UNIVERSALITY IDENTITY COMPLEMENT -------------------------\n";
-        Complement_FA(automatons[0]);
-        Get_identity_relation(automatons[0], preorder);
-        //Print_reduct(preorder);
-
-        auto startsw = std::chrono::high_resolution_clock::now();
-        std::clock_t startCPUtime = std::clock();
-        std::clock_t whenEnd = startCPUtime + (length_ms/1000.0) * CLOCKS_PER_SEC;
-        while(std::clock() < whenEnd)
+        std::ifstream file(config.words);
+        if(!file) { std::cerr << "Cannot open the file of words " << config.words << "!" << std::endl; return 1; }
+        std::cout << "------------------------- MEMBERSHIP -------------------------\n";
+
+        // one word per line, letters are separated by white space
+        std::vector<std::vector<std::string>> words;
+        std::string line, letter;
+        while(std::getline(file, line))
         {
-            Universality_NFA(automatons[0], preorder);
-            ++counter;
+            std::istringstream letters(line);
+            words.emplace_back();
+            while(letters >> letter) words.back().push_back(letter);
         }
-        bool result_variable = Universality_NFA(automatons[0], preorder);
-        std::clock_t endCPUtime = std::clock();
-        auto endsw = std::chrono::high_resolution_clock::now();
-        long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-        long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
-
-        std::cout << "states: " << number_of_states << " transitions: " << number_of_transitions << " cpu: " << std::fixed << std::setprecision(6) << CPUduration/(counter+1) << " wall: " << duration/(counter+1) << std::endl << std::endl;
 
-        if(result_variable) std::cout << "Automaton is universal!" << std::endl;
-        else std::cout << "Automaton is not universal!" << std::endl;
+        // compilation of the automaton and coding of the words are measured once, the batch by Benchmark
+        Bit_NFA compiled;
+        Coded_words coded;
+        std::vector<bool> accepted;
+        auto start = std::chrono::steady_clock::now();
+        Compile_bit_NFA(automatons[0], compiled);
+        Code_words(compiled, words, coded);
+        double compile = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        times = Benchmark(config, [&]{ accepted.clear(); }, [&]{ Member_batch(compiled, coded, accepted); });
+        long count = std::count(accepted.begin(), accepted.end(), true);
+        Print_benchmark(config, "membership", times, number_of_states, number_of_transitions,
+                        {{"words", (double)words.size()}, {"accepted", (double)count}, {"prepare_ms", compile}});
+
+        std::cout.flush();
+        Output_buffer out(STDOUT_FILENO);
+        if(config.summary) out << "words: " << (std::uint64_t)words.size() << " accepted: " << (std::uint64_t)count << "\n";
+        else
+            for(auto word = accepted.begin(); word != accepted.end(); ++word)
+                out << (*word ? "yes\n" : "no\n");
     }
-    else if(str == "-i")
+    else if(str == "-c")
     {
-        if(automatons.size() < 2) { std::cout << "The algorithm requires two automatons from stdin!" << std::endl; return 4; }
-        std::cout << "------------------------- INCLUSION -------------------------\n";
-        try
-        {
-            Union_FA(automatons[0], automatons[1], result_automaton);
-            Preorder(result_automaton, preorder);
+        if(automatons.size() < 1) { std::cout << "The algorithm requires one automaton from stdin!" << std::endl; return 4; }
+        std::cout << "------------------------- MATCHER EXPORT -------------------------\n";
 
-            auto startsw = std::chrono::high_resolution_clock::now();
-            std::clock_t startCPUtime = std::clock();
-            std::clock_t whenEnd = startCPUtime + (length_ms/1000.0) * CLOCKS_PER_SEC;
-            while(std::clock() < whenEnd)
+        // the matcher is generated from the minimal DFA
+        bool deterministic = Is_deterministic(automatons[0]);
+        times = Benchmark(config, [&]{ result_automaton = FA(); result_automaton2 = FA(); }, [&]{
+            if(deterministic) Minimalization_FA(automatons[0], result_automaton);
+            else
             {
-                Inclusion_NFA(automatons[0], automatons[1], preorder);
-                ++counter;
+                Determinization_FA(automatons[0], result_automaton2);
+                Minimalization_FA(result_automaton2, result_automaton);
             }
-            bool result_variable = Inclusion_NFA(automatons[0], automatons[1], preorder);
-            std::clock_t endCPUtime = std::clock();
-            auto endsw = std::chrono::high_resolution_clock::now();
-            long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-            long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
-
-            std::cout << "states: " << number_of_states << " transitions: " << number_of_transitions << " cpu: " << std::fixed << std::setprecision(6) << CPUduration/(counter+1) << " wall: " << duration/(counter+1) << std::endl << std::endl;
+        });
+        long states = Count_states(result_automaton);
+        Print_benchmark(config, "matcher", times, number_of_states, number_of_transitions, {{"matcher_states", (double)states}});
 
-            if(result_variable) std::cout << "Automaton inclusion A <= B is true! (A - first, B - second automaton)" << std::endl;
-            else std::cout << "Automaton inclusion A <= B is not true! (A - first, B - second automaton)" << std::endl;
+        std::ofstream file(config.header);
+        if(!file) { std::cerr << "Cannot open the file " << config.header << "!" << std::endl; return 1; }
+        try
+        {
+            Output_buffer out(file);
+            Export_matcher(result_automaton, automatons[0].name, out);
         }
-        catch(const char *msg)
+        catch(const Automaton_error &error)
         {
-            std::cerr << msg << std::endl;
+            std::cerr << error.what() << std::endl;
             return 2;
         }
+        std::cout << "Matcher of automaton " << automatons[0].name << " written to " << config.header << std::endl;
     }
-    else if(str == "-ii")
+    else if(str == "-q")
     {
-        if(automatons.size() < 2) { std::cout << "The algorithm requires two automatons from stdin!" << std::endl; return 4; }
-        std::cout << "------------------------- INCLUSION IDENTITY -------------------------\n";
+        std::cout << "------------------------- PIPELINE -------------------------\n";
+        std::vector<Pipeline_node> nodes;
+        std::vector<Pipeline_stage> stages;
+        std::size_t root;
         try
         {
-            Union_FA(automatons[0], automatons[1], result_automaton);
-            Get_identity_relation(result_automaton, preorder);
-
-            auto startsw = std::chrono::high_resolution_clock::now();
-            std::clock_t startCPUtime = std::clock();
-            std::clock_t whenEnd = startCPUtime + (length_ms/1000.0) * CLOCKS_PER_SEC;
-            while(std::clock() < whenEnd)
-            {
-                Inclusion_NFA(automatons[0], automatons[1], preorder);
-                ++counter;
-            }
-            bool result_variable = Inclusion_NFA(automatons[0], automatons[1], preorder);
-            std::clock_t endCPUtime = std::clock();
-            auto endsw = std::chrono::high_resolution_clock::now();
-            long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-            long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
-
-            std::cout << "states: " << number_of_states << " transitions: " << number_of_transitions << " cpu: " << std::fixed << std::setprecision(6) << CPUduration/(counter+1) << " wall: " << duration/(counter+1) << std::endl << std::endl;
-
-            if(result_variable) std::cout << "Automaton inclusion A <= B is true! (A - first, B - second automaton)" << std::endl;
-            else std::cout << "Automaton inclusion A <= B is not true! (A - first, B - second automaton)" << std::endl;
+            root = Parse_pipeline(mode_argument, automatons, nodes);
+            Evaluate_pipeline(nodes, root, config, stages);
         }
-        catch(const char *msg)
+        catch(const Parse_error &error)
         {
-            std::cerr << msg << std::endl;
-            return 2;
+            std::cerr << error.what() << std::endl;
+            return 3;
         }
-    }
-    else if(str == "-o")
-    {
-        if(automatons.size() < 2) { std::cout << "The algorithm requires two automatons from stdin!" << std::endl; return 4; }
-        std::cout << "------------------------- UNION -------------------------\n";
-
-        auto startsw = std::chrono::high_resolution_clock::now();
-        std::clock_t startCPUtime = std::clock();
-        std::clock_t whenEnd = startCPUtime + (length_ms/1000.0) * CLOCKS_PER_SEC;
-        while(std::clock() < whenEnd)
+        catch(const Automaton_error &error)
         {
-            FA result_automaton;
-            Union_FA(automatons[0], automatons[1], result_automaton);
-            ++counter;
+            std::cerr << error.what() << std::endl;
+            return 2;
         }
-        Union_FA(automatons[0], automatons[1], result_automaton);
-        std::clock_t endCPUtime = std::clock();
-        auto endsw = std::chrono::high_resolution_clock::now();
-        long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-        long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
+        Print_pipeline(nodes, stages, config);
 
-        std::cout << "states: " << number_of_states << " transitions: " << number_of_transitions << " cpu: " << std::fixed << std::setprecision(6) << CPUduration/(counter+1) << " wall: " << duration/(counter+1) << std::endl << std::endl;
-
-        Print_result_FA(result_automaton);
+        Print_result(config, nodes[root].value.read());
     }
-    else if(str == "-x")
-    {
-        if(automatons.size() < 3) { std::cout << "The algorithm requires three automatons from stdin!" << std::endl; return 4; }
-        std::cout << "------------------------- SEQUENCE -------------------------\n";
-        //int measurement_modif = measurement_const/4;
-        FA result_automaton_p, result_automaton_o, result_automaton;
+    else { Print_usage(); return 3; }
 
-        auto startsw = std::chrono::high_resolution_clock::now();
-        std::clock_t startCPUtime = std::clock();
-        std::clock_t whenEnd = startCPUtime + (length_ms/1000.0) * CLOCKS_PER_SEC;
-        while(std::clock() < whenEnd)
-        {
-            FA result_automaton_p, result_automaton_o, result_automaton;
-            Intersection_FA(automatons[0], automatons[1], result_automaton_p);
-            Union_FA(result_automaton_p, automatons[2], result_automaton_o);
-            Determinization_FA(result_automaton_o, result_automaton);
-            Complement_FA(result_automaton);
-            ++counter;
-        }
-        Intersection_FA(automatons[0], automatons[1], result_automaton_p);
-        Union_FA(result_automaton_p, automatons[2], result_automaton_o);
-        Determinization_FA(result_automaton_o, result_automaton);
-        Complement_FA(result_automaton);
-        std::clock_t endCPUtime = std::clock();
-        auto endsw = std::chrono::high_resolution_clock::now();
-        long double duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endsw - startsw).count() * 0.000001;
-        long double CPUduration = 1000.0 * ((long double)(endCPUtime - startCPUtime) / CLOCKS_PER_SEC);
-
-        std::cout << "states: " << number_of_states << " transitions: " << number_of_transitions << " cpu: " << std::fixed << std::setprecision(6) << CPUduration/(counter+1) << " wall: " << duration/(counter+1) << std::endl << std::endl;
-
-        Print_result_FA(result_automaton);
+    if(config.memory)
+    {
+        Memory_phase("");
+        Print_memory();
     }
-    else { std::cout << "Wrong arguments (use: -e | -n | -p | -d | -m | -s | -u | -ui | -i | -ii | -o | -x)" << std::endl; return 3; }
-
     return 0;
 }
@@ -0,0 +1,530 @@
+/*
+ * Knihovna algoritmů nad konečnými automaty k bakalářské práci v jazyce C++ (libbakalarka).
+ * Autor: Ondřej Polanský
+ * FIT VUT
+ * Brno 24.04.2020
+ * Obsah:
+        datové struktury
+        chyby knihovny
+        rozhraní algoritmů nad FA
+        hodnotové rozhraní Automaton
+ * Překlad: make libbakalarka.a libbakalarka.so, použití: #include "bakalarka.h" a -lbakalarka
+*/
+
+#ifndef BAKALARKA_H
+#define BAKALARKA_H
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <unordered_map>
+#include <utility>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <cstdint>
+
+
+// --------------------------------------------------------------------------------
+//                              DATA STRUCTURES
+// --------------------------------------------------------------------------------
+
+// structure containing information about state
+typedef struct st{
+    std::string name;                                               // name of the state
+    std::multimap<std::string, struct st *> transit_states_p;              // map of following states and transition rules - (alphabet letter,pointer)
+    std::vector<struct st *> epsilon_p;                             // targets of epsilon transitions (Epsilon_letter in Timbuk)
+    bool final_st = false;                                          // true -> state is final, else -> false
+    bool start_st = false;                                          // true -> state is start, else -> false
+    bool visited = false;                                           // true -> state was visited, else -> false
+    short int flag = 0;                                             // flag for multiple purposes
+    std::size_t id = 0;                                             // index of the state in the list of states, kept by every function that adds or removes states
+} State;
+
+// structure containing information about finite automaton
+// copying creates a deep copy (pointers lead into the copy), moving keeps the states in place and is O(1)
+typedef struct fa {
+    std::string name;                                       // name of the automaton
+    std::list<State> states;
+    std::vector<std::string> alphabet;                      // vector of alphabet
+    std::multimap<std::pair<std::string, std::string>, std::string> transitions;   // table of transitions - not used
+    std::vector<State *> start_states;                      // vector of starting states - pointers
+    std::set<State *> final_states;                         // set of final states - pointers
+    bool negated = false;                                   // true -> acceptance is negated (complement), final_st of states stays the same
+    bool sink = false;                                      // true -> complete automaton, missing transitions lead to an implicit sink state
+
+    fa() = default;
+    fa(const fa &other);
+    fa(fa &&other) = default;
+    fa &operator=(const fa &other);
+    fa &operator=(fa &&other) = default;
+} FA;
+
+// copy-on-write handle of an automaton - copies of the handle are O(1) and share one automaton,
+// the automaton is copied only when a shared handle is about to be changed
+class Shared_FA
+{
+    std::shared_ptr<FA> automaton;
+public:
+    Shared_FA() : automaton(std::make_shared<FA>()) {}
+    explicit Shared_FA(FA &&automaton1) : automaton(std::make_shared<FA>(std::move(automaton1))) {}
+
+    // read-only access, the automaton may be shared
+    const FA &read() const { return *automaton; }
+
+    // access for algorithms that change the automaton, copies it first if it is shared
+    FA &write()
+    {
+        if(automaton.use_count() > 1) automaton = std::make_shared<FA>(*automaton);
+        return *automaton;
+    }
+
+    // access for algorithms that change only the representation (Materialize_FA, renaming of states), not the language,
+    // the change is visible to all holders
+    FA &write_shared() { return *automaton; }
+
+    // drops the reference, the automaton is freed with the last holder
+    void release() { automaton.reset(); }
+};
+
+// Function returns true if state is accepting in automaton. Respects negated acceptance of the automaton.
+// input: automaton - reference to FA
+// input: state - pointer to a state of the automaton
+// returns: true - state is accepting, false - state is rejecting
+inline bool Is_final(const FA &automaton, const State *state)
+{
+    return state->final_st != automaton.negated;
+}
+
+// Function returns true if the implicit sink state of automaton exists and is accepting.
+// input: automaton - reference to FA
+// returns: true - implicit sink state is accepting, false - there is no sink or it is rejecting
+inline bool Is_sink_final(const FA &automaton)
+{
+    return automaton.sink && automaton.negated;
+}
+
+// direction-agnostic view of the transitions of an explicit automaton (Materialize_FA). The forward view reads the automaton
+// as it is, the reversed view reads its reverse (predecessors as successors, start and final states swapped) without
+// changing it. Predecessors are not stored in the states - they are built on the first request and shared by the view
+// and its reverse. States are indexed by State::id, the view is valid until the transitions of the automaton change.
+class FA_view
+{
+    const FA *automaton;
+    bool reversed;
+    std::size_t count;                                                              // number of states
+    std::shared_ptr<std::vector<std::multimap<std::string, State *>>> predecessors; // State::id -> predecessors, built lazily
+
+    const std::multimap<std::string, State *> &Predecessors(const State *state) const;
+public:
+    explicit FA_view(const FA &automaton1, bool reversed = false);
+
+    const FA &fa() const { return *automaton; }
+    bool is_reversed() const { return reversed; }
+
+    // view of the same automaton in the opposite direction, the predecessors are shared
+    FA_view reverse() const;
+
+    // successors and predecessors of a state by letters in the direction of the view
+    const std::multimap<std::string, State *> &post(const State *state) const
+    {
+        return reversed ? Predecessors(state) : state->transit_states_p;
+    }
+    const std::multimap<std::string, State *> &pre(const State *state) const
+    {
+        return reversed ? state->transit_states_p : Predecessors(state);
+    }
+
+    // start and final states in the direction of the view, final states respect negated acceptance
+    bool is_initial(const State *state) const { return reversed ? Is_final(*automaton, state) : state->start_st; }
+    bool is_final(const State *state) const { return reversed ? state->start_st : Is_final(*automaton, state); }
+};
+
+// relation on states stored as a bit matrix - row i contains all j such that (i,j) is in the relation (indexes are State::id)
+typedef std::vector<std::vector<std::uint64_t>> Bit_relation;
+
+// left side of an epsilon transition in Timbuk format - eps(p) -> q, unless eps is a letter of the alphabet (Ops)
+const std::string Epsilon_letter = "eps";
+
+// epsilon closures of the states of an automaton (Epsilon_closures) - states of one strongly connected component of epsilon
+// transitions share the closure, a component of one state without epsilon transitions to other states has no row
+typedef struct {
+    std::vector<State *> states;            // State::id -> state (deleted states have no closure)
+    std::vector<std::size_t> component;     // State::id -> component
+    std::vector<std::size_t> row;           // component -> index of its closure in rows, SIZE_MAX -> the closure is the state itself
+    Bit_relation rows;                      // closures as bit sets of State::id
+} Epsilon_closure;
+
+// parameters of the random automaton generator (Tabakov-Vardi model)
+typedef struct {
+    long states = 10;               // number of states
+    long alphabet = 2;              // size of the alphabet
+    double density = 1.25;          // transition density - number of transitions for every letter is density * states
+    double final_density = 0.5;     // final state density - number of final states is final_density * states
+    unsigned long seed = 1;         // seed of the generator
+} Random_config;
+
+// work counters of the algorithms, printed with --stats
+typedef struct {
+    std::uint64_t emptiness_visited = 0;        // Emptiness: states taken from the stack
+    std::uint64_t product_states = 0;           // Intersection: product states (pairs, tuples) explored
+    std::uint64_t product_transitions = 0;      // Intersection: product transitions created
+    std::uint64_t det_macro_states = 0;         // Determinization: macro states created
+    std::uint64_t det_duplicates = 0;           // Determinization: successors found already created
+    std::uint64_t det_pruned = 0;               // Determinization: states removed from macro states by simulation
+    std::uint64_t det_dead_letters = 0;         // Determinization: letters without transitions skipped in macro states
+    std::uint64_t hopcroft_splitters = 0;       // Minimalization: splitters taken from W
+    std::uint64_t hopcroft_splits = 0;          // Minimalization: blocks split
+    std::uint64_t preorder_updates = 0;         // Simulation: counter N(a) updates
+    std::uint64_t preorder_removed = 0;         // Simulation: pairs removed from the relation
+    std::uint64_t reduction_merged = 0;         // Reduction: states merged
+    std::uint64_t reduction_removed = 0;        // Reduction: states removed
+    std::uint64_t bisimulation_splitters = 0;   // Bisimulation: blocks taken from compound blocks
+    std::uint64_t bisimulation_splits = 0;      // Bisimulation: blocks split
+    std::uint64_t subset_calls = 0;             // Universality, Inclusion: Is_subset calls
+    std::uint64_t antichain_processed = 0;      // Universality, Inclusion: macro states taken from next
+    std::uint64_t antichain_pruned = 0;         // Universality, Inclusion: new macro states subsumed by existing ones
+    std::uint64_t antichain_removed = 0;        // Universality, Inclusion: macro states removed by a new one
+    std::uint64_t equivalence_pairs = 0;        // Equivalence: pairs of states merged by union-find
+    std::uint64_t equivalence_macro_states = 0; // Equivalence: macro states of nondeterministic automatons created
+} Stats;
+
+// global counters live in the namespace of the library, so they do not clash with names of its clients
+namespace bakalarka {
+extern thread_local Stats stats;     // every thread counts its own work
+}
+
+// counters of the allocation hook (operator new, only in bakalarka_memory) and footprints of the major structures, printed with --memory
+// counters are kept per thread, so the hook does not share a cache line between threads
+typedef struct {
+    bool enabled = false;                   // footprints and phases are computed only in the instrumentation mode
+    std::uint64_t allocations = 0;          // number of operator new calls
+    std::uint64_t allocated = 0;            // allocated bytes (usable size of the blocks)
+    std::int64_t peak = 0;                  // maximum of live bytes of the thread since the last reset (live bytes are kept by the hook)
+    std::uint64_t result_states = 0;        // footprint of the states of the largest result automaton
+    std::uint64_t preorder_N = 0;           // footprint of the N cube in Preorder
+    std::uint64_t preorder_relation = 0;    // footprint of the hash set of the relation in Preorder
+    std::uint64_t det_opt_Q = 0;            // footprint of opt_Q in Determinization
+    std::uint64_t antichains = 0;           // footprint of processed and next in Universality and Inclusion
+} Memory_stats;
+
+namespace bakalarka {
+extern thread_local Memory_stats memory;
+}
+
+// rule for computing hash in unordered_set
+struct pair_hash
+{
+    std::size_t operator () (std::pair<std::string,std::string> const &p) const
+    {
+        std::size_t h1 = std::hash<std::string>()(p.first);
+        std::size_t h2 = std::hash<std::string>()(p.second);
+
+        return h1^h2;
+    }
+};
+
+// relation on states given by pairs of their names (simulation preorder)
+typedef std::unordered_set<std::pair<std::string,std::string>, pair_hash> State_relation;
+
+// algorithm of the minimalization of NFA
+enum Minimalization_method { HOPCROFT, BRZOZOWSKI, AUTOMATIC };
+
+// result of the minimalization of NFA
+typedef struct {
+    Minimalization_method method;   // used algorithm (AUTOMATIC is resolved)
+    long intermediate;              // states of the intermediate DFA (determinized automaton or determinized reverse)
+} Minimalization_report;
+
+// classes of letters with identical transitions (minterms), algorithms run over one representative of every class
+typedef struct {
+    std::vector<std::string> alphabet;                                  // alphabet before the compression
+    std::unordered_map<std::string, std::vector<std::string>> members;  // representative -> other letters of its class
+} Alphabet_classes;
+
+// --------------------------------------------------------------------------------
+//                                  ERRORS
+// --------------------------------------------------------------------------------
+
+// base of all errors thrown by the library
+class Automaton_error : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// input is not in the expected format (Timbuk automatons, pipeline expressions)
+class Parse_error : public Automaton_error
+{
+public:
+    using Automaton_error::Automaton_error;
+};
+
+// operation cannot be applied to its operands (no operands, unknown automaton)
+class Operation_error : public Automaton_error
+{
+public:
+    using Automaton_error::Automaton_error;
+};
+
+// --------------------------------------------------------------------------------
+//                              OUTPUT BUFFER
+// --------------------------------------------------------------------------------
+
+// Output of the printing functions. Text is formatted into a large buffer, a full buffer is written at once by write(2)
+// (file descriptor), by std::ostream::write (stream) or it is only hashed (FNV-1a, summary of the output).
+class Output_buffer
+{
+    std::string buffer;
+    int fd = -1;                                    // target file descriptor, -1 -> stream or hash only
+    std::ostream *out = nullptr;                    // target stream
+    std::uint64_t hash = 14695981039346656037ULL;   // FNV-1a of all flushed bytes
+public:
+    static const std::size_t capacity = 1 << 20;    // size of the buffer that is written at once
+
+    explicit Output_buffer(int fd1);
+    explicit Output_buffer(std::ostream &out1);
+    Output_buffer();                                // output is only hashed
+    Output_buffer(const Output_buffer &) = delete;
+    Output_buffer &operator=(const Output_buffer &) = delete;
+    ~Output_buffer() { flush(); }
+
+    Output_buffer &operator<<(const std::string &s) { buffer.append(s); if(buffer.size() >= capacity) flush(); return *this; }
+    Output_buffer &operator<<(const char *s) { buffer.append(s); if(buffer.size() >= capacity) flush(); return *this; }
+    Output_buffer &operator<<(char c) { buffer.push_back(c); return *this; }
+    Output_buffer &operator<<(std::uint64_t n);
+
+    void flush();
+    std::uint64_t digest() { flush(); return hash; }   // hash of everything written so far
+};
+
+// automaton compiled for membership - sets of states are bit vectors, successors of every state under every letter
+// are precomputed masks, automatons with at most 64 states also have byte tables (successors of 8 states at once)
+typedef struct bit_nfa {
+    static constexpr std::size_t dense_limit = 1 << 21;     // maximal size of the masks (64-bit words), larger -> successor lists
+    static constexpr std::size_t lanes = 8;                 // words simulated at once by Member_batch (<= 64 states)
+    std::size_t states = 0;                             // number of states (with the implicit sink state)
+    std::size_t words = 0;                              // 64-bit words of a set of states
+    std::unordered_map<std::string, std::size_t> letters;  // letter -> index
+    std::vector<std::uint64_t> post;                    // successor masks [letter][state][word], empty -> successor lists
+    std::vector<std::size_t> offsets;                   // successors of row letter * states + state are targets[offsets[row] .. offsets[row + 1])
+    std::vector<std::uint32_t> targets;
+    std::vector<std::uint64_t> tables;                  // <= 64 states: [letter][byte][256] - successors of a byte of the set
+    std::vector<std::uint64_t> initial;                 // set of start states
+    std::vector<std::uint64_t> final;                   // set of accepting states
+} Bit_NFA;
+
+// words coded for Member_batch - letters are indexes of a compiled automaton, all words are in one buffer
+typedef struct coded_words {
+    static constexpr std::uint32_t unknown = UINT32_MAX;    // letter out of the alphabet - the word is not accepted
+    std::vector<std::uint32_t> letters;                 // letters of all words
+    std::vector<std::size_t> begin = {0};               // letters of word i are letters[begin[i] .. begin[i + 1])
+} Coded_words;
+
+// --------------------------------------------------------------------------------
+//                              ALGORITHMS ON FA
+// --------------------------------------------------------------------------------
+// Functions work on FA in place. Besides the documented results they may change the representation of their
+// operands (explicit sink, ids, names of clashing states), see their definitions in bakalarka_lib.cpp.
+
+// parser and output
+void parse_FA(std::vector<FA> &Automatons, std::istream &input = std::cin);     // throws Parse_error
+void print_FA(const std::vector<FA> &automatons);
+void Print_result_FA(const FA &automaton, bool alg_flag = false);
+void Print_summary_FA(const FA &automaton);
+void Format_result_FA(const FA &automaton, Output_buffer &out, bool alg_flag = false);
+void Format_summary_FA(const FA &automaton, Output_buffer &out);
+void Print_timbuk(const FA &automaton, std::ostream &out);
+void Print_timbuk(const FA &automaton, Output_buffer &out);
+
+// algorithms
+void Materialize_FA(FA &automaton);
+void Number_states(FA &automaton);
+const FA &Explicit_FA(const FA &automaton1, FA &copy);
+void Quotient_FA(const FA &automaton1, const std::vector<std::size_t> &representative, FA &result_automaton);
+bool Has_epsilon(const FA &automaton);
+void Epsilon_closures(const FA &automaton, Epsilon_closure &closures);
+void Close_epsilon(const Epsilon_closure &closures, std::vector<State *> &states);
+void Remove_epsilon_FA(FA &automaton);
+long Compress_alphabet(std::vector<FA *> &automatons, Alphabet_classes &classes);
+long Compress_alphabet(FA &automaton, Alphabet_classes &classes);
+void Expand_alphabet(FA &automaton, const Alphabet_classes &classes);
+bool Emptiness_test(const FA &automaton);
+void Remove_useless_states(FA &automaton);
+void Remove_useless_states(const FA &automaton1, FA &result_automaton);
+void Intersection_FA(FA &automaton1, FA &automaton2, FA &result_automaton);
+bool Intersection_k_FA(std::vector<FA *> &automatons, FA &result_automaton, bool emptiness_only = false);     // throws Operation_error
+void Determinization_FA(FA &automaton1, FA &result_automaton, bool complete = false, const State_relation *preorder = nullptr);
+void Minimalization_FA(FA &automaton1, FA &result_automaton);
+void Preorder(FA &automaton1, State_relation &preorder, Bit_relation *bits = nullptr);
+void Preorder(const FA_view &view, State_relation &preorder, Bit_relation *bits = nullptr);
+void Reduction_NFA(FA &automaton1);
+void Reduction_NFA(const FA &automaton1, FA &result_automaton);
+void Bisimulation_NFA(FA &automaton1, bool backward = false);
+void Bisimulation_NFA(const FA &automaton1, FA &result_automaton, bool backward = false);
+std::size_t Bisimulation_representatives(const FA_view &view, std::vector<std::size_t> &representative);
+long Brzozowski_FA(const FA &automaton1, FA &result_automaton);
+Minimalization_report Minimalization_NFA(FA &automaton1, FA &result_automaton, Minimalization_method method);
+bool Universality_NFA(FA &automaton1, State_relation &preorder);
+bool Inclusion_NFA(FA &automaton1, FA &automaton2, State_relation &preorder);
+bool Equivalence_FA(FA &automaton1, FA &automaton2, std::vector<std::string> *word = nullptr);
+void Get_identity_relation(const FA &automaton, State_relation &preorder);
+void Union_FA(FA &automaton1, FA &automaton2, FA &result_automaton);
+FA Copy_FA(const FA &automaton1);
+void Complement_FA(FA &automaton1);
+void Generate_FA(FA &result_automaton, const Random_config &config);
+
+// properties
+long Count_states(const FA &automaton);
+long Count_transitions(const FA &automaton);
+bool Is_deterministic(const FA &automaton);
+bool Member_DFA(const FA &automaton, const std::vector<std::string> &word);
+
+// membership on NFA (bit vectors of states)
+void Compile_bit_NFA(const FA &automaton, Bit_NFA &result);
+bool Member_NFA(const Bit_NFA &automaton, const std::vector<std::string> &word);
+void Code_words(const Bit_NFA &automaton, const std::vector<std::vector<std::string>> &words, Coded_words &coded);
+void Member_batch(const Bit_NFA &automaton, const Coded_words &coded, std::vector<bool> &accepted);
+void Member_batch(const Bit_NFA &automaton, const std::vector<std::vector<std::string>> &words, std::vector<bool> &accepted);
+
+// matcher export (C++ header), automatons with at most Matcher_switch_limit states get a switch-based matcher
+const std::size_t Matcher_switch_limit = 16;
+void Export_matcher(const FA &automaton, const std::string &name, Output_buffer &out);     // throws Operation_error
+
+// Function prints <st_name,st_name> container in preorder to stdout or to another output (stream, Output_buffer).
+// input: data_struct - reference to Tmpl
+// input: out - reference to output
+// returns: void
+template <class Tmpl, class Out = std::ostream>
+void Print_reduct(Tmpl &data_struct, Out &out = std::cout)
+{
+    out << "{";
+    for(auto i = data_struct.begin(); i != data_struct.end(); ++i)
+        out << "(" << i->first << "," << i->second << "), ";
+        //if(i->first != nullptr && i->second != nullptr) std::cout << "(" << i->first->name << "," << i->second->name << "), ";
+    out << "}\n";
+}
+
+// --------------------------------------------------------------------------------
+//                              RESULT CACHE
+// --------------------------------------------------------------------------------
+
+// fingerprint of the structure of an automaton (states, letters and transitions in their order, not the name)
+std::string Fingerprint_FA(const FA &automaton);
+
+// On-disk cache of derived data (simulation preorders, reduced automatons, minimal DFAs) keyed by Fingerprint_FA
+// of the input automaton. Every entry is one file of the directory, the least recently used entries are removed
+// when all entries exceed the size limit. Entries are written under a temporary name and renamed, so several
+// processes may share the directory. Damaged or missing entries and entries of another version are misses.
+class Result_cache
+{
+    std::string directory;
+    std::uintmax_t limit;                   // maximal size of all entries (bytes)
+
+    std::string path(const std::string &kind, const std::string &key) const;
+    bool read(const std::string &kind, const std::string &key, std::string &data) const;
+    void write(const std::string &kind, const std::string &key, const std::string &data);
+public:
+    static constexpr std::uintmax_t default_limit = 64 << 20;
+    // version of the entries, it must be increased whenever the format or the result of a cached algorithm changes
+    // (2 - Reduction_NFA merges bisimilar states first)
+    static constexpr int version = 2;
+
+    explicit Result_cache(const std::string &directory1, std::uintmax_t limit1 = default_limit);  // throws Operation_error
+
+    // kind names the derived automaton ("reduced", "minimal"), key is Fingerprint_FA of the input automaton
+    bool load(const std::string &key, State_relation &preorder) const;
+    bool load(const std::string &kind, const std::string &key, FA &automaton) const;
+    void store(const std::string &key, const State_relation &preorder);
+    void store(const std::string &kind, const std::string &key, const FA &automaton);
+    void evict();                           // removes the least recently used entries over the limit
+};
+
+// --------------------------------------------------------------------------------
+//                              TREE AUTOMATA
+// --------------------------------------------------------------------------------
+
+// transition f(q1,...,qn) -> q of a bottom-up tree automaton, states are indexes into TA::states
+typedef struct {
+    std::string symbol;                     // symbol f
+    std::vector<std::size_t> children;      // states q1,...,qn, empty for a leaf symbol (arity 0)
+    std::size_t target;                     // state q
+} TA_transition;
+
+// bottom-up tree automaton over a ranked alphabet (Timbuk symbols of any arity), a tree is accepted if its root
+// can be labeled by a final state
+typedef struct {
+    std::string name;                                   // name of the automaton
+    std::vector<std::string> states;                    // names of the states
+    std::vector<bool> final_st;                         // final_st[q] -> state q is final
+    std::map<std::string, std::size_t> ranks;           // ranked alphabet - symbol -> arity
+    std::vector<TA_transition> transitions;             // table of transitions
+    // indexes of the table, rebuilt by Index_TA
+    std::map<std::pair<std::string, std::vector<std::size_t>>, std::vector<std::size_t>> lookup;  // (symbol, children) -> transitions
+    std::map<std::string, std::vector<std::size_t>> by_symbol;     // symbol -> transitions
+    std::vector<std::vector<std::size_t>> parents;      // state -> transitions with the state as a child (once for every position)
+} TA;
+
+void parse_TA(std::vector<TA> &automatons, std::istream &input = std::cin);     // throws Parse_error
+void Print_TA(const TA &automaton, Output_buffer &out);
+void Index_TA(TA &automaton);
+std::vector<bool> Reachable_TA(const TA &automaton);
+bool Emptiness_TA(const TA &automaton);
+void Remove_useless_TA(TA &automaton);
+void Intersection_TA(const TA &automaton1, const TA &automaton2, TA &result_automaton);
+void Determinization_TA(const TA &automaton1, TA &result_automaton);
+bool Inclusion_TA(const TA &automaton1, const TA &automaton2);
+
+// --------------------------------------------------------------------------------
+//                                  AUTOMATON
+// --------------------------------------------------------------------------------
+
+// Value interface of the library. Copies are O(1) and share one automaton (copy-on-write, Shared_FA). Const operations
+// do not change the shared automaton (copies can be used by several threads), operations return new automatons. Errors are exceptions derived
+// from Automaton_error.
+class Automaton
+{
+    Shared_FA automaton;            // only read, algorithms that change the representation work on private copies
+public:
+    Automaton() = default;
+    explicit Automaton(FA automaton1);
+
+    // parse and serialize (Timbuk format)
+    static std::vector<Automaton> parse(std::istream &input);
+    void serialize(std::ostream &out) const;
+    void export_matcher(std::ostream &out) const;      // C++ header with a matcher of the DFA (Export_matcher)
+    std::string to_string() const;
+    static Automaton random(const Random_config &config);
+
+    // access and properties
+    const FA &get() const;
+    const std::string &name() const;
+    long states() const;
+    long transitions() const;
+    bool is_deterministic() const;
+
+    // decision procedures
+    bool is_empty() const;
+    bool is_universal() const;                                      // antichains with simulation
+    bool is_included_in(const Automaton &other) const;              // L(this) <= L(other)
+    bool is_equivalent_to(const Automaton &other, std::vector<std::string> *word = nullptr) const;   // word distinguishes them
+    bool accepts(const std::vector<std::string> &word) const;
+    std::vector<bool> accepts_all(const std::vector<std::vector<std::string>> &words) const;   // batch, compiled once
+    State_relation simulation() const;
+
+    // operations
+    Automaton intersection(const Automaton &other) const;
+    static Automaton intersection(const std::vector<Automaton> &automatons);   // throws Operation_error for no automatons
+    Automaton union_with(const Automaton &other) const;
+    Automaton determinize(bool complete = false, bool simulation = false) const;  // simulation -> macro states pruned by Preorder
+    Automaton minimize(Minimalization_method method = HOPCROFT) const;      // Hopcroft determinizes a nondeterministic automaton first
+    Automaton complement() const;
+    Automaton trim() const;
+    Automaton reduce() const;
+    Automaton bisimulation_reduce(bool backward = false) const;
+};
+
+#endif
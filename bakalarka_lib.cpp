@@ -0,0 +1,4945 @@
+/*
+ * Knihovna algoritmů k bakalářské práci v jazyce C++ (rozhraní v bakalarka.h).
+ * Autor: Ondřej Polanský
+ * FIT VUT
+ * Brno 24.04.2020
+ * Obsah:
+        pomocné datové struktury
+        parsování automatů ze vstupu
+        výpisové funkce
+        jednotlivé implementace algoritmů
+        hodnotové rozhraní Automaton
+*/
+
+#include "bakalarka.h"
+
+#include <queue>
+#include <stack>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <cerrno>
+#include <unistd.h>
+#include <cctype>
+#include <fstream>
+#include <filesystem>
+#include <atomic>
+
+//#define PARSE_DEBUG
+//#define EMPTINESS_DEBUG
+//#define USELESS_DEBUG
+//#define INTERSECTION_DEBUG
+//#define DETERMINIZATION_DEBUG
+//#define MINIMALIZATION_DEBUG
+//#define REDUCTION_DEBUG
+//#define UNIVERSALITY_DEBUG
+//#define INCLUSION_DEBUG
+//#define NO_STATS         // removes work counters (--stats) from the build
+
+
+// --------------------------------------------------------------------------------
+//                         INTERNAL DATA STRUCTURES
+// --------------------------------------------------------------------------------
+
+// structure used in Intersection algorithm
+typedef struct {
+    State * first;                  // state from FA A
+    State * second;                 // state from FA B
+    State * source;                 // already pushed state from FA A&B
+} Inters_help;
+
+// structure used in k-ary Intersection algorithm
+typedef struct {
+    std::vector<State *> states;    // tuple of states - one state from every automaton
+    State * source;                 // already pushed state from the product
+} Inters_k_help;
+
+// structure used in Determinization algorithm
+typedef struct {
+    std::vector<State *> states;    // states to merge
+    State * source;                 // already pushed merged state
+} Determin_help;
+
+// structure used in Minimalization algorithm
+typedef struct {
+    State * source;
+    std::string letter;
+    State * target;
+} Minimal_help;
+
+// structure used in Universality and Inclusion algorithm
+typedef struct {
+    std::vector<State *> states;    // states of a macro state
+    bool rejecting;                 // indicates if macro state is accepting or rejecting
+} Macro_state;
+
+// structure used in Inclusion algorithm
+typedef struct {
+    State *a1_st;                   // state from first automaton
+    Macro_state macro_st;           // macro state in second automaton
+    bool rejecting;                 // indicates if product state is accepting or rejecting
+} Product_state;
+
+// union-find structure (disjoint sets) used in Reduction algorithm - roots are the states that are kept
+typedef struct {
+    std::vector<std::size_t> parent;    // parent[i] == i -> i is a representative of its class
+
+    // returns the representative of the class of x (path halving)
+    std::size_t find(std::size_t x)
+    {
+        while(parent[x] != x) { parent[x] = parent[parent[x]]; x = parent[x]; }
+        return x;
+    }
+} Union_find;
+
+// macro state (set of states) of a tree automaton, used in tree automata algorithms
+typedef struct {
+    std::vector<std::size_t> states;    // states in increasing order
+    std::vector<bool> member;           // member[q] -> state q is in the macro state
+} TA_macro;
+
+// structure used in Inclusion algorithm of tree automata
+typedef struct {
+    std::size_t state;                  // state of the first automaton
+    TA_macro macro;                     // macro state of the second automaton
+} TA_product;
+
+thread_local Stats bakalarka::stats;
+using bakalarka::stats;
+
+#ifdef NO_STATS
+    #define STATS_INC(counter)
+    #define STATS_ADD(counter, n)
+#else
+    #define STATS_INC(counter) (++stats.counter)
+    #define STATS_ADD(counter, n) (stats.counter += (n))
+#endif
+
+thread_local Memory_stats bakalarka::memory;
+using bakalarka::memory;
+
+// remembers the largest footprint of the structure, bytes are not evaluated outside the instrumentation mode
+#define MEMORY_FOOTPRINT(structure, bytes) do { if(memory.enabled) memory.structure = std::max<std::uint64_t>(memory.structure, (bytes)); } while(0)
+
+// rule for computing hash of a tuple of states in unordered_map (k-ary intersection)
+struct state_tuple_hash
+{
+    std::size_t operator () (std::vector<State *> const &v) const
+    {
+        std::size_t h = v.size();
+        for(auto i = v.begin(); i != v.end(); ++i)
+            h ^= std::hash<State *>()(*i) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+// automaton determinized on the fly, used in Equivalence algorithm - nodes of a DFA are its states (State::id), the implicit
+// sink and a dead state, nodes of an NFA are macro states created on demand
+typedef struct {
+    bool deterministic;
+    std::vector<State *> states;            // DFA: node -> state, nodes states.size() and states.size() + 1 are the sink and the dead state
+    std::vector<std::vector<State *>> macros;   // NFA: node -> states of the macro state (ordered), empty -> dead state
+    std::unordered_map<std::vector<State *>, std::size_t, state_tuple_hash> index;     // NFA: macro state -> node
+    std::vector<bool> own;                  // own[a] -> letter a of the common alphabet is a letter of the automaton
+    std::vector<std::size_t> element;       // node -> element of the union-find structure, SIZE_MAX -> not created yet
+    bool epsilon;                           // NFA: macro states are closed under epsilon transitions
+    Epsilon_closure closures;
+} Lazy_DFA;
+
+// pair of nodes merged by Equivalence algorithm, the word leading to it is given by the parents
+typedef struct {
+    std::size_t first;                  // node of the first automaton
+    std::size_t second;                 // node of the second automaton
+    std::size_t parent;                 // index of the pair it was reached from, SIZE_MAX -> start
+    std::size_t letter;                 // letter of the common alphabet it was reached by
+} Equivalence_pair;
+
+// --------------------------------------------------------------------------------
+//                              AUTOMATON PARSER
+// --------------------------------------------------------------------------------
+
+// Parses automaton from the input stream (stdin by default) and saves them into corresponding structures. Saves automatons into Automatons. Expects correct format.
+// input: Automatons - reference to vector<FA>
+// input: input - reference to input stream
+// returns: void
+void parse_FA(std::vector<FA> &Automatons, std::istream &input)
+{
+    std::vector<std::string> alphabet;  // vector of alphabet
+    std::string word;                   // word received from stdin
+    int state = 0;                      // state of the parsing automaton
+    short int counter = 0;              // variable for transition parsing
+    bool start_state = false;           // variable for start state parsing
+    std::string transit_letter;         // variable for transition parsing
+    std::string source_state;           // variable for transition parsing
+    std::string target_state;           // variable for transition parsing
+    std::unordered_map<std::string, State *> by_name;  // states of the current automaton by name (the first state of the name)
+
+    // reads words from stdin and parses them
+    while(input >> word)
+    {
+        #ifdef PARSE_DEBUG
+            std::cout << word << std::endl;
+        #endif
+
+        // states of the automaton
+        if(word == "Ops" && state == 6) {alphabet.clear();state = 1;continue;}              // idle
+        else if(word == "Ops" && state == 0) {state = 1;continue;}                          // alphabet
+        else if(word == "Automaton" && (state == 1 || state == 6)) {state = 2;continue;}    // automaton name
+        else if(word == "States" && state == 2) {state = 3;continue;}                       // states
+        else if(word == "Final" && state == 3) {state = 4;continue;}
+        else if(word == "States" && state == 4) {state = 5;continue;}                       // final states
+        else if(word == "Transitions" && state == 5) {state = 6;continue;}                  // transitions
+
+        if(state == 1) // reads alphabet
+        {
+            if(word[word.find(":")+1] != '1') continue;    // automaton accepts only unary symbols (a:1)
+            alphabet.push_back(word.substr(0, word.find(":")));    // alphabet symbol is the first one
+        }
+        else if(state == 2) // reads name of the automaton and assigns the alphabet
+        {
+            FA automaton;
+            Automatons.push_back(automaton);
+            Automatons.back().name = word;
+            std::sort(alphabet.begin(), alphabet.end());
+            Automatons.back().alphabet = alphabet;
+            by_name.clear();
+        }
+        else if(state == 3) // reads a list of states
+        {
+            State st;
+            st.name = word;
+            st.visited = false;
+            st.start_st = false;
+            st.final_st = false;
+            st.flag = 0;
+            st.id = Automatons.back().states.size();
+            Automatons.back().states.push_back(st);
+            by_name.insert({word, &Automatons.back().states.back()});
+        }
+        else if(state == 5) // reads a list of final states
+        {
+            // finds state by its name and pushes pointer to the state
+            auto i = by_name.find(word);
+            if(i != by_name.end())
+            {
+                i->second->final_st = true;
+                Automatons.back().final_states.insert(i->second);
+            }
+        }
+        else if(state == 6) // parses transitions
+        {
+            if(counter == 0)                                        // left side of a(p)->q
+            {
+                if(word.find("(") == std::string::npos)             // start state
+                {
+                    start_state = true;
+                }
+                else                                                // normal transition
+                {
+                    std::size_t bracket_start = word.find("(");
+                    std::size_t bracket_end = word.find(")");
+                    transit_letter = word.substr(0, bracket_start);// word = "a01(p)"
+                    source_state = word.substr(bracket_start+1, bracket_end-bracket_start-1);
+                    #ifdef PARSE_DEBUG
+                        std::cout << "TRANSIT: " << transit_letter << " SOURCE STATE: " + source_state << std::endl;
+                    #endif
+                }
+                counter++;
+            }
+            else if(counter == 1)                                   // arrow in a(p)->q
+            {
+                counter++;
+                continue;
+            }
+            else                                                    // right side of a(p)->q
+            {
+                target_state = word;
+                #ifdef PARSE_DEBUG
+                    std::cout << "TARGET: " + target_state << std::endl;
+                #endif
+
+                if(!start_state && transit_letter == Epsilon_letter && std::find(alphabet.begin(), alphabet.end(), Epsilon_letter) == alphabet.end())
+                {
+                    auto i = by_name.find(source_state);                       // epsilon transition eps(p) -> q
+                    auto j = by_name.find(target_state);
+                    if(i != by_name.end() && j != by_name.end()) i->second->epsilon_p.push_back(j->second);
+                }
+                else if(!start_state)    // is not a start state
+                {
+                    Automatons.back().transitions.insert({{source_state,transit_letter},target_state}); // fill the transition multimap
+
+                    auto i = by_name.find(source_state);                       // fill the optimalised transition tree
+                    auto j = by_name.find(target_state);
+                    if(i != by_name.end() && j != by_name.end()) i->second->transit_states_p.insert({transit_letter, j->second});
+                }
+                else                // is a start state
+                {
+                    auto i = by_name.find(target_state);                       // fill the start_states vector
+                    if(i != by_name.end())
+                    {
+                        i->second->start_st = true;
+                        Automatons.back().start_states.push_back(i->second);
+                    }
+                    start_state = false;
+                }
+                counter = 0;
+            }
+        }
+    }
+
+    if(state != 6) {throw Parse_error("Parsing error!");}    // parsing must end with transitions
+}
+
+// --------------------------------------------------------------------------------
+//                         OUTPUT AND PRINT FUNCTIONS
+// --------------------------------------------------------------------------------
+
+// Function prints all automatons to stdout. It is meant for debug purposes - prints more information.
+// input: automatons - reference to vector<FA>
+// returns: void
+void print_FA(const std::vector<FA> &automatons)
+{
+    for(auto i = automatons.begin();i != automatons.end();++i)
+    {
+        std::cout << "Printing automaton " + i->name << std::endl;
+
+        std::cout << "Q = {" << std::endl;
+        for(auto j = i->states.begin(); j != i->states.end(); ++j)
+        {
+            if(j->flag == -1) continue; // deleted state
+            std::cout << std::boolalpha << "\t" << j->name << " (final: " << j->final_st << ", start: " << j->start_st << ", visited: " << j->visited << ", flag: " << j->flag << "):" << std::endl;
+            for(auto const& x : j->transit_states_p)
+                std::cout << "\t\tNext state: (" << x.first << ", " << x.second->name << ")" << std::endl;
+        }
+        std::cout << "}" << std::endl;
+
+        std::cout << "A = {";
+        for(auto j = i->alphabet.begin(); j != i->alphabet.end(); ++j)
+            std::cout << *j << ", ";
+        std::cout << "}" << std::endl;
+
+        std::cout << "r = {";
+        for(auto j = i->transitions.begin(); j != i->transitions.end(); ++j)
+            std::cout << j->first.first << "(" << j->first.second << ")" << "->" << j->second << ", ";
+        std::cout << "}" << std::endl;
+
+        std::cout << "s = {";
+        for(auto j = i->start_states.begin(); j != i->start_states.end(); ++j)
+            std::cout << (*j)->name << ", ";
+        std::cout << "}" << std::endl;
+
+        std::cout << "F = {";
+        for(auto j = i->final_states.begin(); j != i->final_states.end(); ++j)
+            std::cout << (*j)->name << ", ";
+        std::cout << "}" << std::endl;
+
+        std::cout << std::boolalpha << "negated: " << i->negated << ", sink: " << i->sink << std::endl;
+
+        std::cout << std::endl << std::endl;
+    }
+}
+
+Output_buffer::Output_buffer(int fd1) : fd(fd1) { buffer.reserve(capacity); }
+Output_buffer::Output_buffer(std::ostream &out1) : out(&out1) { buffer.reserve(capacity); }
+Output_buffer::Output_buffer() { buffer.reserve(capacity); }
+
+// Function appends the number in decimal, without the locale and the state of a stream (digits are formatted backwards).
+// input: n - number
+// returns: reference to the buffer
+Output_buffer &Output_buffer::operator<<(std::uint64_t n)
+{
+    char digits[20];
+    int length = 0;
+    do { digits[length++] = '0' + n % 10; n /= 10; } while(n != 0);
+    while(length > 0) buffer.push_back(digits[--length]);
+    return *this;
+}
+
+// Function writes the buffer to the target (partial writes of write(2) are repeated) or adds it to the hash.
+// returns: void
+void Output_buffer::flush()
+{
+    if(fd >= 0)
+    {
+        const char *data = buffer.data();
+        std::size_t left = buffer.size();
+        while(left > 0)
+        {
+            ssize_t written = write(fd, data, left);
+            if(written < 0 && errno == EINTR) continue;
+            if(written <= 0) break;     // output error, the rest is lost as with a failed std::cout
+            data += written;
+            left -= written;
+        }
+    }
+    else if(out != nullptr) out->write(buffer.data(), buffer.size());
+    else
+        for(auto c = buffer.begin(); c != buffer.end(); ++c)
+            hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+    buffer.clear();
+}
+
+// Function formats automaton in the form of Print_result_FA.
+// input: automaton - FA
+// input: out - reference to output buffer
+// input: alg_flag - bool - if true, does not print states with flag = -1
+// returns: void
+void Format_result_FA(const FA &automaton, Output_buffer &out, bool alg_flag)
+{
+    out << "Printing automaton " << automaton.name << '\n';
+
+    out << "Q = {";
+    for(auto j = automaton.states.begin(); j != automaton.states.end(); ++j)
+    {
+        if(j->flag == -1) continue; // deleted state
+        out << j->name << ", ";
+    }
+    if(automaton.sink) out << "fail, ";   // implicit sink state
+    out << "}\n";
+
+    out << "A = {";
+    for(auto j = automaton.alphabet.begin(); j != automaton.alphabet.end(); ++j)
+        out << *j << ", ";
+    out << "}\n";
+
+    out << "r = {";
+    for(auto j = automaton.states.begin(); j != automaton.states.end(); ++j)
+    {
+        if(j->flag == -1) continue; // deleted state
+        for(auto const& x : j->transit_states_p)
+            if(alg_flag)
+                { if(x.second->flag != -1) out << j->name << "(" << x.first << ")" << "->" << x.second->name << ", "; } // transition to deleted state
+            else out << j->name << "(" << x.first << ")" << "->" << x.second->name << ", "; // transition to deleted state
+        for(auto target = j->epsilon_p.begin(); target != j->epsilon_p.end(); ++target)
+            if(!alg_flag || (*target)->flag != -1) out << j->name << "(" << Epsilon_letter << ")" << "->" << (*target)->name << ", ";
+
+        if(automaton.sink)  // missing transitions lead to the implicit sink state
+            for(auto a = automaton.alphabet.begin(); a != automaton.alphabet.end(); ++a)
+                if(j->transit_states_p.find(*a) == j->transit_states_p.end())
+                    out << j->name << "(" << *a << ")" << "->fail, ";
+    }
+    if(automaton.sink)
+        for(auto a = automaton.alphabet.begin(); a != automaton.alphabet.end(); ++a)
+            out << "fail(" << *a << ")" << "->fail, ";
+    out << "}\n";
+
+    out << "s = {";
+    for(auto j = automaton.start_states.begin(); j != automaton.start_states.end(); ++j)
+        if((*j)->flag != -1) out << (*j)->name << ", ";
+    out << "}\n";
+
+    out << "F = {";
+    if(automaton.negated)   // final states are all states that are not in final_states
+    {
+        for(auto j = automaton.states.begin(); j != automaton.states.end(); ++j)
+            if(j->flag != -1 && Is_final(automaton, &(*j))) out << j->name << ", ";
+    }
+    else
+    {
+        for(auto j = automaton.final_states.begin(); j != automaton.final_states.end(); ++j)
+            if((*j)->flag != -1) out << (*j)->name << ", ";
+    }
+    if(Is_sink_final(automaton)) out << "fail, ";
+    out << "}\n";
+
+    out << "\n\n";
+}
+
+// Function prints automaton to stdout. Main printing function meant for printing results. Output is written
+// by write(2) in large blocks, text printed through std::cout before is flushed first.
+// input: automaton - FA
+// input: alg_flag - bool - if true, does not print states with flag = -1
+// returns: void
+void Print_result_FA(const FA &automaton, bool alg_flag)
+{
+    std::cout.flush();
+    Output_buffer out(STDOUT_FILENO);
+    Format_result_FA(automaton, out, alg_flag);
+}
+
+// Function formats only a summary of automaton - numbers of states and transitions (see Count_states and
+// Count_transitions) and FNV-1a hash of the text Print_result_FA would print, results can be compared by the hash.
+// input: automaton - FA
+// input: out - reference to output buffer
+// returns: void
+void Format_summary_FA(const FA &automaton, Output_buffer &out)
+{
+    Output_buffer hash;
+    Format_result_FA(automaton, hash, false);
+    std::uint64_t digest = hash.digest();
+    char hex[17];
+    for(int i = 15; i >= 0; --i, digest >>= 4)
+        hex[i] = "0123456789abcdef"[digest & 15];
+    hex[16] = '\0';
+    out << "Summary of automaton " << automaton.name << "\n" << "states: " << (std::uint64_t)Count_states(automaton)
+        << " transitions: " << (std::uint64_t)Count_transitions(automaton) << " hash: " << hex << "\n\n\n";
+}
+
+// Function prints only a summary of automaton to stdout, see Format_summary_FA.
+// input: automaton - FA
+// returns: void
+void Print_summary_FA(const FA &automaton)
+{
+    std::cout.flush();
+    Output_buffer out(STDOUT_FILENO);
+    Format_summary_FA(automaton, out);
+}
+
+// Function writes automaton in Timbuk format (the input format of the program), so it can be read again.
+// Implicit sink state is written as an explicit state "fail".
+// input: automaton - FA
+// input: out - reference to output buffer
+// returns: void
+void Print_timbuk(const FA &automaton, Output_buffer &out)
+{
+    out << "Ops";
+    for(auto a = automaton.alphabet.begin(); a != automaton.alphabet.end(); ++a)
+        out << " " << *a << ":1";
+    out << " l:0" << "\n\n" << "Automaton " << automaton.name << "\n" << "States";
+    for(auto j = automaton.states.begin(); j != automaton.states.end(); ++j)
+        if(j->flag != -1) out << " " << j->name;
+    if(automaton.sink) out << " fail";
+    out << "\n" << "Final States";
+    for(auto j = automaton.states.begin(); j != automaton.states.end(); ++j)
+        if(j->flag != -1 && Is_final(automaton, &(*j))) out << " " << j->name;
+    if(Is_sink_final(automaton)) out << " fail";
+    out << "\n" << "Transitions" << "\n";
+
+    for(auto j = automaton.start_states.begin(); j != automaton.start_states.end(); ++j)
+        if((*j)->flag != -1) out << "l -> " << (*j)->name << "\n";
+    for(auto j = automaton.states.begin(); j != automaton.states.end(); ++j)
+    {
+        if(j->flag == -1) continue; // deleted state
+        for(auto const& x : j->transit_states_p)
+            if(x.second->flag != -1) out << x.first << "(" << j->name << ") -> " << x.second->name << "\n";
+        for(auto target = j->epsilon_p.begin(); target != j->epsilon_p.end(); ++target)
+            if((*target)->flag != -1) out << Epsilon_letter << "(" << j->name << ") -> " << (*target)->name << "\n";
+
+        if(automaton.sink)  // missing transitions lead to the implicit sink state
+            for(auto a = automaton.alphabet.begin(); a != automaton.alphabet.end(); ++a)
+                if(j->transit_states_p.find(*a) == j->transit_states_p.end())
+                    out << *a << "(" << j->name << ") -> fail" << "\n";
+    }
+    if(automaton.sink)
+        for(auto a = automaton.alphabet.begin(); a != automaton.alphabet.end(); ++a)
+            out << *a << "(fail) -> fail" << "\n";
+    out << "\n";
+}
+
+// Function writes automaton in Timbuk format to the output stream, see Print_timbuk above.
+// input: automaton - FA
+// input: out - reference to output stream
+// returns: void
+void Print_timbuk(const FA &automaton, std::ostream &out)
+{
+    Output_buffer buffer(out);
+    Print_timbuk(automaton, buffer);
+}
+
+// Function prints state queue to stdout. It is meant for debug purposes.
+// input: q - queue<State *>
+// returns: void
+void Print_state_queue(std::queue<State *> q)
+{
+    std::cout << "Printing queue: {";
+    while(!q.empty())
+    {
+        std::cout << q.front()->name << ", ";
+        q.pop();
+    }
+    std::cout << "}" << std::endl;
+}
+
+// Function prints state stack to stdout. It is meant for debug purposes.
+// input: q - stack<State *>
+// returns: void
+void Print_state_stack(std::stack<State *> q)
+{
+    std::cout << "Printing queue: {";
+    while(!q.empty())
+    {
+        std::cout << q.top()->name << ", ";
+        q.pop();
+    }
+    std::cout << "}" << std::endl;
+}
+
+// Function prints language partition to stdout (minimalization). It is meant for debug purposes.
+// input: Partition_lan - reference to list<vector<State *>>
+// returns: void
+void Partition_print(std::list<std::vector<State *>> &Partition_lan)
+{
+    std::cout << "Partition print:\n";
+    for(auto x  = Partition_lan.begin(); x != Partition_lan.end(); ++x)
+    {
+        std::cout << "\t{";
+        for(auto y = x->begin(); y != x->end(); ++y)
+        {
+            std::cout << (*y)->name << ", ";
+        }
+        std::cout << "}" << std::endl;
+    }
+}
+
+// Function prints minimalization queue to stdout. It is meant for debug purposes.
+// input: W - reference to list<pair<string, vector<State *> *>>
+// returns: void
+void Minim_queue_print(std::list<std::pair<std::string, std::vector<State *> *>> &W)
+{
+    std::cout << "Queue print:\n\t{";
+    for(auto i = W.begin(); i != W.end(); ++i)
+    {
+        std::cout << "(" << i->first << ",[";
+        for(auto j = i->second->begin(); j != i->second->end(); ++j)
+        {
+            std::cout << (*j)->name << ", ";
+        }
+        std::cout << "]), ";
+    }
+    std::cout << "}" << std::endl;
+}
+
+// Function prints list or vector of states to stdout. It is meant for debug purposes.
+// input: data_struct - reference to T
+// returns: void
+template <class T>
+void Print_iter(T &data_struct)
+{
+    std::cout << "{";
+    for(auto i = data_struct.begin(); i != data_struct.end(); ++i)
+        std::cout << (*i)->name << ", ";
+    std::cout << "}";
+}
+
+// Function prints macro state to stdout. It is meant for debug purposes.
+// input: m - reference to Macro_state
+// returns: void
+void Print_MacroState(Macro_state &m)
+{
+    std::cout << "[";
+    for(auto i = m.states.begin(); i != m.states.end(); ++i)
+    {
+        std::cout << (*i)->name << ", ";
+    }
+    std::cout << "] " << m.rejecting << std::endl;
+}
+
+// --------------------------------------------------------------------------------
+//                              MEMORY FOOTPRINTS
+// --------------------------------------------------------------------------------
+
+// Functions estimate heap memory owned by a value (libstdc++ layout: short strings are stored inline).
+inline std::size_t Footprint_heap(const std::string &s) { return s.capacity() > 15 ? s.capacity() + 1 : 0; }
+template <class T>
+inline std::size_t Footprint_heap(const T &) { return 0; }
+template <class A, class B>
+inline std::size_t Footprint_heap(const std::pair<A,B> &p) { return Footprint_heap(p.first) + Footprint_heap(p.second); }
+
+// Function estimates memory of an ordered tree container (map, multimap, set) - node header, value and heap of the value.
+// input: c - container
+// returns: bytes
+template <class Tree>
+std::size_t Footprint_tree(const Tree &c)
+{
+    std::size_t bytes = 0;
+    for(auto i = c.begin(); i != c.end(); ++i)
+        bytes += 4 * sizeof(void *) + sizeof(*i) + Footprint_heap(*i);
+    return bytes;
+}
+
+// Function estimates memory of a hash container (unordered_map, unordered_set) - buckets, nodes with cached hash and heap of the values.
+// input: c - container
+// returns: bytes
+template <class Hash>
+std::size_t Footprint_hash(const Hash &c)
+{
+    std::size_t bytes = c.bucket_count() * sizeof(void *);
+    for(auto i = c.begin(); i != c.end(); ++i)
+        bytes += 2 * sizeof(void *) + sizeof(*i) + Footprint_heap(*i);
+    return bytes;
+}
+
+// Function estimates memory of the states of the automaton (list nodes, names, transition maps, S and F).
+// input: automaton - reference to FA
+// returns: bytes
+std::size_t Footprint_FA(const FA &automaton)
+{
+    std::size_t bytes = automaton.start_states.capacity() * sizeof(State *) + Footprint_tree(automaton.final_states);
+    for(auto i = automaton.states.begin(); i != automaton.states.end(); ++i)
+        bytes += 2 * sizeof(void *) + sizeof(State) + Footprint_heap(i->name) + Footprint_tree(i->transit_states_p);
+    return bytes;
+}
+
+// Function estimates memory of an antichain of macro states (Universality) or product states (Inclusion).
+// input: antichain - vector of macro states or product states
+// returns: bytes
+inline std::size_t Footprint_states(const Macro_state &m) { return m.states.capacity() * sizeof(State *); }
+inline std::size_t Footprint_states(const Product_state &p) { return p.macro_st.states.capacity() * sizeof(State *); }
+template <class Macro>
+std::size_t Footprint_antichain(const std::vector<Macro> &antichain)
+{
+    std::size_t bytes = antichain.capacity() * sizeof(Macro);
+    for(auto i = antichain.begin(); i != antichain.end(); ++i)
+        bytes += Footprint_states(*i);
+    return bytes;
+}
+
+// -------------------------------------------------------------------------------------------------
+//                                       AUTOMATON ALGORITHMS
+// -------------------------------------------------------------------------------------------------
+
+// ---------------------------------------- IMPLICIT SINK AND NEGATION -----------------------------------------
+
+// Function creates explicit fail state from the implicit sink and applies negated acceptance to the final states.
+// It is used by algorithms that work only with explicit automatons. Does nothing for an explicit automaton.
+// input: automaton - reference to FA
+// returns: void
+void Materialize_FA(FA &automaton)
+{
+    if(automaton.sink)
+    {
+        State st;
+        State *fail;
+        std::unordered_set<std::string> names;
+        for(auto i = automaton.states.begin(); i != automaton.states.end(); ++i)
+            names.insert(i->name);
+        st.name = "fail";
+        while(names.find(st.name) != names.end()) st.name = st.name + "_";
+        st.id = automaton.states.size();
+        automaton.states.push_back(st);
+        fail = &automaton.states.back();
+
+        // every missing transition leads to the fail state, the fail state has a self-loop for every letter
+        for(auto i = automaton.states.begin(); i != automaton.states.end(); ++i)
+        {
+            for(auto a = automaton.alphabet.begin(); a != automaton.alphabet.end(); ++a)
+            {
+                if(i->transit_states_p.find(*a) == i->transit_states_p.end())
+                    i->transit_states_p.insert({*a,fail});
+            }
+        }
+        automaton.sink = false;
+    }
+    if(automaton.negated)
+    {
+        automaton.final_states.clear();
+        for(auto i = automaton.states.begin(); i != automaton.states.end(); ++i)
+        {
+            i->final_st = !i->final_st;
+            if(i->final_st) automaton.final_states.insert(&(*i));
+        }
+        automaton.negated = false;
+    }
+}
+
+// Function numbers the states by their position in the list of states (State::id). It is called after states are removed,
+// functions that add a state set its id to the size of the list before the state is appended.
+// input: automaton - reference to FA
+// returns: void
+void Number_states(FA &automaton)
+{
+    std::size_t id = 0;
+    for(auto st = automaton.states.begin(); st != automaton.states.end(); ++st)
+        st->id = id++;
+}
+
+// Function returns the automaton if it is explicit and without epsilon transitions, otherwise its copy made explicit
+// (Materialize_FA) and without epsilon transitions (Remove_epsilon_FA). Algorithms that build a new automaton read their
+// input through it, so the input is copied only if its representation has to change.
+// input: automaton1 - reference to source automaton
+// input: copy - reference to storage of the copy
+// returns: reference to automaton1 or to copy
+const FA &Explicit_FA(const FA &automaton1, FA &copy)
+{
+    if(!automaton1.sink && !automaton1.negated && !Has_epsilon(automaton1)) return automaton1;
+    copy = automaton1;
+    Materialize_FA(copy);
+    Remove_epsilon_FA(copy);
+    return copy;
+}
+
+// ---------------------------------------- TRANSITION VIEWS -----------------------------------------
+
+// Constructor of the view, states are indexed by State::id. Predecessors are not built yet.
+// input: automaton1 - reference to an explicit automaton
+// input: reversed - true -> the view reads the reverse of the automaton
+FA_view::FA_view(const FA &automaton1, bool reversed) : automaton(&automaton1), reversed(reversed), count(automaton1.states.size()),
+                                                        predecessors(std::make_shared<std::vector<std::multimap<std::string, State *>>>())
+{
+}
+
+// Function returns the view of the same automaton in the opposite direction. The predecessors are shared.
+// returns: reversed view
+FA_view FA_view::reverse() const
+{
+    FA_view opposite(*this);
+    opposite.reversed = !reversed;
+    return opposite;
+}
+
+// Function returns predecessors of a state by letters. All predecessors are built on the first call - one pass
+// through the transitions, states are reached as State * through the transitions of the automaton anyway.
+// input: state - pointer to a state of the automaton
+// returns: multimap (letter, predecessor)
+const std::multimap<std::string, State *> &FA_view::Predecessors(const State *state) const
+{
+    if(predecessors->size() != count)
+    {
+        predecessors->assign(count, std::multimap<std::string, State *>());
+        for(auto st = automaton->states.begin(); st != automaton->states.end(); ++st)
+        {
+            for(auto const& x : st->transit_states_p)
+                (*predecessors)[x.second->id].insert({x.first, const_cast<State *>(&(*st))});
+        }
+    }
+    return (*predecessors)[state->id];
+}
+
+// ---------------------------------------- EPSILON TRANSITIONS -----------------------------------------
+
+// Function returns true if automaton has an epsilon transition.
+// input: automaton - reference to FA
+// returns: true - some state has an epsilon transition
+bool Has_epsilon(const FA &automaton)
+{
+    for(auto st = automaton.states.begin(); st != automaton.states.end(); ++st)
+        if(st->flag != -1 && !st->epsilon_p.empty()) return true;
+    return false;
+}
+
+// Function computes epsilon closures of all states. Strongly connected components of epsilon transitions are found by
+// Tarjan's algorithm, which finishes every component after all components reachable from it, so the closure of
+// a component is the union of its states and of the closures of its successor components - one pass over the transitions.
+// input: automaton - reference to FA
+// input: closures - reference to closures (output)
+// returns: void
+void Epsilon_closures(const FA &automaton, Epsilon_closure &closures)
+{
+    closures = Epsilon_closure();
+    for(auto st = automaton.states.begin(); st != automaton.states.end(); ++st)
+        closures.states.push_back(const_cast<State *>(&(*st)));
+    std::size_t n = closures.states.size(), words = (n + 63) / 64, visited = 0;
+    std::vector<std::size_t> order(n, SIZE_MAX), low(n), stack;
+    std::vector<bool> on_stack(n, false);
+    std::vector<std::pair<std::size_t, std::size_t>> frames;   // DFS stack - state and its next epsilon transition
+    closures.component.assign(n, SIZE_MAX);
+
+    for(std::size_t root = 0; root < n; ++root)
+    {
+        if(order[root] != SIZE_MAX || closures.states[root]->flag == -1) continue;     // deleted states have no closure
+        frames.push_back({root, 0});
+        order[root] = low[root] = visited++;
+        stack.push_back(root);
+        on_stack[root] = true;
+        while(!frames.empty())
+        {
+            std::size_t v = frames.back().first;
+            const std::vector<State *> &epsilon = closures.states[v]->epsilon_p;
+            if(frames.back().second < epsilon.size())
+            {
+                State *target = epsilon[frames.back().second++];
+                if(target->flag == -1) continue;
+                std::size_t w = target->id;
+                if(order[w] == SIZE_MAX)
+                {
+                    order[w] = low[w] = visited++;
+                    stack.push_back(w);
+                    on_stack[w] = true;
+                    frames.push_back({w, 0});
+                }
+                else if(on_stack[w]) low[v] = std::min(low[v], order[w]);
+                continue;
+            }
+            frames.pop_back();
+            if(!frames.empty()) low[frames.back().first] = std::min(low[frames.back().first], low[v]);
+            if(low[v] != order[v]) continue;
+
+            // v is the root of a component, its states are on the stack above it
+            std::size_t component = closures.row.size(), first = stack.size();
+            do
+            {
+                --first;
+                on_stack[stack[first]] = false;
+                closures.component[stack[first]] = component;
+            } while(stack[first] != v);
+            bool trivial = (stack.size() - first == 1);
+            for(std::size_t i = first; trivial && i < stack.size(); ++i)
+                for(auto target = closures.states[stack[i]]->epsilon_p.begin(); target != closures.states[stack[i]]->epsilon_p.end(); ++target)
+                    if((*target)->flag != -1 && (*target)->id != stack[i]) trivial = false;
+            if(trivial)
+            {
+                closures.row.push_back(SIZE_MAX);
+                stack.resize(first);
+                continue;
+            }
+            std::vector<std::uint64_t> closure(words, 0);
+            for(std::size_t i = first; i < stack.size(); ++i)
+            {
+                closure[stack[i] / 64] |= 1ULL << (stack[i] % 64);
+                for(auto target = closures.states[stack[i]]->epsilon_p.begin(); target != closures.states[stack[i]]->epsilon_p.end(); ++target)
+                {
+                    if((*target)->flag == -1) continue;
+                    std::size_t successor = closures.component[(*target)->id];
+                    if(successor == component) continue;
+                    if(closures.row[successor] == SIZE_MAX) closure[(*target)->id / 64] |= 1ULL << ((*target)->id % 64);
+                    else
+                        for(std::size_t k = 0; k < words; ++k)
+                            closure[k] |= closures.rows[closures.row[successor]][k];
+                }
+            }
+            closures.row.push_back(closures.rows.size());
+            closures.rows.push_back(std::move(closure));
+            stack.resize(first);
+        }
+    }
+}
+
+// Function replaces the set of states by its epsilon closure.
+// input: closures - reference to closures of the automaton (Epsilon_closures)
+// input: states - reference to states without duplicates, replaced by the closure ordered by State::id (output)
+// returns: void
+void Close_epsilon(const Epsilon_closure &closures, std::vector<State *> &states)
+{
+    bool trivial = true;
+    for(auto st = states.begin(); st != states.end() && trivial; ++st)
+        trivial = (closures.row[closures.component[(*st)->id]] == SIZE_MAX);
+    if(trivial) return;     // no state has an epsilon transition
+
+    std::vector<std::uint64_t> set((closures.states.size() + 63) / 64, 0);
+    for(auto st = states.begin(); st != states.end(); ++st)
+    {
+        std::size_t row = closures.row[closures.component[(*st)->id]];
+        if(row == SIZE_MAX) set[(*st)->id / 64] |= 1ULL << ((*st)->id % 64);
+        else
+            for(std::size_t k = 0; k < set.size(); ++k)
+                set[k] |= closures.rows[row][k];
+    }
+    states.clear();
+    for(std::size_t k = 0; k < set.size(); ++k)
+        for(std::uint64_t bits = set[k]; bits != 0; bits &= bits - 1)
+            states.push_back(closures.states[k * 64 + __builtin_ctzll(bits)]);
+}
+
+// Function removes epsilon transitions - every state gets the transitions of the states of its closure and it is final
+// if its closure contains a final state. Languages of all states stay the same. It is used by algorithms that work only
+// with automatons without epsilon transitions. Does nothing for an automaton without them.
+// input: automaton - reference to FA
+// returns: void
+void Remove_epsilon_FA(FA &automaton)
+{
+    if(!Has_epsilon(automaton)) return;
+    Epsilon_closure closures;
+    Epsilon_closures(automaton, closures);
+
+    for(auto p = closures.states.begin(); p != closures.states.end(); ++p)
+    {
+        std::vector<State *> closure = {*p};
+        Close_epsilon(closures, closure);
+        if(closure.size() == 1) continue;
+        std::set<std::pair<std::string, State *>> existing((*p)->transit_states_p.begin(), (*p)->transit_states_p.end());
+        for(auto q = closure.begin(); q != closure.end(); ++q)
+        {
+            if(*q == *p) continue;
+            if((*q)->final_st && !(*p)->final_st)
+            {
+                (*p)->final_st = true;
+                automaton.final_states.insert(*p);
+            }
+            for(auto const& x : (*q)->transit_states_p)
+                if(x.second->flag != -1 && existing.insert(x).second)
+                    (*p)->transit_states_p.insert(x);
+        }
+    }
+    for(auto st = automaton.states.begin(); st != automaton.states.end(); ++st)
+        st->epsilon_p.clear();
+}
+
+// ---------------------------------------- ALPHABET CLASSES (MINTERMS) -----------------------------------------
+
+// Function compresses alphabets of automatons to classes of letters with identical transitions (minterms) - two letters
+// are in one class if they are in the same alphabets and every state of every automaton has the same successors under both.
+// Only the first letter of every class (its representative, in the order of the alphabets) and its transitions stay
+// in the automatons, the algorithms then run over the representatives. Results over the representatives are expanded
+// back by Expand_alphabet.
+// input: automatons - reference to vector of pointers to automatons, all of them are compressed by the same classes
+// input: classes - reference to classes of letters (output)
+// returns: number of classes
+long Compress_alphabet(std::vector<FA *> &automatons, Alphabet_classes &classes)
+{
+    std::unordered_map<std::string, std::vector<std::size_t>> signature;    // letter -> its transitions (pairs of ids) in every automaton
+    std::map<std::vector<std::size_t>, std::string> representative;         // signature -> representative of its class
+    std::unordered_set<std::string> removed;                                // letters that are not representatives
+    std::unordered_set<std::string> seen;
+
+    classes.alphabet.clear();
+    classes.members.clear();
+    for(auto autom = automatons.begin(); autom != automatons.end(); ++autom)
+    {
+        for(auto a = (*autom)->alphabet.begin(); a != (*autom)->alphabet.end(); ++a)
+            if(seen.insert(*a).second) classes.alphabet.push_back(*a);
+    }
+
+    for(std::size_t k = 0; k < automatons.size(); ++k)
+    {
+        std::unordered_map<std::string, std::vector<std::pair<std::size_t,std::size_t>>> letter_transitions;
+        std::unordered_set<std::string> in_alphabet(automatons[k]->alphabet.begin(), automatons[k]->alphabet.end());
+        for(auto st = automatons[k]->states.begin(); st != automatons[k]->states.end(); ++st)
+        {
+            for(auto t = st->transit_states_p.begin(); t != st->transit_states_p.end(); ++t)
+                letter_transitions[t->first].push_back({st->id, t->second->id});
+        }
+        // signature of the letter in automaton k: membership in the alphabet, number of transitions and sorted transitions
+        for(auto a = classes.alphabet.begin(); a != classes.alphabet.end(); ++a)
+        {
+            std::vector<std::size_t> &sig = signature[*a];
+            std::vector<std::pair<std::size_t,std::size_t>> &pairs = letter_transitions[*a];
+            std::sort(pairs.begin(), pairs.end());
+            sig.push_back(in_alphabet.count(*a));
+            sig.push_back(pairs.size());
+            for(auto p = pairs.begin(); p != pairs.end(); ++p)
+            {
+                sig.push_back(p->first);
+                sig.push_back(p->second);
+            }
+        }
+    }
+
+    for(auto a = classes.alphabet.begin(); a != classes.alphabet.end(); ++a)
+    {
+        auto found = representative.insert({std::move(signature[*a]), *a});
+        if(!found.second)
+        {
+            classes.members[found.first->second].push_back(*a);
+            removed.insert(*a);
+        }
+    }
+    if(removed.empty()) return (long)representative.size();
+
+    // only representatives and their transitions stay
+    for(auto autom = automatons.begin(); autom != automatons.end(); ++autom)
+    {
+        for(auto st = (*autom)->states.begin(); st != (*autom)->states.end(); ++st)
+        {
+            for(auto t = st->transit_states_p.begin(); t != st->transit_states_p.end();)
+            {
+                if(removed.count(t->first)) t = st->transit_states_p.erase(t);
+                else ++t;
+            }
+        }
+        auto &alphabet = (*autom)->alphabet;
+        alphabet.erase(std::remove_if(alphabet.begin(), alphabet.end(), [&](const std::string &a) { return removed.count(a) > 0; }), alphabet.end());
+    }
+    return (long)representative.size();
+}
+
+// Function compresses the alphabet of one automaton (see the vector version).
+// input: automaton - reference to FA
+// input: classes - reference to classes of letters (output)
+// returns: number of classes
+long Compress_alphabet(FA &automaton, Alphabet_classes &classes)
+{
+    std::vector<FA *> automatons = {&automaton};
+    return Compress_alphabet(automatons, classes);
+}
+
+// Function expands an automaton over representatives of letter classes (a result of an algorithm run on automatons
+// compressed by Compress_alphabet) back to the original alphabet - every transition under a representative is copied
+// for all letters of its class.
+// input: automaton - reference to FA over representatives
+// input: classes - reference to classes of letters (see Compress_alphabet)
+// returns: void
+void Expand_alphabet(FA &automaton, const Alphabet_classes &classes)
+{
+    std::vector<std::pair<std::string, State *>> added;
+    std::unordered_set<std::string> present(automaton.alphabet.begin(), automaton.alphabet.end());
+
+    if(classes.members.empty()) return;     // every letter is its own class
+
+    for(auto st = automaton.states.begin(); st != automaton.states.end(); ++st)
+    {
+        added.clear();
+        for(auto t = st->transit_states_p.begin(); t != st->transit_states_p.end(); ++t)
+        {
+            auto members = classes.members.find(t->first);
+            if(members == classes.members.end()) continue;
+            for(auto a = members->second.begin(); a != members->second.end(); ++a)
+                added.push_back({*a, t->second});
+        }
+        st->transit_states_p.insert(added.begin(), added.end());
+    }
+
+    // letters of the classes take the places they had in the original alphabet
+    for(auto members = classes.members.begin(); members != classes.members.end(); ++members)
+    {
+        if(present.count(members->first)) present.insert(members->second.begin(), members->second.end());
+    }
+    automaton.alphabet.clear();
+    for(auto a = classes.alphabet.begin(); a != classes.alphabet.end(); ++a)
+        if(present.count(*a)) automaton.alphabet.push_back(*a);
+}
+
+// Function collects the letters enabled in a macro state - letters with at least one transition from some of its states.
+// Subset constructions skip the other (dead) letters instead of searching them in every state of the macro state.
+// input: states - reference to states of the macro state
+// input: letter_index - reference to indexes of the letters in the alphabet
+// input: enabled - reference to indexes of the enabled letters in increasing order (output)
+// returns: void
+void Enabled_letters(const std::vector<State *> &states, const std::unordered_map<std::string, std::size_t> &letter_index, std::vector<std::size_t> &enabled)
+{
+    enabled.clear();
+    for(auto st = states.begin(); st != states.end(); ++st)
+    {
+        auto &transitions = (*st)->transit_states_p;
+        for(auto t = transitions.begin(); t != transitions.end(); t = transitions.upper_bound(t->first))
+        {
+            auto index = letter_index.find(t->first);
+            if(index != letter_index.end()) enabled.push_back(index->second);
+        }
+    }
+    std::sort(enabled.begin(), enabled.end());
+    enabled.erase(std::unique(enabled.begin(), enabled.end()), enabled.end());
+}
+
+// ---------------------------------------- EMPTINESS -----------------------------------------
+
+// Function checks if automaton is empty. It is basically a Depth-first search (DFS) in a tree of states.
+// input: automaton - reference to FA
+// returns: true - automaton language is empty, false - automaton language is not empty
+bool Emptiness_test(const FA &automaton)
+{
+    std::stack<State *>state_q;
+    State * st;
+    std::unordered_set<std::string> visited_htab;
+
+    // pushes all start states to the state stack (pointers)
+    for(auto i = automaton.start_states.begin(); i != automaton.start_states.end();++i)
+    {
+        visited_htab.insert((*i)->name);
+        state_q.push(*i);
+    }
+
+    // takes states from stack and looks if they are final
+    // if yes -> return false
+    // if no  -> push all forward states onto the stack and keep checking
+    while(!state_q.empty())
+    {
+        #ifdef EMPTINESS_DEBUG
+            Print_state_stack(state_q);
+        #endif
+
+        st = state_q.top();
+        state_q.pop();
+        STATS_INC(emptiness_visited);
+        if(Is_final(automaton, st)) return false;
+        if(Is_sink_final(automaton))    // implicit accepting sink is reachable through every missing transition
+            for(auto a = automaton.alphabet.begin(); a != automaton.alphabet.end(); ++a)
+                if(st->transit_states_p.find(*a) == st->transit_states_p.end()) return false;
+        for(auto const& transition : st->transit_states_p)
+        {
+            if(visited_htab.find(transition.second->name) == visited_htab.end()) // do not push an already visited state again
+            {
+                visited_htab.insert(transition.second->name);
+                state_q.push(transition.second);
+            }
+        }
+        for(auto target = st->epsilon_p.begin(); target != st->epsilon_p.end(); ++target)    // epsilon transitions
+            if(visited_htab.insert((*target)->name).second) state_q.push(*target);
+    }
+    return true;
+}
+// ---------------------------------------- USELESS STATES -----------------------------------------
+
+// Function returns iterator pointing to a state with a specific name.
+// input: start_states - reference to vector<State *>
+// input: name - string - name of the state
+// returns: iterator to a vector of states
+inline std::vector<State *>::iterator find_in_start_states(std::vector<State *> &start_states, std::string name)
+{
+    auto st = start_states.begin();
+    for(; st != start_states.end(); ++st)
+        if((*st)->name == name) break;
+    return st;
+}
+// Function builds the quotient of an automaton - only the representatives of the states are copied, every representative
+// gets the transitions, start and final flags of all states it represents, states without a representative are left out
+// together with the transitions leading to them. Transitions between states that represent only themselves keep their
+// order, the others are sorted and their duplicates are removed. The source automaton is only read.
+// input: automaton1 - reference to explicit source automaton without epsilon transitions
+// input: representative - State::id -> State::id of the representative (representative[r] == r), SIZE_MAX -> removed state
+// input: result_automaton - reference to result automaton, states keep their order and names
+// returns: void
+void Quotient_FA(const FA &automaton1, const std::vector<std::size_t> &representative, FA &result_automaton)
+{
+    std::vector<State *> copied(automaton1.states.size(), nullptr);
+    std::vector<std::size_t> members(automaton1.states.size(), 0);   // number of states of the representative
+    std::vector<std::vector<std::pair<std::string,State *>>> quotient(automaton1.states.size());    // transitions of merged states
+    State st;
+
+    result_automaton.name = automaton1.name;
+    result_automaton.alphabet = automaton1.alphabet;
+    result_automaton.transitions = automaton1.transitions;
+
+    // first pass - copies of the representatives
+    for(auto s = automaton1.states.begin(); s != automaton1.states.end(); ++s)
+    {
+        if(representative[s->id] != SIZE_MAX) ++members[representative[s->id]];
+        if(representative[s->id] != s->id) continue;
+        st.name = s->name;
+        st.id = result_automaton.states.size();
+        result_automaton.states.push_back(st);
+        copied[s->id] = &result_automaton.states.back();
+    }
+
+    // second pass - flags and transitions of all states go to their representatives
+    for(auto s = automaton1.states.begin(); s != automaton1.states.end(); ++s)
+    {
+        if(representative[s->id] == SIZE_MAX) continue;
+        State *kept = copied[representative[s->id]];
+        if(s->start_st) kept->start_st = true;
+        if(s->final_st) kept->final_st = true;
+        bool merged = (members[s->id] != 1);    // transitions of the state may get duplicates
+        for(auto const& x : s->transit_states_p)
+            if(representative[x.second->id] != SIZE_MAX && members[representative[x.second->id]] != 1) merged = true;
+        for(auto const& x : s->transit_states_p)
+        {
+            if(representative[x.second->id] == SIZE_MAX) continue;
+            if(merged) quotient[kept->id].push_back({x.first, copied[representative[x.second->id]]});
+            else kept->transit_states_p.emplace_hint(kept->transit_states_p.end(), x.first, copied[x.second->id]);
+        }
+    }
+    for(auto kept = result_automaton.states.begin(); kept != result_automaton.states.end(); ++kept)
+    {
+        std::sort(quotient[kept->id].begin(), quotient[kept->id].end());
+        quotient[kept->id].erase(std::unique(quotient[kept->id].begin(), quotient[kept->id].end()), quotient[kept->id].end());
+        for(auto const& x : quotient[kept->id])
+            kept->transit_states_p.emplace_hint(kept->transit_states_p.end(), x.first, x.second);
+        if(kept->start_st) result_automaton.start_states.push_back(&(*kept));
+        if(kept->final_st) result_automaton.final_states.insert(&(*kept));
+    }
+}
+
+// Function finds useful states - states reachable from a start state (breadth-first search from start states)
+// from which a final state is reachable (breadth-first search from final states on the reversed view).
+// input: automaton - reference to explicit automaton without epsilon transitions
+// input: useful - reference to result, State::id -> true if the state is useful
+// returns: void
+void Useful_states(const FA &automaton, std::vector<bool> &useful)
+{
+    std::queue<State *>state_q;
+    State * st;
+    std::vector<bool> visited(automaton.states.size(), false);      // reachable from start
+    std::vector<bool> ending(automaton.states.size(), false);       // final state is reachable
+
+    // -------------- finding non-reachable states ------------------
+
+    // pushes all start states to the state queue (pointers)
+    for(auto i = automaton.start_states.begin(); i != automaton.start_states.end();++i)
+    {
+        if(visited[(*i)->id]) continue;
+        visited[(*i)->id] = true;   // start states are reachable from start
+        state_q.push(*i);
+    }
+
+    // goes through all transitions from start and marks visited states
+    while(!state_q.empty())
+    {
+        #ifdef USELESS_DEBUG
+            std::cout << "start: ";
+            Print_state_queue(state_q);
+        #endif
+
+        st = state_q.front();
+        for(auto const& transition : st->transit_states_p)
+        {
+            if(!visited[transition.second->id]) // do not push an already visited state again
+            {
+                visited[transition.second->id] = true;
+                state_q.push(transition.second);
+            }
+        }
+        state_q.pop();
+    }
+
+    // -------------- finding non-ending states ------------------
+
+    FA_view reversed(automaton, true);      // predecessors are built once for the search from final states
+
+    // pushes all final states to the state queue (pointers)
+    for(auto i = automaton.final_states.begin(); i != automaton.final_states.end();++i)
+    {
+        ending[(*i)->id] = true;    // final states are reachable from end
+        state_q.push(*i);
+    }
+
+    // goes through all transitions from final states and marks visited states
+    while(!state_q.empty())
+    {
+        #ifdef USELESS_DEBUG
+            std::cout << "final: ";
+            Print_state_queue(state_q);
+        #endif
+
+        st = state_q.front();
+        for(auto const& transition : reversed.post(st))
+        {
+            if(!ending[transition.second->id]) // do not push an already visited state again
+            {
+                ending[transition.second->id] = true;
+                state_q.push(transition.second);
+            }
+        }
+        state_q.pop();
+    }
+
+    useful.assign(automaton.states.size(), false);
+    for(std::size_t i = 0; i < useful.size(); ++i)
+        useful[i] = visited[i] && ending[i];
+}
+
+// Function implements the Remove useless states algorithm. Copies only the useful states (Useful_states) of the source
+// automaton and the transitions between them, the source automaton is not changed.
+// input: automaton1 - reference to source automaton
+// input: result_automaton - reference to result automaton
+// returns: void
+void Remove_useless_states(const FA &automaton1, FA &result_automaton)
+{
+    FA copy;
+    const FA &automaton = Explicit_FA(automaton1, copy);     // algorithm works only with explicit automatons without epsilon transitions
+    std::vector<bool> useful;
+    std::vector<std::size_t> representative(automaton.states.size(), SIZE_MAX);
+
+    Useful_states(automaton, useful);
+    for(std::size_t i = 0; i < useful.size(); ++i)
+        if(useful[i]) representative[i] = i;
+    Quotient_FA(automaton, representative, result_automaton);
+    MEMORY_FOOTPRINT(result_states, Footprint_FA(result_automaton));
+}
+
+// Function implements the Remove useless states algorithm in place. Removes all non-ending and non-reachable states.
+// input: automaton - reference to automaton
+// returns: void
+void Remove_useless_states(FA &automaton)
+{
+    FA result_automaton;
+
+    Materialize_FA(automaton);      // made explicit in place, Remove_useless_states does not copy it again
+    Remove_epsilon_FA(automaton);
+    Remove_useless_states(automaton, result_automaton);
+    automaton = std::move(result_automaton);
+}
+
+// ---------------------------------------- INTERSECTION -----------------------------------------
+
+// Function implements the Intersection algorithm. Computes intersection of two automatons by making pairs of states.
+// input: automaton1 - reference to first automaton, used to compute intersection
+// input: automaton2 - reference to second automaton, used to compute intersection
+// input: result_automaton - reference to result automaton, used to store result automaton
+// returns: void
+void Intersection_FA(FA &automaton1, FA &automaton2, FA &result_automaton)
+{
+    std::queue<Inters_help> W;      // queue W from algorithm
+    Inters_help st_pair;            // structure pushed to the queue
+    State st;                       // the state structure
+    std::string a;                  // alphabet letter - main loop
+    std::unordered_map<std::string,State *> optim_Q;  // optimalization of finding state in Q - hash table of state names
+    std::pair<std::multimap<std::string,State *>::iterator, std::multimap<std::string,State *>::iterator> range1, range2; // iterator pairs for equal_range
+
+    Materialize_FA(automaton1);     // algorithm works only with explicit automatons
+    Materialize_FA(automaton2);
+    Remove_epsilon_FA(automaton1);  // and without epsilon transitions
+    Remove_epsilon_FA(automaton2);
+
+    #ifdef INTERSECTION_DEBUG
+        std::cout << "\nIntersection: printing input automatons..." << std::endl;
+        Print_result_FA(automaton1);
+        Print_result_FA(automaton2);
+    #endif // INTERSECTION_DEBUG
+
+    // checking if alphabets are the same - they are sorted
+    //if(automaton1.alphabet != automaton2.alphabet) {throw Operation_error("Intersection: alphabets are different!");}
+    if(automaton1.alphabet.size() < automaton2.alphabet.size())
+        result_automaton.alphabet = automaton1.alphabet;
+    else
+        result_automaton.alphabet = automaton2.alphabet;
+
+    // building a new automaton that will be returned
+    result_automaton.name = automaton1.name + "&" + automaton2.name;
+
+    // cartesian product of starting states - push them to Q, S, F and W
+    for(auto i = automaton1.start_states.begin(); i != automaton1.start_states.end(); ++i)
+    {
+        for(auto j = automaton2.start_states.begin(); j != automaton2.start_states.end(); ++j)
+        {
+            st.name = (*i)->name + (*j)->name;      // create a name for a new state
+            st.start_st = true;
+            st.id = result_automaton.states.size();
+            result_automaton.states.push_back(st);  // push the state to Q
+            optim_Q.insert({st.name,&result_automaton.states.back()});                    // push the state name and pointer to hash table
+            result_automaton.start_states.push_back(&(result_automaton.states.back()));     // push the state to S
+            if((*i)->final_st && (*j)->final_st)    // set the final state variable
+            {
+                result_automaton.final_states.insert(&(result_automaton.states.back()));    // mozna to neni potreba
+                result_automaton.states.back().final_st = true;
+            }
+            else
+                result_automaton.states.back().final_st = false;
+            W.push({*i,*j,&(result_automaton.states.back())});    // push the state to W
+        }
+    }
+
+    #ifdef INTERSECTION_DEBUG
+        Print_result_FA(result_automaton);
+    #endif // INTERSECTION_DEBUG
+
+    // main loop - until queue is empty
+    while(!W.empty())
+    {
+        st_pair = W.front();
+        STATS_INC(product_states);
+        #ifdef INTERSECTION_DEBUG
+            std::cout << "\nIntersection - st_pair: " << st_pair.first->name << ", " << st_pair.second->name << ", " << st_pair.source->name << std::endl;
+        #endif // INTERSECTION_DEBUG
+
+        // it looks only at the alphabet of the first state instead of running through the entire alphabet of the automaton
+        for(auto it = st_pair.first->transit_states_p.begin(); it != st_pair.first->transit_states_p.end(); it = range1.second)
+        {
+            a = it->first;
+            #ifdef INTERSECTION_DEBUG
+                std::cout << "\nIntersection - main loop: " << "letter: " << a << "\n";
+            #endif // INTERSECTION_DEBUG
+
+            // find all states accessible from the current pair
+            range1 = st_pair.first->transit_states_p.equal_range(a);
+            range2 = st_pair.second->transit_states_p.equal_range(a);
+
+            // cartesian product of accessible states
+            for(auto i = range1.first; i != range1.second; ++i)
+            {
+                #ifdef INTERSECTION_DEBUG
+                    std::cout << "\t" << i->first << ", " << i->second->name << "\n";
+                #endif // INTERSECTION_DEBUG
+                for(auto j = range2.first; j != range2.second; ++j)
+                {
+                    #ifdef INTERSECTION_DEBUG
+                        std::cout << "\t\t" << j->first << ", " << j->second->name << std::endl;
+                    #endif // INTERSECTION_DEBUG
+
+                    st.name = i->second->name + j->second->name;
+                    st.start_st = false;
+                    STATS_INC(product_transitions);
+
+                    // add state only if it is not already in Q (new automaton)
+                    //if(k == result_automaton.states.rend())
+                    auto seek = optim_Q.find(st.name);
+                    if(seek == optim_Q.end())
+                    {
+                        st.id = result_automaton.states.size();
+                        result_automaton.states.push_back(st);          // insert the new state
+                        optim_Q.insert({st.name,&result_automaton.states.back()});   // push the state name and pointer to hash table
+                        if(i->second->final_st && j->second->final_st)  // insert state into final state set
+                        {
+                            result_automaton.states.back().final_st = true;
+                            result_automaton.final_states.insert(&result_automaton.states.back());
+                        }
+                        else
+                            result_automaton.states.back().final_st = false;
+                        W.push({i->second,j->second,&result_automaton.states.back()});    // push the state to W
+
+                        // always push relations
+                        st_pair.source->transit_states_p.insert({a,&result_automaton.states.back()});
+                    }
+                    else
+                    {
+                        // always push relations
+                        st_pair.source->transit_states_p.insert({a,seek->second});
+                    }
+                }
+            }
+        }
+        W.pop();
+        #ifdef INTERSECTION_DEBUG
+            std::cout << "\nIntersection - endloop: \n";
+            Print_result_FA(result_automaton);
+        #endif // INTERSECTION_DEBUG
+    }
+    MEMORY_FOOTPRINT(result_states, Footprint_FA(result_automaton));
+}
+
+// Function implements the k-ary Intersection algorithm. Computes intersection of any number of automatons at once by making
+// tuples of states. Only tuples reachable in the whole product are created, there are no intermediate products.
+// input: automatons - reference to vector of pointers to automatons, used to compute intersection
+// input: result_automaton - reference to result automaton, used to store result automaton
+// input: emptiness_only - if true, the algorithm stops as soon as it finds a final tuple (result automaton stays incomplete)
+// returns: true - language of the product is empty, false - language of the product is not empty
+bool Intersection_k_FA(std::vector<FA *> &automatons, FA &result_automaton, bool emptiness_only)
+{
+    std::queue<Inters_k_help> W;    // queue W from algorithm
+    Inters_k_help st_tuple;         // structure pushed to the queue
+    State st;                       // the state structure
+    std::string a;                  // alphabet letter - main loop
+    std::vector<State *> target;    // tuple of target states
+    std::unordered_map<std::vector<State *>,State *,state_tuple_hash> optim_Q;  // optimalization of finding state in Q - hash table of tuples
+    std::vector<std::pair<std::multimap<std::string,State *>::iterator, std::multimap<std::string,State *>::iterator>> ranges; // equal_range for every automaton
+    std::vector<std::multimap<std::string,State *>::iterator> pos;  // current position in every range (odometer)
+    std::size_t k = automatons.size();
+    bool empty = true;
+
+    for(auto autom = automatons.begin(); autom != automatons.end(); ++autom)
+    {
+        Materialize_FA(**autom);    // algorithm works only with explicit automatons
+        Remove_epsilon_FA(**autom); // and without epsilon transitions
+    }
+    if(k == 0) {throw Operation_error("Intersection: no automatons!");}
+
+    // picking the smallest alphabet and building a name of the new automaton
+    result_automaton.alphabet = automatons[0]->alphabet;
+    result_automaton.name = automatons[0]->name;
+    for(std::size_t i = 1; i < k; ++i)
+    {
+        if(automatons[i]->alphabet.size() < result_automaton.alphabet.size())
+            result_automaton.alphabet = automatons[i]->alphabet;
+        result_automaton.name = result_automaton.name + "&" + automatons[i]->name;
+    }
+
+    // creates a new state from the tuple, pushes it to Q, F and W (and S if start is true)
+    auto push_tuple = [&](std::vector<State *> &tuple, bool start) -> State *
+    {
+        st.name = "";
+        st.final_st = true;
+        for(auto i = tuple.begin(); i != tuple.end(); ++i)
+        {
+            st.name = st.name + (*i)->name;
+            if(!(*i)->final_st) st.final_st = false;
+        }
+        st.start_st = start;
+        st.id = result_automaton.states.size();
+        result_automaton.states.push_back(st);
+        State *st_p = &result_automaton.states.back();
+        optim_Q.insert({tuple, st_p});
+        if(start) result_automaton.start_states.push_back(st_p);
+        if(st_p->final_st)
+        {
+            result_automaton.final_states.insert(st_p);
+            empty = false;
+        }
+        W.push({tuple, st_p});
+        return st_p;
+    };
+
+    // cartesian product of starting states of all automatons
+    target.resize(k);
+    std::vector<std::size_t> start_pos(k, 0);
+    for(std::size_t i = 0; i < k; ++i)
+        if(automatons[i]->start_states.empty()) return true;   // one of the automatons has no start state
+    while(true)
+    {
+        for(std::size_t i = 0; i < k; ++i)
+            target[i] = automatons[i]->start_states[start_pos[i]];
+        if(optim_Q.find(target) == optim_Q.end())
+            push_tuple(target, true);
+        if(!empty && emptiness_only) return false;
+
+        // move to the next tuple of start states
+        std::size_t i = 0;
+        for(; i < k; ++i)
+        {
+            if(++start_pos[i] < automatons[i]->start_states.size()) break;
+            start_pos[i] = 0;
+        }
+        if(i == k) break;
+    }
+
+    ranges.resize(k);
+    pos.resize(k);
+
+    // main loop - until queue is empty
+    while(!W.empty())
+    {
+        st_tuple = W.front();
+        W.pop();
+        STATS_INC(product_states);
+
+        // it looks only at the alphabet of the first state instead of running through the entire alphabet of the automaton
+        for(auto it = st_tuple.states[0]->transit_states_p.begin(); it != st_tuple.states[0]->transit_states_p.end(); it = ranges[0].second)
+        {
+            a = it->first;
+            #ifdef INTERSECTION_DEBUG
+                std::cout << "\nIntersection k - main loop: " << "letter: " << a << "\n";
+            #endif // INTERSECTION_DEBUG
+
+            // find all states accessible from the current tuple, skip the letter if some automaton cannot read it
+            bool readable = true;
+            for(std::size_t i = 0; i < k; ++i)
+            {
+                ranges[i] = st_tuple.states[i]->transit_states_p.equal_range(a);
+                pos[i] = ranges[i].first;
+                if(ranges[i].first == ranges[i].second) readable = false;
+            }
+            if(!readable) continue;
+
+            // cartesian product of accessible states
+            while(true)
+            {
+                for(std::size_t i = 0; i < k; ++i)
+                    target[i] = pos[i]->second;
+
+                // add state only if it is not already in Q (new automaton)
+                auto seek = optim_Q.find(target);
+                State *target_p = (seek == optim_Q.end()) ? push_tuple(target, false) : seek->second;
+                if(!empty && emptiness_only) return false;
+
+                // always push relations
+                STATS_INC(product_transitions);
+                st_tuple.source->transit_states_p.insert({a,target_p});
+
+                // move to the next tuple of target states
+                std::size_t i = 0;
+                for(; i < k; ++i)
+                {
+                    if(++pos[i] != ranges[i].second) break;
+                    pos[i] = ranges[i].first;
+                }
+                if(i == k) break;
+            }
+        }
+    }
+    MEMORY_FOOTPRINT(result_states, Footprint_FA(result_automaton));
+    return empty;
+}
+
+// ---------------------------------------- DETERMINIZATION -----------------------------------------
+
+// Function removes states of a macro state that are simulated by another state of the macro state, of mutually
+// simulating states only the one with the smallest name stays, so the result does not depend on the order of states
+// (the same macro state reached from different predecessors is pruned to the same states). Language of the macro state
+// does not change (simulation is transitive and respects final states), its successors are simulated by successors of the kept states.
+// input: states - reference to states of the macro state
+// input: preorder - reference to simulation preorder on states of the automaton (see Preorder)
+// returns: void
+void Prune_simulated(std::vector<State *> &states, const State_relation &preorder)
+{
+    std::vector<bool> pruned(states.size(), false);
+    for(std::size_t i = 0; i < states.size(); ++i)
+    {
+        for(std::size_t j = 0; j < states.size() && !pruned[i]; ++j)
+        {
+            if(i == j) continue;
+            if(states[i]->name == states[j]->name) pruned[i] = j < i;   // the same state twice
+            else if(preorder.find({states[i]->name,states[j]->name}) != preorder.end())
+                pruned[i] = preorder.find({states[j]->name,states[i]->name}) == preorder.end() || states[j]->name < states[i]->name;
+        }
+    }
+    std::size_t kept = 0;   // states[0..kept) are kept
+    for(std::size_t i = 0; i < states.size(); ++i)
+    {
+        if(pruned[i]) STATS_INC(det_pruned);
+        else states[kept++] = states[i];
+    }
+    states.resize(kept);
+}
+
+// Function implements the Determinization algorithm. Computes deterministic version of input automaton.
+// With the simulation preorder every macro state is reduced to its simulation-maximal states before it is searched in Q,
+// the result accepts the same language and it is often much smaller.
+// input: automaton1 - reference to source automaton, used to compute determinization
+// input: result_automaton - reference to result automaton, used to store result automaton
+// input: complete - if true, the result is complete - missing transitions lead to the implicit sink state (FA::sink)
+// input: preorder - pointer to simulation preorder of automaton1 (Preorder), nullptr -> full subsets
+// returns: void
+void Determinization_FA(FA &automaton1, FA &result_automaton, bool complete, const State_relation *preorder)
+{
+    std::queue<Determin_help> W;    // queue W from algorithm
+    Determin_help st_vect;          // structure pushed to the queue - contains vector of source states and a pointer to a new state created from source states
+    State st;                       // the state structure
+    std::vector<State *> storage;
+    std::pair<std::multimap<std::string,State *>::iterator, std::multimap<std::string,State *>::iterator> range1; // iterator pair for equal_range
+    std::vector<std::string> opt_name;              // optimizes dealing with S1S2S3, S2S1S3, S3S2S1, ... states - it is the same state
+    std::unordered_set<std::string> opt_storage;    // optimizes searching in storage - prevents states like S1S1S1S2S3 or S1S1S2S3S3
+    std::unordered_map<std::string,State *> opt_Q;  // optimizes searching in Q
+    std::unordered_map<std::string,std::size_t> letter_index;   // index of the letter in the alphabet
+    std::vector<std::size_t> enabled;               // letters with a transition from the macro state
+    Epsilon_closure closures;                       // macro states are closed under epsilon transitions
+    bool epsilon = Has_epsilon(automaton1);
+
+    #ifdef DETERMINIZATION_DEBUG
+        std::cout << "\nDeterminization: printing input automaton..." << std::endl;
+        Print_result_FA(automaton1);
+        print_FA({automaton1});
+    #endif
+
+    if(Is_sink_final(automaton1)) Materialize_FA(automaton1);    // accepting sink would be a part of macro states
+    if(epsilon) Epsilon_closures(automaton1, closures);
+
+    // building a new automaton that will be returned
+    result_automaton.name = "det" + automaton1.name;
+    result_automaton.alphabet = automaton1.alphabet;
+    result_automaton.sink = complete;   // the sink state is never materialized
+    for(std::size_t i = 0; i < result_automaton.alphabet.size(); ++i)
+        letter_index.insert({result_automaton.alphabet[i], i});
+
+    // create the new start state by merging all start states
+    st.name = "|";
+    st.start_st = true;
+    st.final_st = false;
+    storage = automaton1.start_states;
+    if(epsilon)     // finality of the closure, pruned states may be final only through their closures
+    {
+        Close_epsilon(closures, storage);
+        for(auto i = storage.begin(); i != storage.end() && !st.final_st; ++i)
+            st.final_st = Is_final(automaton1, *i);
+    }
+    if(preorder != nullptr) Prune_simulated(storage, *preorder);
+    // optimalization - find all state names and push them into a vector
+    for(auto i = storage.begin(); i != storage.end(); ++i)
+    {
+        opt_name.push_back((*i)->name);
+        if(Is_final(automaton1, *i)) st.final_st = true;  // if atleast one state is final, the new state is final too
+    }
+    std::sort(opt_name.begin(), opt_name.end());    // sort the vector of state names
+    for(auto i = opt_name.begin(); i != opt_name.end(); ++i)
+        st.name = st.name + *i + "|";         // create a name for the new state by merging names
+
+    st.id = result_automaton.states.size();
+    result_automaton.states.push_back(st);  // push the state to Q
+    STATS_INC(det_macro_states);
+    opt_Q.insert({st.name,&result_automaton.states.back()});
+    result_automaton.start_states.push_back(&result_automaton.states.back());    // push the state to S
+    if(st.final_st) result_automaton.final_states.insert(&result_automaton.states.back());   // mozna to neni potreba
+    W.push({storage,&result_automaton.states.back()});   // push the state to W
+    storage.clear();
+
+    #ifdef DETERMINIZATION_DEBUG
+        Print_result_FA(result_automaton);
+    #endif
+
+    // main loop - until queue is empty
+    while(!W.empty())
+    {
+        st_vect = W.front();
+        if(epsilon && preorder != nullptr) Close_epsilon(closures, st_vect.states);     // pruned states are reachable by epsilon
+        #ifdef DETERMINIZATION_DEBUG
+            std::cout << "\nDeterminization - st_vect: ";
+            for(auto i = st_vect.states.begin(); i != st_vect.states.end(); ++i)
+                std::cout << (*i)->name << ", ";
+            std::cout << "|| " << st_vect.source->name << std::endl;
+        #endif
+
+        // for every letter enabled in the macro state, no state can be reached by the other letters (complete DFA goes to the implicit sink)
+        Enabled_letters(st_vect.states, letter_index, enabled);
+        STATS_ADD(det_dead_letters, result_automaton.alphabet.size() - enabled.size());
+        for(auto index = enabled.begin(); index != enabled.end(); ++index)
+        {
+            auto a = result_automaton.alphabet.begin() + *index;
+            #ifdef DETERMINIZATION_DEBUG
+                std::cout << "\nDeterminization - main loop: letter: " << *a << "\n";
+            #endif
+
+            st.name = "|";           // create and initialize a new state
+            st.final_st = false;
+            opt_name.clear();
+            opt_storage.clear();
+            // goes through all source states
+            for(auto i = st_vect.states.begin(); i != st_vect.states.end(); ++i)
+            {
+                // for every state finds states reachable by the letter
+                range1 = (*i)->transit_states_p.equal_range(*a);
+                for(auto j = range1.first; j != range1.second; ++j)
+                {
+                    // insert the same state only once
+                    if(opt_storage.insert(j->second->name).second)
+                    {
+                        if(Is_final(automaton1, j->second)) st.final_st = true;     // if atleast one state is final, the new state is final too
+                        storage.push_back(j->second);           // push to W later
+                    }
+                }
+            }
+            if(epsilon)
+            {
+                Close_epsilon(closures, storage);
+                for(auto i = storage.begin(); i != storage.end() && !st.final_st; ++i)
+                    st.final_st = Is_final(automaton1, *i);
+            }
+            if(preorder != nullptr) Prune_simulated(storage, *preorder);    // finality is kept, simulation respects final states
+            for(auto i = storage.begin(); i != storage.end(); ++i)
+                opt_name.push_back((*i)->name);                 // push name of the state to optimalizing vector
+            std::sort(opt_name.begin(), opt_name.end());        // sort names
+            for(auto i = opt_name.begin(); i != opt_name.end(); ++i)
+                st.name = st.name + *i + "|";            // create a name for the new state by merging names
+
+            // if no state can be reached by chosen letter -> continue to the next letter (complete DFA goes to the implicit sink)
+            if(storage.empty()) continue;
+
+            // add state only if it is not already in Q (new automaton)
+            auto seek = opt_Q.find(st.name);
+            if(seek == opt_Q.end())
+            {
+                STATS_INC(det_macro_states);
+                st.start_st = false;
+                st.id = result_automaton.states.size();
+                result_automaton.states.push_back(st);  // push the state to Q
+                opt_Q.insert({st.name,&result_automaton.states.back()});
+                if(st.final_st) result_automaton.final_states.insert(&result_automaton.states.back());   // mozna to neni potreba
+                W.push({storage,&result_automaton.states.back()});   // push the state to W
+
+                // always push relations
+                st_vect.source->transit_states_p.insert({*a,&result_automaton.states.back()});
+            }
+            else
+            {
+                STATS_INC(det_duplicates);
+                // always push relations
+                st_vect.source->transit_states_p.insert({*a,seek->second});
+            }
+            storage.clear();
+        }
+        W.pop();
+        #ifdef DETERMINIZATION_DEBUG
+            std::cout << "\nDeterminization - endloop: \n";
+            Print_result_FA(result_automaton);
+        #endif
+    }
+    MEMORY_FOOTPRINT(det_opt_Q, Footprint_hash(opt_Q));
+    MEMORY_FOOTPRINT(result_states, Footprint_FA(result_automaton));
+}
+
+// ---------------------------------------- MINIMALIZATION -----------------------------------------
+
+// Function returns the state reachable from state by letter in a DFA. Missing transitions and transitions of the
+// implicit sink state (nullptr) lead to the implicit sink state (nullptr).
+// input: state - pointer to a state or nullptr (sink)
+// input: letter - reference to alphabet letter
+// returns: pointer to the next state or nullptr (sink)
+inline State * Hopcroft_target(State *state, const std::string &letter)
+{
+    if(state == nullptr) return nullptr;
+    auto iter = state->transit_states_p.find(letter);     // it is DFA so there can be only one transition using one letter
+    return iter == state->transit_states_p.end() ? nullptr : iter->second;
+}
+
+// Function implements the Hopcroft algorithm. Computes the language partition, which is a list of blocks of states.
+// If some transitions are missing (or the automaton has the implicit sink), the sink state is a part of the partition
+// as a nullptr element, so the algorithm always works with a complete DFA.
+// input: automaton1 - reference to source automaton, used to compute language partition
+// input: Partition_lan - result language partition
+// returns: void
+void Hopcroft(FA &automaton1, std::list<std::vector<State *>> &Partition_lan)
+{
+    std::vector<State *> block1, block2;                    // block of the partition
+    std::pair<std::string, std::vector<State *> *> splitter;         // (a,B) splitter
+    std::list<std::pair<std::string, std::vector<State *> *>> W;     // list of (a,B) splitters
+    std::vector<State *> *bl1, *bl2;                        // pointers to blocks in the partition
+    bool splits_in, splits_out;                             // if both are true -> splitter splits a block
+    std::vector<State *> missing_block;
+    bool partial = automaton1.sink;                         // true -> implicit sink state is needed
+    State * target;
+
+    // missing transitions lead to the implicit sink state
+    for(auto i = automaton1.states.begin(); i != automaton1.states.end() && !partial; ++i)
+        for(auto a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
+            if(i->transit_states_p.find(*a) == i->transit_states_p.end()) { partial = true; break; }
+
+    // first condition of the algorithm - initializing partition
+    Partition_lan.push_back({});        // F
+    Partition_lan.push_back({});        // Q-F
+    for(auto i = automaton1.states.begin(); i != automaton1.states.end(); ++i)
+    {
+        if(Is_final(automaton1, &(*i))) Partition_lan.front().push_back(&(*i));
+        else Partition_lan.back().push_back(&(*i));
+    }
+    if(partial)
+    {
+        if(Is_sink_final(automaton1)) Partition_lan.front().push_back(nullptr);
+        else Partition_lan.back().push_back(nullptr);
+    }
+    if(Partition_lan.front().empty() || Partition_lan.back().empty())
+    {
+        if(Partition_lan.front().empty()) Partition_lan.pop_front();
+        else Partition_lan.pop_back();
+        #ifdef MINIMALIZATION_DEBUG
+            std::cout << "Minimalization: F=={} or Q-F=={}" << std::endl;
+        #endif // MINIMALIZATION_DEBUG
+        return;
+    }
+    #ifdef MINIMALIZATION_DEBUG
+        std::cout << "Partition print - first condition:\n";
+        Partition_print(Partition_lan);
+    #endif // MINIMALIZATION_DEBUG
+
+    // fill W queue - (a,min{F,Q-F})
+    if(Partition_lan.front().size() < Partition_lan.back().size())
+    {
+        for(auto a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
+            W.push_back({*a,&Partition_lan.front()});
+    }
+    else
+    {
+        for(auto a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
+            W.push_back({*a,&Partition_lan.back()});
+    }
+
+    // main loop - while there are splitters
+    while(!W.empty())
+    {
+        STATS_INC(hopcroft_splitters);
+        splitter = W.front();           // splitter zmenen: misto pointeru na vektor nyni obsahuje hodnotovou kopii vektoru (mazani bloku pozdeji)
+        #ifdef MINIMALIZATION_DEBUG
+            std::cout << "Splitter print: (" << splitter.first << ", ";
+            Print_iter(*splitter.second);
+            std::cout << ")" << std::endl;
+        #endif // MINIMALIZATION_DEBUG
+
+        // go through all blocks in partition
+        for(auto i = Partition_lan.begin(); i != Partition_lan.end(); ++i)
+        {
+            splits_in = false;
+            splits_out = false;
+            block1.clear();
+            block2.clear();
+            // for every state of the block check where do its transitions lead
+            // i - block vector, j - state pointer
+            for(auto j = i->begin(); j != i->end(); ++j)
+            {
+                // check if found transit state is in splitter block
+                // creates blocks B0 and B1 that might split B
+                target = Hopcroft_target(*j, splitter.first);
+                if(std::find(splitter.second->begin(), splitter.second->end(), target) != splitter.second->end())
+                {
+                    splits_in = true;           // it is in splitter block
+                    block1.push_back(*j);
+                }
+                else
+                {
+                    splits_out = true;          // it is out of splitter block
+                    block2.push_back(*j);
+                }
+            }
+            #ifdef MINIMALIZATION_DEBUG
+                std::cout << "Two blocks print: " << "(splits_in: " << splits_in << ", splits_out: " << splits_out << ")\n";
+                Print_iter(block1);
+                Print_iter(block2);
+                std::cout << std::endl;
+            #endif // MINIMALIZATION_DEBUG
+            // if there are transitions to both outside and inside of the splitter (if it actually splits B)
+            // -> erase B from partition list -> add B0 and B1
+            // pozor pointery!
+            if(splits_in && splits_out)
+            {
+                STATS_INC(hopcroft_splits);
+                i = Partition_lan.insert(i, block1);        // insert new block before the old one, i points to the new block
+                bl1 = &(*i);                                // remember the pointer to the block
+                i = Partition_lan.insert(i, block2);        // insert second new block
+                bl2 = &(*i);                                // remember the pointer to the block
+                ++i;    // added two elements -> incrementing iterator by two to get back to the old block
+                ++i;
+
+                // posledni faze - upravy W
+                // for every letter of the alphabet
+                for(auto a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
+                {
+                    // goes through split queue
+                    auto split = ++W.begin();       // ignores first element (the already picked one)
+                    for(; split != W.end(); ++split)
+                    {
+                        // if splitter (a,B) exists -> replace it with (a,B0) and (a,B1)
+                        if(split->second == &(*i) && *a == split->first)
+                        {
+                            W.erase(split);     // pro jistotu
+                            W.insert(W.end(), {*a,bl1});
+                            split = W.insert(W.end(), {*a,bl2});
+                            break;
+                        }
+                    }
+                    // if splitter (a,B) does not exist -> insert (a,min{B0,B1})
+                    if(split == W.end())
+                    {
+                        if(bl1->size() < bl2->size()) W.push_back({*a,bl1});
+                        else W.push_back({*a,bl2});
+                    }
+                }
+                if(splitter.second == &(*i))    // if a block wants to split itself, it needs to temporarily save itself and redirect pointer
+                {
+                    missing_block = *i;              // temporary vector of deleted elements (function might delete block that will still be used in the future)
+                    splitter.second = &missing_block;// redirect pointer to this variable for the rest of the loop (alphabet)
+                }
+                i = Partition_lan.erase(i);     // returns iterator pointing to the next element but the for loop will increment again
+                --i;                            // therefore i decrement it here
+            }
+            #ifdef MINIMALIZATION_DEBUG
+                std::cout << "Partition print - end:\n";
+                Partition_print(Partition_lan);
+            #endif // MINIMALIZATION_DEBUG
+        }
+        W.pop_front();
+        #ifdef MINIMALIZATION_DEBUG
+            Minim_queue_print(W);
+        #endif // MINIMALIZATION_DEBUG
+    }
+}
+
+// Function implements the Minimalization algorithm. Computes minimal automaton from source automaton.
+// Block with the implicit sink state is not materialized (unless it contains a start state), transitions into it
+// are left out - the result has the same implicit sink and negated acceptance as the source automaton.
+// input: automaton1 - reference to source automaton, used to compute its minimal version
+// input: result_automaton - reference to result automaton, used to store result automaton
+// returns: void
+void Minimalization_FA(FA &automaton1, FA &result_automaton)
+{
+    std::list<std::vector<State *>> Partition_lan;
+    std::unordered_map<State *, State *> block_of;      // state of source automaton -> state of result automaton
+    std::vector<State *> representative;                // first state of every materialized block
+    State st;
+    State * st_p;
+    State * target;
+
+    Hopcroft(automaton1, Partition_lan);
+    #ifdef MINIMALIZATION_DEBUG
+        std::cout << "\nMINIMALIZATION:-------------------------------------\n";
+        Partition_print(Partition_lan);
+    #endif // MINIMALIZATION_DEBUG
+
+    // building a new minimal automaton
+    result_automaton.alphabet = automaton1.alphabet;
+    result_automaton.name = "min-" + automaton1.name;
+    result_automaton.negated = automaton1.negated;
+    result_automaton.sink = automaton1.sink;
+
+    // goes through all partitions and creates corresponding state in result_automaton
+    for(auto block = Partition_lan.begin(); block != Partition_lan.end(); ++block)
+    {
+        bool has_sink = std::find(block->begin(), block->end(), nullptr) != block->end();
+        bool has_start = false;
+        for(auto state = block->begin(); state != block->end(); ++state)
+            if(*state != nullptr && (*state)->start_st) has_start = true;
+        if(has_sink && !has_start) continue;    // block is language equivalent to the sink - it stays implicit
+
+        st.name = "";
+        st.start_st = false;
+        st.final_st = false;
+        st.id = result_automaton.states.size();
+        result_automaton.states.push_back(st);
+        st_p = &result_automaton.states.back();
+        representative.push_back(nullptr);
+
+        // setting up the state
+        for(auto state = block->begin(); state != block->end(); ++state)
+        {
+            if(*state == nullptr) continue;
+            if(representative.back() == nullptr) representative.back() = *state;
+            block_of.insert({*state, st_p});
+            st_p->name = st_p->name + (*state)->name;
+            if((*state)->final_st) st_p->final_st = true;
+            if((*state)->start_st) st_p->start_st = true;
+        }
+        if(st_p->start_st) result_automaton.start_states.push_back(st_p);
+        if(st_p->final_st) result_automaton.final_states.insert(st_p);
+    }
+
+    // creates transitions - use just the first element in each block since all elements in the same block must have similar relations with blocks
+    auto rep = representative.begin();
+    for(auto iter = result_automaton.states.begin(); iter != result_automaton.states.end(); ++iter, ++rep)
+    {
+        for(auto a = result_automaton.alphabet.begin(); a != result_automaton.alphabet.end(); ++a)
+        {
+            target = Hopcroft_target(*rep, *a);
+            if(target == nullptr) continue;
+            auto seek = block_of.find(target);
+            if(seek == block_of.end()) continue;    // transition to the implicit sink
+            iter->transit_states_p.insert({*a,seek->second});
+        }
+    }
+    MEMORY_FOOTPRINT(result_states, Footprint_FA(result_automaton));
+}
+
+// ---------------------------------------- REDUCTION ILIE -----------------------------------------
+
+// Function implements the Simulation relation algorithm. Computes simulation relation of an automaton. The relation of
+// an automaton with epsilon transitions is computed on its copy without them, so it is usable by the algorithms with closures.
+// input: automaton1 - reference to source automaton, used to compute its minimal version
+// input: preorder - reference to result preorder, used to store simulation relation
+// input: bits - pointer to a bit matrix, if not null, the simulation relation is stored into it too (indexes are State::id)
+// returns: void
+void Preorder(FA &automaton1, std::unordered_set<std::pair<std::string,std::string>, pair_hash> &preorder, Bit_relation *bits)
+{
+    // sim, N(a)ik = card()
+    Materialize_FA(automaton1);     // algorithm works only with explicit automatons (before N is allocated)
+    if(Has_epsilon(automaton1))     // languages of the states are kept by Remove_epsilon_FA, the relation is computed on a copy
+    {
+        FA copy(automaton1);
+        Remove_epsilon_FA(copy);
+        Preorder(FA_view(copy), preorder, bits);
+        return;
+    }
+    Preorder(FA_view(automaton1), preorder, bits);
+}
+
+// Function implements the Simulation relation algorithm on a view of an explicit automaton without epsilon transitions.
+// The forward view gives the forward simulation, the reversed view the backward simulation, the automaton is not changed.
+// input: view - reference to the view of the automaton
+// input: preorder - reference to result preorder, used to store simulation relation
+// input: bits - pointer to a bit matrix, if not null, the simulation relation is stored into it too (indexes are State::id)
+// returns: void
+void Preorder(const FA_view &view, std::unordered_set<std::pair<std::string,std::string>, pair_hash> &preorder, Bit_relation *bits)
+{
+    const FA &automaton1 = view.fa();
+    // basically: int N[alphabet][state][state] = {0}
+    std::vector<std::vector<std::vector<int>>> N(automaton1.alphabet.size(),std::vector<std::vector<int>>
+                                                (automaton1.states.size(),std::vector<int>
+                                                (automaton1.states.size(),0)));
+    MEMORY_FOOTPRINT(preorder_N, automaton1.alphabet.size() * (sizeof(std::vector<std::vector<int>>) + automaton1.states.size() *
+                                 (sizeof(std::vector<int>) + automaton1.states.size() * sizeof(int))));
+    // card[a][state] = |post(state,a)|
+    std::vector<std::vector<int>> card(automaton1.alphabet.size(), std::vector<int>(automaton1.states.size(), 0));
+    std::queue<std::pair<const State *,const State *>> W;   // queue of state pairs
+    std::pair<const State *,const State *> st_pair, st_pair2;   // inserting or removing pairs from W and preord
+    std::unordered_set<std::pair<std::string,std::string>, pair_hash> preord;
+
+    std::vector<std::string>::const_iterator a;      // iterates through alphabet
+    std::pair<std::multimap<std::string, State *>::const_iterator,std::multimap<std::string, State *>::const_iterator> range1, range2; // for .equal_range()
+
+    // preprocessing - view numbered the states (id contains an index to N array), compute cardinality(post(state,a))
+    for(auto i = automaton1.states.begin(); i != automaton1.states.end(); ++i)
+    {
+        for(a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
+            card[a - automaton1.alphabet.begin()][i->id] = view.post(&(*i)).count(*a);
+    }
+
+    // initializing preord and W
+    for(auto i = automaton1.states.begin(); i != automaton1.states.end(); ++i)
+    {
+        // W initialization -----------------------
+        for(auto j = automaton1.states.begin(); j != automaton1.states.end(); ++j)
+        {
+            if(view.is_final(&(*i)))     // add all pairs Fx(Q-F)
+            {
+                if(!view.is_final(&(*j)))// i=F, j=(Q-F)
+                {
+                    st_pair.first = &(*i);
+                    st_pair.second = &(*j);
+                    preord.insert({st_pair.first->name,st_pair.second->name});
+                    W.push(st_pair);
+                    continue;
+                }
+            }
+            // {(q,r)| Ea in alphabet: d(q,a)!=0 and d(r,a)==0}
+            for(a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
+            {
+                std::size_t letter = a - automaton1.alphabet.begin();
+                if(card[letter][i->id] > 0 && card[letter][j->id] == 0 && preord.find({i->name,j->name}) == preord.end())
+                {
+                    st_pair.first = &(*i);
+                    st_pair.second = &(*j);
+                    preord.insert({st_pair.first->name,st_pair.second->name});
+                    W.push(st_pair);
+                }
+            }
+        }
+    }
+
+    #ifdef REDUCTION_DEBUG
+        std::cout << "Reduction - printing preord: ";
+        Print_reduct(preord);
+    #endif // REDUCTION_DEBUG
+
+    // main loop
+    while(!W.empty())
+    {
+        st_pair = W.front();    // (i,j)
+
+        #ifdef REDUCTION_DEBUG
+            std::cout << "Reduction - printing W pair: (" << st_pair.first->name << "," << st_pair.second->name << ")" << std::endl;
+        #endif // REDUCTION_DEBUG
+
+        for(a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
+        {
+            // get rd(j,a)
+            range1 = view.pre(st_pair.second).equal_range(*a);
+            for(auto k = range1.first; k != range1.second; ++k)
+            {
+                // N(a)ik <- N(a)ik + 1
+                N[a - automaton1.alphabet.begin()][st_pair.first->id][k->second->id]++;
+                STATS_INC(preorder_updates);
+                if(N[a - automaton1.alphabet.begin()][st_pair.first->id][k->second->id] == card[a - automaton1.alphabet.begin()][k->second->id])
+                {
+                    // get rd(i,a)
+                    range2 = view.pre(st_pair.first).equal_range(*a);
+                    for(auto l = range2.first; l != range2.second; ++l)
+                    {
+                        st_pair2.first = l->second;
+                        st_pair2.second = k->second;
+                        if(preord.find({st_pair2.first->name,st_pair2.second->name}) == preord.end())   // if (l,k) not in preord
+                        {
+                            preord.insert({st_pair2.first->name,st_pair2.second->name});                // insert (l,k) into preord
+                            W.push(st_pair2);                       // insert (l,k) into queue
+
+                            #ifdef REDUCTION_DEBUG
+                                std::cout << "Reduction - pushing pair into preord and W: (" << st_pair2.first->name << "," << st_pair2.second->name << ")" << std::endl;
+                            #endif // REDUCTION_DEBUG
+                        }
+                    }
+                }
+            }
+        }
+        W.pop();
+    }
+
+    STATS_ADD(preorder_removed, preord.size());
+    MEMORY_FOOTPRINT(preorder_relation, Footprint_hash(preord));
+    preorder.clear(); // clear preorder set
+    if(bits != nullptr) bits->assign(automaton1.states.size(), std::vector<std::uint64_t>((automaton1.states.size()+63)/64, 0));
+    // converting complement preorder (preord) to preorder (preorder)
+    for(auto i = automaton1.states.begin(); i != automaton1.states.end(); ++i)
+    {
+        for(auto j = automaton1.states.begin(); j != automaton1.states.end(); ++j)
+        {
+            st_pair.first = &(*i);
+            st_pair.second = &(*j);
+            if(preord.find({st_pair.first->name,st_pair.second->name}) == preord.end())
+            {
+                preorder.insert({st_pair.first->name,st_pair.second->name});
+                if(bits != nullptr) (*bits)[i->id][j->id/64] |= std::uint64_t(1) << (j->id%64);
+            }
+        }
+    }
+}
+
+// Function reverses automaton in place - replaces transitions (and epsilon transitions) of every state by its predecessors
+// and swaps start states with final states. Algorithms that only read the reverse use the reversed FA_view instead.
+// input: automaton1 - reference to automaton
+// returns: void
+void Reverse_in_place(FA &automaton1)
+{
+    Materialize_FA(automaton1);     // algorithm works only with explicit automatons (the fail state is numbered too)
+
+    std::vector<std::multimap<std::string, State *>> predecessors(automaton1.states.size());
+    std::vector<std::vector<State *>> epsilon(automaton1.states.size());
+
+    for(auto state = automaton1.states.begin(); state != automaton1.states.end(); ++state)
+    {
+        for(auto const& x : state->transit_states_p)
+            predecessors[x.second->id].insert({x.first, &(*state)});
+        for(auto target = state->epsilon_p.begin(); target != state->epsilon_p.end(); ++target)
+            epsilon[(*target)->id].push_back(&(*state));
+    }
+    for(auto state = automaton1.states.begin(); state != automaton1.states.end(); ++state)
+    {
+        state->transit_states_p.swap(predecessors[state->id]);
+        state->epsilon_p.swap(epsilon[state->id]);
+        std::swap(state->final_st, state->start_st);
+    }
+    std::vector<State *> start_states(automaton1.final_states.begin(), automaton1.final_states.end());
+    automaton1.final_states = std::set<State *>(automaton1.start_states.begin(), automaton1.start_states.end());
+    automaton1.start_states = start_states;
+}
+
+// Function erases all pairs that contain state removed from both relations.
+// input: removed - id of the state
+// input: rel1, rel2 - references to both preorders (bit matrices)
+// returns: void
+void Remove_from_relations(std::size_t removed, Bit_relation &rel1, Bit_relation &rel2)
+{
+    std::uint64_t mask = ~(std::uint64_t(1) << (removed%64));
+
+    for(auto rel : {&rel1, &rel2})
+    {
+        std::fill((*rel)[removed].begin(), (*rel)[removed].end(), 0);
+        for(auto row = rel->begin(); row != rel->end(); ++row)
+            (*row)[removed/64] &= mask;
+    }
+}
+
+// Function merges state removed into state kept. Rows of the kept state are intersected with the rows of the removed state
+// (pairs (kept,j) stay only if (removed,j) was in the relation too - Ilie algorithm), then the removed state is erased.
+// input: kept, removed - ids of the states
+// input: rel1, rel2 - references to both preorders (bit matrices)
+// input: classes - reference to union-find structure of merged states
+// returns: void
+void Merge_states(std::size_t kept, std::size_t removed, Bit_relation &rel1, Bit_relation &rel2, Union_find &classes)
+{
+    for(auto rel : {&rel1, &rel2})
+    {
+        for(std::size_t w = 0; w < (*rel)[kept].size(); ++w)
+            (*rel)[kept][w] &= (*rel)[removed][w];
+        (*rel)[kept][kept/64] |= std::uint64_t(1) << (kept%64);    // relation stays reflexive
+    }
+    Remove_from_relations(removed, rel1, rel2);
+    classes.parent[removed] = kept;
+    STATS_INC(reduction_merged);
+}
+
+// Function merges all pairs of states p,q such that p <= q and q <= p in relation main_rel (equivalent states).
+// input: main_rel - reference to preorder used to find equivalent states
+// input: other_rel - reference to the second preorder, it is updated too
+// input: classes - reference to union-find structure of merged states
+// returns: void
+void Merge_equivalent(Bit_relation &main_rel, Bit_relation &other_rel, Union_find &classes)
+{
+    for(std::size_t p = 0; p < main_rel.size(); ++p)
+    {
+        if(classes.parent[p] != p) continue;    // already merged
+        for(std::size_t w = 0; w < main_rel[p].size(); ++w)
+        {
+            for(std::uint64_t bits = main_rel[p][w]; bits != 0; bits &= bits - 1)
+            {
+                std::size_t q = w*64 + __builtin_ctzll(bits);
+                if(q == p) continue;
+                if((main_rel[q][p/64] >> (p%64)) & 1)    // found (p,q) (q,p) duo
+                    Merge_states(p, q, main_rel, other_rel, classes);
+            }
+        }
+    }
+}
+
+// Function implements the Ilie NFA reduction. States equivalent in the right (forward simulation) or left (backward simulation)
+// preorder are merged and then every state p such that p <= q in both preorders (for some other state q) is removed.
+// Forward bisimilar states are merged first (Bisimulation_representatives), so both preorders are computed on the smaller
+// quotient. Merged states are collected in a union-find structure and the reduced automaton is built at once as a quotient
+// (Quotient_FA). The source automaton is not changed.
+// input: automaton1 - reference to source automaton
+// input: result_automaton - reference to result automaton
+// returns: void
+void Reduction_NFA(const FA &automaton1, FA &result_automaton)
+{
+    std::unordered_set<std::pair<std::string,std::string>, pair_hash> preorder_r, preorder_l;
+    Bit_relation rel_r, rel_l;
+    Union_find classes;
+    std::vector<bool> removed;                                          // states removed by the second rule
+    std::vector<std::size_t> representative;
+    FA copy, bisimilar;
+    const FA *automaton = &Explicit_FA(automaton1, copy);   // algorithm works only with explicit automatons without epsilon transitions
+
+    // bisimilar states are merged anyway, the quotient shrinks the input of Preorder
+    if(Bisimulation_representatives(FA_view(*automaton), representative) < automaton->states.size())
+    {
+        Quotient_FA(*automaton, representative, bisimilar);
+        automaton = &bisimilar;
+    }
+
+    // get preorder R
+    FA_view forward(*automaton);
+    Preorder(forward, preorder_r, &rel_r);
+
+    #ifdef REDUCTION_DEBUG
+        std::cout << "Reduction NFA - final r-preorder: ";
+        Print_reduct(preorder_r);
+    #endif // REDUCTION_DEBUG
+
+    // get preorder L on the reversed view, the predecessors built for preorder R are reused
+    Preorder(forward.reverse(), preorder_l, &rel_l);
+
+    #ifdef REDUCTION_DEBUG
+        std::cout << "Reduction NFA - final l-preorder: ";
+        Print_reduct(preorder_l);
+    #endif // REDUCTION_DEBUG
+
+    std::size_t n = automaton->states.size();
+    classes.parent.resize(n);
+    for(std::size_t i = 0; i < n; ++i) classes.parent[i] = i;
+    removed.assign(n, false);
+
+    // 1) p-q, q-p ve stejnem preorderu
+    Merge_equivalent(rel_r, rel_l, classes);
+    Merge_equivalent(rel_l, rel_r, classes);
+
+    // 2) p-q, p-q v rozdilnych preorderech - state p is simulated by q from both sides, it can be removed
+    for(std::size_t p = 0; p < n; ++p)
+    {
+        if(classes.parent[p] != p) continue;
+        for(std::size_t w = 0; w < rel_r[p].size(); ++w)
+        {
+            std::uint64_t bits = rel_r[p][w] & rel_l[p][w];
+            if(w == p/64) bits &= ~(std::uint64_t(1) << (p%64));    // (p,p)
+            if(bits != 0)
+            {
+                Remove_from_relations(p, rel_r, rel_l);
+                removed[p] = true;
+                STATS_INC(reduction_removed);
+                break;
+            }
+        }
+    }
+
+    // quotient - every state is represented by the root of its class, classes of removed states are left out
+    representative.assign(n, SIZE_MAX);
+    for(std::size_t i = 0; i < n; ++i)
+        if(!removed[classes.find(i)]) representative[i] = classes.find(i);
+    Quotient_FA(*automaton, representative, result_automaton);
+    MEMORY_FOOTPRINT(result_states, Footprint_FA(result_automaton));
+}
+
+// Function implements the Ilie NFA reduction in place (see Reduction_NFA above).
+// input: automaton1 - reference to source automaton, reduced in place
+// returns: void
+void Reduction_NFA(FA &automaton1)
+{
+    FA result_automaton;
+
+    Materialize_FA(automaton1);     // made explicit in place, Reduction_NFA does not copy it again
+    Remove_epsilon_FA(automaton1);
+    Reduction_NFA(automaton1, result_automaton);
+    automaton1 = std::move(result_automaton);
+}
+
+// ---------------------------------------- BISIMULATION (PAIGE-TARJAN) -----------------------------------------
+
+// refinable partition of the states (Paige-Tarjan) - every block is a range of elements, marked states of a block
+// are moved to the beginning of its range, blocks are grouped into compound blocks (splitters)
+typedef struct {
+    std::vector<std::size_t> elements;              // states ordered by blocks
+    std::vector<std::size_t> position;              // state -> index in elements
+    std::vector<std::size_t> block;                 // state -> block
+    std::vector<std::size_t> begin, end;            // block -> range in elements
+    std::vector<std::size_t> marked;                // block -> number of marked states
+    std::vector<std::size_t> touched;               // blocks with marked states
+    std::vector<std::size_t> compound_of;           // block -> compound block
+    std::vector<std::size_t> slot;                  // block -> index in its compound block
+    std::vector<std::vector<std::size_t>> compound; // compound block -> blocks
+    std::vector<std::size_t> pending;               // compound blocks with more than one block (may contain stale entries)
+} Bisim_partition;
+
+// Function marks a state, it is moved to the marked part of its block.
+// input: part - reference to partition
+// input: state - index of the state, every state is marked at most once before Bisim_split
+// returns: void
+inline void Bisim_mark(Bisim_partition &part, std::size_t state)
+{
+    std::size_t b = part.block[state];
+    if(part.marked[b] == 0) part.touched.push_back(b);
+    std::size_t i = part.begin[b] + part.marked[b]++;
+    std::size_t other = part.elements[i];
+    std::swap(part.elements[i], part.elements[part.position[state]]);
+    part.position[other] = part.position[state];
+    part.position[state] = i;
+}
+
+// Function splits every block with marked states into marked and unmarked part. The marked part becomes a new block
+// of the same compound block, the compound block is pending when it gets its second block.
+// input: part - reference to partition
+// returns: void
+void Bisim_split(Bisim_partition &part)
+{
+    for(auto b = part.touched.begin(); b != part.touched.end(); ++b)
+    {
+        std::size_t marked = part.marked[*b];
+        part.marked[*b] = 0;
+        if(marked == part.end[*b] - part.begin[*b]) continue;     // the whole block is marked
+
+        std::size_t created = part.begin.size(), x = part.compound_of[*b];
+        part.begin.push_back(part.begin[*b]);
+        part.end.push_back(part.begin[*b] + marked);
+        part.marked.push_back(0);
+        part.begin[*b] += marked;
+        for(std::size_t i = part.begin[created]; i < part.end[created]; ++i)
+            part.block[part.elements[i]] = created;
+        part.compound_of.push_back(x);
+        part.slot.push_back(part.compound[x].size());
+        part.compound[x].push_back(created);
+        if(part.compound[x].size() == 2) part.pending.push_back(x);
+        STATS_INC(bisimulation_splits);
+    }
+    part.touched.clear();
+}
+
+// Function implements the Paige-Tarjan partition refinement - computes the coarsest bisimulation of an automaton view,
+// O(m log n). Blocks are refined by a block B taken from a compound block S (|B| <= |S|/2), for every letter a once by
+// pre_a(B) and once by pre_a(B) - pre_a(S - B). The second split is decided by counters |post_a(p) & S| shared by all
+// a-transitions from p into S, so the transitions into S - B are never visited.
+// input: view - reference to the view of an explicit automaton without epsilon transitions
+// input: block - reference to vector State::id -> block (output)
+// returns: number of blocks
+std::size_t Bisimulation_classes(const FA_view &view, std::vector<std::size_t> &block)
+{
+    const FA &automaton1 = view.fa();
+    const std::size_t none = SIZE_MAX;
+    std::size_t n = automaton1.states.size();
+    std::unordered_map<std::string, std::size_t> letter_id;
+    std::vector<std::size_t> source, letter, cell;         // transitions, cell -> index to count
+    std::vector<std::size_t> count;                        // counters |post_a(p) & S|
+    std::vector<std::vector<std::size_t>> incoming(n);     // state -> transitions leading into it
+    std::vector<std::vector<std::size_t>> enabled;         // letter -> states with a transition under it
+    Bisim_partition part;
+
+    if(n == 0) { block.clear(); return 0; }
+
+    // transitions of the view, a-transitions of one state share one counter (S is the universe)
+    for(auto st = automaton1.states.begin(); st != automaton1.states.end(); ++st)
+    {
+        const std::multimap<std::string, State *> &next = view.post(&(*st));
+        for(auto t = next.begin(); t != next.end(); ++t)
+        {
+            auto id = letter_id.insert({t->first, letter_id.size()});
+            if(id.second) enabled.emplace_back();
+            if(t == next.begin() || std::prev(t)->first != t->first)
+            {
+                count.push_back(0);
+                enabled[id.first->second].push_back(st->id);
+            }
+            ++count.back();
+            incoming[t->second->id].push_back(source.size());
+            source.push_back(st->id);
+            letter.push_back(id.first->second);
+            cell.push_back(count.size() - 1);
+        }
+    }
+
+    // one block, one compound block, the initial partition separates final states and states with different letters
+    for(std::size_t s = 0; s < n; ++s) { part.elements.push_back(s); part.position.push_back(s); }
+    part.block.assign(n, 0);
+    part.begin = {0};
+    part.end = {n};
+    part.marked = {0};
+    part.compound_of = {0};
+    part.slot = {0};
+    part.compound = {{0}};
+    for(auto st = automaton1.states.begin(); st != automaton1.states.end(); ++st)
+        if(view.is_final(&(*st))) Bisim_mark(part, st->id);
+    Bisim_split(part);
+    for(auto a = enabled.begin(); a != enabled.end(); ++a)
+    {
+        for(auto p = a->begin(); p != a->end(); ++p)
+            Bisim_mark(part, *p);
+        Bisim_split(part);
+    }
+
+    std::vector<std::size_t> splitter, sources;
+    std::vector<std::size_t> new_cell(n, none), old_cell(n, none);
+    std::vector<std::vector<std::size_t>> by_letter(letter_id.size());
+    std::vector<std::size_t> letters;
+    while(!part.pending.empty())
+    {
+        std::size_t x = part.pending.back();
+        std::vector<std::size_t> &blocks = part.compound[x];
+        if(blocks.size() < 2) { part.pending.pop_back(); continue; }     // stale entry
+        STATS_INC(bisimulation_splitters);
+
+        // the smaller of two blocks of S has at most |S|/2 states, it becomes a compound block of its own
+        std::size_t b = blocks[0], other = blocks[1];
+        if(part.end[other] - part.begin[other] < part.end[b] - part.begin[b]) b = other;
+        blocks[part.slot[b]] = blocks.back();
+        part.slot[blocks.back()] = part.slot[b];
+        blocks.pop_back();
+        if(blocks.size() < 2) part.pending.pop_back();
+        part.compound_of[b] = part.compound.size();
+        part.slot[b] = 0;
+        part.compound.push_back({b});
+
+        // transitions into B by letters, B itself can be split while it is used
+        splitter.assign(part.elements.begin() + part.begin[b], part.elements.begin() + part.end[b]);
+        for(auto q = splitter.begin(); q != splitter.end(); ++q)
+        {
+            for(auto t = incoming[*q].begin(); t != incoming[*q].end(); ++t)
+            {
+                if(by_letter[letter[*t]].empty()) letters.push_back(letter[*t]);
+                by_letter[letter[*t]].push_back(*t);
+            }
+        }
+
+        for(auto a = letters.begin(); a != letters.end(); ++a)
+        {
+            std::vector<std::size_t> &transitions = by_letter[*a];
+            for(auto t = transitions.begin(); t != transitions.end(); ++t)
+            {
+                std::size_t p = source[*t];
+                if(new_cell[p] == none)
+                {
+                    new_cell[p] = count.size();
+                    old_cell[p] = cell[*t];
+                    count.push_back(0);
+                    sources.push_back(p);
+                }
+                ++count[new_cell[p]];
+            }
+
+            // split by pre_a(B)
+            for(auto p = sources.begin(); p != sources.end(); ++p)
+                Bisim_mark(part, *p);
+            Bisim_split(part);
+
+            // split by pre_a(B) - pre_a(S - B) - all a-successors of p in S are in B
+            for(auto p = sources.begin(); p != sources.end(); ++p)
+                if(count[new_cell[*p]] == count[old_cell[*p]]) Bisim_mark(part, *p);
+            Bisim_split(part);
+
+            // |post_a(p) & (S - B)| and |post_a(p) & B|
+            for(auto t = transitions.begin(); t != transitions.end(); ++t)
+            {
+                --count[cell[*t]];
+                cell[*t] = new_cell[source[*t]];
+            }
+            for(auto p = sources.begin(); p != sources.end(); ++p)
+                new_cell[*p] = none;
+            sources.clear();
+            transitions.clear();
+        }
+        letters.clear();
+    }
+
+    block = part.block;
+    return part.begin.size();
+}
+
+// Function finds the representatives of the classes of the coarsest bisimulation on the view (Bisimulation_classes),
+// the first state of every class represents it.
+// input: view - reference to the view of an explicit automaton without epsilon transitions
+// input: representative - reference to result, State::id -> State::id of the representative
+// returns: number of classes
+std::size_t Bisimulation_representatives(const FA_view &view, std::vector<std::size_t> &representative)
+{
+    std::vector<std::size_t> block, first;
+    std::size_t classes = Bisimulation_classes(view, block);
+
+    first.assign(classes, SIZE_MAX);
+    representative.resize(block.size());
+    for(std::size_t i = 0; i < block.size(); ++i)
+    {
+        if(first[block[i]] == SIZE_MAX) first[block[i]] = i;
+        representative[i] = first[block[i]];
+    }
+    return classes;
+}
+
+// Function implements the bisimulation reduction - merges states of every class of the coarsest forward (or backward)
+// bisimulation (Paige-Tarjan). It is cheaper than Reduction_NFA, no simulation preorder is computed. Only the
+// representatives are copied to the result (Quotient_FA), a class gets transitions of all its states (states of
+// a backward class differ in successors). The source automaton is not changed.
+// input: automaton1 - reference to source automaton
+// input: result_automaton - reference to result automaton
+// input: backward - true -> backward bisimulation (bisimulation of the reverse)
+// returns: void
+void Bisimulation_NFA(const FA &automaton1, FA &result_automaton, bool backward)
+{
+    FA copy;
+    const FA &automaton = Explicit_FA(automaton1, copy);    // algorithm works only with explicit automatons without epsilon transitions
+    std::vector<std::size_t> representative;
+
+    Bisimulation_representatives(FA_view(automaton, backward), representative);
+    Quotient_FA(automaton, representative, result_automaton);
+    MEMORY_FOOTPRINT(result_states, Footprint_FA(result_automaton));
+}
+
+// Function implements the bisimulation reduction in place (see Bisimulation_NFA above).
+// input: automaton1 - reference to source automaton, reduced in place
+// input: backward - true -> backward bisimulation (bisimulation of the reverse)
+// returns: void
+void Bisimulation_NFA(FA &automaton1, bool backward)
+{
+    FA result_automaton;
+    std::vector<std::size_t> representative;
+
+    Materialize_FA(automaton1);     // algorithm works only with explicit automatons
+    Remove_epsilon_FA(automaton1);  // and without epsilon transitions
+    if(Bisimulation_representatives(FA_view(automaton1, backward), representative) == automaton1.states.size()) return;     // nothing to merge
+    Quotient_FA(automaton1, representative, result_automaton);
+    MEMORY_FOOTPRINT(result_states, Footprint_FA(result_automaton));
+    automaton1 = std::move(result_automaton);
+}
+
+// ---------------------------------------- BRZOZOWSKI MINIMALIZATION -----------------------------------------
+
+// Function implements Brzozowski's minimalization - determinization of the reverse of the determinized reverse.
+// The reverse is built in place (Reverse_in_place) on a private copy, so the input automaton stays unchanged.
+// The large determinization of the automaton itself is never built.
+// input: automaton1 - reference to source automaton
+// input: result_automaton - reference to result automaton, minimal DFA (not complete)
+// returns: number of states of the intermediate DFA (determinized reverse)
+long Brzozowski_FA(const FA &automaton1, FA &result_automaton)
+{
+    FA work(automaton1);
+    FA reversed;
+
+    Remove_epsilon_FA(work);    // the reverse is built from letter transitions only
+    Reverse_in_place(work);
+    Determinization_FA(work, reversed);
+
+    Reverse_in_place(reversed);
+    Determinization_FA(reversed, result_automaton);
+    result_automaton.name = "min-" + automaton1.name;
+    MEMORY_FOOTPRINT(result_states, Footprint_FA(result_automaton));
+    return Count_states(reversed);
+}
+
+// Function counts nondeterminism of automaton in one direction - start states above one and transitions above one
+// for every state and letter.
+// input: automaton - reference to FA
+// input: reversed - true -> counts the reverse (final states, predecessors)
+// returns: number of nondeterministic choices
+long Nondeterminism(const FA &automaton, bool reversed)
+{
+    FA_view view(automaton, reversed);
+    long count = 0, initial = 0;
+    for(auto state = automaton.states.begin(); state != automaton.states.end(); ++state)
+    {
+        const std::multimap<std::string, State *> &next = view.post(&(*state));
+        for(auto t = next.begin(); t != next.end(); t = next.upper_bound(t->first))
+            count += next.count(t->first) - 1;
+        if(view.is_initial(&(*state))) ++initial;
+    }
+    return count + std::max(0L, initial - 1);
+}
+
+// Function implements the minimalization of NFA - Hopcroft on the determinized automaton (a DFA is not determinized)
+// or Brzozowski. The automatic method chooses Brzozowski when the reverse of the automaton is less nondeterministic
+// than the automaton itself, its determinization is then expected to be the smaller one.
+// input: automaton1 - reference to source automaton
+// input: result_automaton - reference to result automaton, minimal DFA
+// input: method - HOPCROFT, BRZOZOWSKI or AUTOMATIC
+// returns: used method and size of the intermediate DFA
+Minimalization_report Minimalization_NFA(FA &automaton1, FA &result_automaton, Minimalization_method method)
+{
+    if(method == AUTOMATIC)
+        method = (!Is_deterministic(automaton1) && Nondeterminism(automaton1, true) < Nondeterminism(automaton1, false)) ? BRZOZOWSKI : HOPCROFT;
+    if(method == BRZOZOWSKI) return {method, Brzozowski_FA(automaton1, result_automaton)};
+    if(Is_deterministic(automaton1))
+    {
+        Minimalization_FA(automaton1, result_automaton);
+        return {method, Count_states(automaton1)};
+    }
+    FA determinized;
+    Determinization_FA(automaton1, determinized);
+    Minimalization_FA(determinized, result_automaton);
+    return {method, Count_states(determinized)};
+}
+
+// --------------------------- UNIVERSALITY AND INCLUSION ----------------------
+
+// Function iterates (i,j are iterators) through macro state and if there is (i,j) pair in preorder, it deletes i from macro state. Implements second optimization.
+// input: macro_R - reference to source macro state
+// input: preorder - reference to simulation relation
+// returns: void
+void Minimize(Macro_state &macro_R, std::unordered_set<std::pair<std::string,std::string>, pair_hash> &preorder)
+{
+    for(auto i = macro_R.states.begin(); i != macro_R.states.end(); ++i)
+    {
+        for(auto j = macro_R.states.begin(); j != macro_R.states.end(); ++j)
+        {
+            if(i == j) continue;        // identity cannot remove state
+            if(preorder.find({(*i)->name,(*j)->name}) != preorder.end())  // if there is a pair (i,j) in preorder
+            {
+                i = --macro_R.states.erase(i); // remove i (because i is simulated by j)
+                break;
+            }
+        }
+    }
+}
+
+// Function checks if first macro state (macroSubs) is subset of second macro state (macroSuper).
+// For every state sub_st in first macro state there must be state super_st in second macro state such that (sub_st, super_st) are in preorder.
+// input: macroSubs - reference to first macro state
+// input: macroSuper - reference to second macro state
+// input: preorder - reference to simulation relation
+// returns: True if macroSubs is subset of macroSuper, false otherwise.
+bool Is_subset(Macro_state &macroSubs, Macro_state &macroSuper, std::unordered_set<std::pair<std::string,std::string>, pair_hash> &preorder)
+{
+    STATS_INC(subset_calls);
+    // for every state of subset
+    for(auto sub_st = macroSubs.states.begin(); sub_st != macroSubs.states.end(); ++sub_st)
+    {
+        // there must be a state in superset
+        auto super_st = macroSuper.states.begin();
+        for(; super_st != macroSuper.states.end(); ++super_st)
+        {
+            // such that sub_st <= super_st in preorder
+            if(preorder.find({(*sub_st)->name,(*super_st)->name}) != preorder.end()) break;
+        }
+        if(super_st == macroSuper.states.end()) return false;
+    }
+    return true;
+}
+
+// Function implements the Universality algorithm.
+// input: automaton1 - reference to source automaton
+// input: preorder - reference to simulation relation
+// returns: True if automaton is universal, false if automaton is not universal
+bool Universality_NFA(FA &automaton1, std::unordered_set<std::pair<std::string,std::string>, pair_hash> &preorder)
+{
+    Macro_state macro_R, macro_P;               // macro states R and P
+    std::vector<Macro_state> processed, next;   // processed and next vectors
+    std::unordered_set<std::string> redundant;  // used to prevent redundancy of states when creating new macro states
+    bool exists_S;                              // used to check if S exists
+    std::unordered_map<std::string,std::size_t> letter_index;   // index of the letter in the alphabet
+    std::vector<std::size_t> enabled;           // letters with a transition from the macro state
+
+    std::vector<Macro_state>::iterator macro_S; // macro state S
+    std::pair<std::multimap<std::string, State *>::iterator,std::multimap<std::string, State *>::iterator> range1;    // .equal_range()
+
+    Materialize_FA(automaton1);     // algorithm works only with explicit automatons
+    for(std::size_t i = 0; i < automaton1.alphabet.size(); ++i)
+        letter_index.insert({automaton1.alphabet[i], i});
+    Epsilon_closure closures;       // macro states are closed under epsilon transitions
+    bool epsilon = Has_epsilon(automaton1);
+    if(epsilon) Epsilon_closures(automaton1, closures);
+
+    // if a macro state of start states is rejecting -> automaton does not recognise empty string (epsilon) as a part of the language
+    // -> language is not universal
+    macro_R.states = automaton1.start_states;
+    if(epsilon) Close_epsilon(closures, macro_R.states);
+    macro_R.rejecting = true;
+    for(auto state = macro_R.states.begin(); state != macro_R.states.end(); ++state)
+    {
+        if((*state)->final_st) { macro_R.rejecting = false; break; }
+    }
+    if(macro_R.rejecting) return false;
+
+    // next = {Minimize(I)};
+    Minimize(macro_R, preorder);
+    next.push_back(macro_R);
+
+    // main loop
+    while(!next.empty())
+    {
+        macro_R = next.back();
+        next.pop_back();
+        processed.push_back(macro_R);
+        STATS_INC(antichain_processed);
+        MEMORY_FOOTPRINT(antichains, Footprint_antichain(processed) + Footprint_antichain(next));
+        if(epsilon) Close_epsilon(closures, macro_R.states);   // states removed by Minimize are needed for Post
+
+        #ifdef UNIVERSALITY_DEBUG
+            std::cout << "Universality - printing current macro state: ";
+            Print_MacroState(macro_R);
+        #endif // UNIVERSALITY_DEBUG
+
+        // a dead letter leads to the empty (rejecting) macro state
+        Enabled_letters(macro_R.states, letter_index, enabled);
+        if(enabled.size() < automaton1.alphabet.size()) return false;
+
+        // get adjacent macro states
+        for(auto a = automaton1.alphabet.begin(); a != automaton1.alphabet.end(); ++a)
+        {
+            // getting Post(R) for specific letter *a
+            redundant.clear();
+            macro_P.states.clear();
+            macro_P.rejecting = true;
+            for(auto state = macro_R.states.begin(); state != macro_R.states.end(); ++state)
+            {
+                range1 = (*state)->transit_states_p.equal_range(*a);
+                for(auto next_st = range1.first; next_st != range1.second; ++next_st)
+                {
+                    if(redundant.insert(next_st->second->name).second)  // does not push redundant states - fast searching
+                    {
+                        macro_P.states.push_back(next_st->second);
+                        if(next_st->second->final_st) macro_P.rejecting = false;    // sets the rejecting flag
+                    }
+                }
+            }
+            if(epsilon)
+            {
+                Close_epsilon(closures, macro_P.states);
+                for(auto state = macro_P.states.begin(); state != macro_P.states.end() && macro_P.rejecting; ++state)
+                    macro_P.rejecting = !(*state)->final_st;
+            }
+            #ifdef UNIVERSALITY_DEBUG
+                std::cout << "\tUniversality - printing new macro state (" << *a << ") before minimalization:\n\t\t";
+                Print_MacroState(macro_P);
+            #endif // UNIVERSALITY_DEBUG
+
+            Minimize(macro_P, preorder);
+
+            #ifdef UNIVERSALITY_DEBUG
+                std::cout << "\tUniversality - printing new macro state (" << *a << ") after minimalization:\n\t\t";
+                Print_MacroState(macro_P);
+            #endif // UNIVERSALITY_DEBUG
+
+            if(macro_P.rejecting) return false;
+
+            // search in processed for S such that S <= P
+            exists_S = false;
+            for(macro_S = processed.begin(); macro_S != processed.end();)
+            {
+                if(Is_subset(*macro_S, macro_P, preorder)) { exists_S = true; STATS_INC(antichain_pruned); break; }
+
+                // remove all S from processed such that P <= S
+                if(Is_subset(macro_P, *macro_S, preorder))
+                {
+                    macro_S = processed.erase(macro_S);
+                    STATS_INC(antichain_removed);
+                }
+                else ++macro_S;
+            }
+            if(!exists_S)   // if not found yet
+            {
+                // search in next for S such that S <= P
+                for(macro_S = next.begin(); macro_S != next.end();)
+                {
+                    if(Is_subset(*macro_S, macro_P, preorder)) { exists_S = true; STATS_INC(antichain_pruned); break; }
+
+                    // remove all S from next such that P <= S
+                    if(Is_subset(macro_P, *macro_S, preorder))
+                    {
+                        macro_S = next.erase(macro_S);
+                        STATS_INC(antichain_removed);
+                    }
+                    else ++macro_S;
+                }
+            }
+            // if no such S was found
+            if(!exists_S)
+            {
+                // add P to next
+                next.push_back(macro_P);
+                #ifdef UNIVERSALITY_DEBUG
+                    std::cout << "\tUniversality - pushing (into next) macro state ";
+                    Print_MacroState(macro_P);
+                #endif // UNIVERSALITY_DEBUG
+            }
+        }
+    }
+    return true;
+}
+
+// Function implements the Inclusion algorithm. Checks if L(automaton1) is subset of L(automaton2).
+// input: automaton1 - reference to first automaton
+// input: automaton2 - reference to second automaton
+// input: preorder - reference to simulation relation of (automaton1 union automaton2)
+// returns: True if L(automaton1) is subset of L(automaton2), false otherwise.
+bool Inclusion_NFA(FA &automaton1, FA &automaton2, std::unordered_set<std::pair<std::string,std::string>, pair_hash> &preorder)
+{
+    Product_state prod_st1, prod_st2;
+    Macro_state macro_R, macro_P;               // macro states R and P
+    std::vector<Product_state> processed, next; // processed and next vectors
+    std::unordered_set<std::string> redundant;  // used to prevent redundancy of states when creating new macro states
+    bool exists_S;                              // used to check if S exists
+
+    std::vector<Product_state>::iterator prod_S; // product state S
+    std::pair<std::multimap<std::string, State *>::iterator,std::multimap<std::string, State *>::iterator> range1, range2;    // .equal_range()
+
+    Materialize_FA(automaton1);     // algorithm works only with explicit automatons
+    Materialize_FA(automaton2);
+    Epsilon_closure closures1, closures2;   // states of automaton1 and macro states are closed under epsilon transitions
+    bool epsilon1 = Has_epsilon(automaton1), epsilon2 = Has_epsilon(automaton2);
+    if(epsilon1) Epsilon_closures(automaton1, closures1);
+    if(epsilon2) Epsilon_closures(automaton2, closures2);
+    std::vector<State *> a1_states;         // states of automaton1 reached by a letter (closed)
+    std::vector<State *> a1_sources;        // closure of the state of the current product state
+
+    // algorithm is meant for automatons with same alphabets!!!
+    // following code picks a smaller alphabet (that will be used for computation) - error prevention
+    std::vector<std::string> alphabet;
+    if(automaton1.alphabet.size() < automaton2.alphabet.size())
+        alphabet = automaton1.alphabet;
+    else
+        alphabet = automaton2.alphabet;
+    //if(automaton1.alphabet != automaton2.alphabet) {throw Operation_error("Inclusion: alphabets are different!");}
+
+    // if a product state of p and start states is accepting -> automaton1 overlaps with complement of automaton2
+    // -> L(automaton1) (not)<= L(automaton2)
+    prod_st1.macro_st.states = automaton2.start_states;
+    if(epsilon2) Close_epsilon(closures2, prod_st1.macro_st.states);
+    prod_st1.macro_st.rejecting = true;
+    for(auto state = prod_st1.macro_st.states.begin(); state != prod_st1.macro_st.states.end(); ++state)
+    {
+        if((*state)->final_st) { prod_st1.macro_st.rejecting = false; break; }  // compute if macro state is rejecting
+    }
+
+    prod_st1.rejecting = true;              // if program does not end, product state must be rejecting for every start state from automaton1
+    Minimize(prod_st1.macro_st, preorder);  // minimize the macro state for initialization
+
+    a1_states = automaton1.start_states;
+    if(epsilon1) Close_epsilon(closures1, a1_states);
+    for(auto a1_state = a1_states.begin(); a1_state != a1_states.end(); ++a1_state)
+    {
+        if((*a1_state)->final_st && prod_st1.macro_st.rejecting) return false;  // if q from (q,I) is accepting and I is not accepting, return false
+        prod_st1.a1_st = *a1_state;
+        next.push_back(prod_st1);   // push product_state to next, later apply initialization
+    }
+
+    // initialize(next) part
+    for(auto p_state = next.begin(); p_state != next.end();)
+    {
+        // initialize(): condition (2)
+        auto m_state = p_state->macro_st.states.begin();
+        for(; m_state != p_state->macro_st.states.end(); ++m_state)
+            if(preorder.find({p_state->a1_st->name,(*m_state)->name}) != preorder.end()) break;   // found
+
+        if(m_state != p_state->macro_st.states.end())   // pair p<=q from (p,Q), q in Q, was found in preorder
+        {
+            p_state = next.erase(p_state);  // delete product state from next
+            continue;
+        }
+
+        // initialize(): condition (1)
+        for(auto p_state_2 = next.begin(); p_state_2 != next.end(); ++p_state_2)
+        {
+            if(p_state == p_state_2) continue;  // do not compare same elements
+            // (p,P),(q,Q) from next:               p <= q                           &&                         Q <= P
+            if( (preorder.find({p_state->a1_st->name,p_state_2->a1_st->name}) != preorder.end()) && Is_subset(p_state_2->macro_st, p_state->macro_st, preorder) )
+            {
+                p_state = next.erase(p_state);  // delete product state from next
+                --p_state;
+                break;
+            }
+        }
+        ++p_state;
+    }
+
+    // main loop
+    while(!next.empty())
+    {
+        prod_st1 = next.back();
+        next.pop_back();
+        processed.push_back(prod_st1);
+        STATS_INC(antichain_processed);
+        MEMORY_FOOTPRINT(antichains, Footprint_antichain(processed) + Footprint_antichain(next));
+        if(epsilon2) Close_epsilon(closures2, prod_st1.macro_st.states);    // states removed by Minimize are needed for Post
+        a1_sources = {prod_st1.a1_st};      // Post of the state of automaton1 is Post of its closure
+        if(epsilon1) Close_epsilon(closures1, a1_sources);
+
+        #ifdef INCLUSION_DEBUG
+            std::cout << "Inclusion - printing current product state: " << prod_st1.a1_st->name << ",";
+            Print_MacroState(prod_st1.macro_st);
+        #endif // INCLUSION_DEBUG
+
+        // get adjacent product states - for all a in alphabet
+        for(auto a = alphabet.begin(); a != alphabet.end(); ++a)
+        {
+            // getting Post(R) for specific letter *a
+            redundant.clear();
+            prod_st2.macro_st.states.clear();
+            prod_st2.macro_st.rejecting = true;
+            for(auto state = prod_st1.macro_st.states.begin(); state != prod_st1.macro_st.states.end(); ++state)
+            {
+                range1 = (*state)->transit_states_p.equal_range(*a);
+                for(auto next_st = range1.first; next_st != range1.second; ++next_st)
+                {
+                    if(redundant.insert(next_st->second->name).second)  // does not push redundant states - fast searching
+                    {
+                        prod_st2.macro_st.states.push_back(next_st->second);
+                        if(next_st->second->final_st) prod_st2.macro_st.rejecting = false;    // sets the rejecting flag
+                    }
+                }
+            }
+            if(epsilon2)
+            {
+                Close_epsilon(closures2, prod_st2.macro_st.states);
+                for(auto state = prod_st2.macro_st.states.begin(); state != prod_st2.macro_st.states.end() && prod_st2.macro_st.rejecting; ++state)
+                    prod_st2.macro_st.rejecting = !(*state)->final_st;
+            }
+
+            #ifdef INCLUSION_DEBUG
+                std::cout << "\tInclusion - printing new macro state (" << *a << ") before minimalization:\n\t\t";
+                Print_MacroState(prod_st2.macro_st);
+            #endif // INCLUSION_DEBUG
+
+            Minimize(prod_st2.macro_st, preorder);  // optimization 1(a), mozny problem - rejecting kontroluju pred minimalizaci a ne az po
+
+            #ifdef INCLUSION_DEBUG
+                std::cout << "\tInclusion - printing new macro state (" << *a << ") after minimalization:\n\t\t";
+                Print_MacroState(prod_st2.macro_st);
+            #endif // INCLUSION_DEBUG
+
+            // for all Post(r) for specific letter *a and macro state Post(R)
+            a1_states.clear();
+            for(auto source = a1_sources.begin(); source != a1_sources.end(); ++source)
+            {
+                range2 = (*source)->transit_states_p.equal_range(*a);
+                for(auto next_a1_st = range2.first; next_a1_st != range2.second; ++next_a1_st)
+                    a1_states.push_back(next_a1_st->second);
+            }
+            if(epsilon1)
+            {
+                std::sort(a1_states.begin(), a1_states.end());
+                a1_states.erase(std::unique(a1_states.begin(), a1_states.end()), a1_states.end());
+                Close_epsilon(closures1, a1_states);
+            }
+            for(auto next_a1_st = a1_states.begin(); next_a1_st != a1_states.end(); ++next_a1_st)
+            {
+                prod_st2.a1_st = *next_a1_st;
+                if((*next_a1_st)->final_st && prod_st2.macro_st.rejecting) return false;
+                //else prod_st2.rejecting = true;
+                // optimization 1(b)
+                auto p = prod_st2.macro_st.states.begin();
+                for(; p != prod_st2.macro_st.states.end(); ++p)
+                {
+                    if(preorder.find({prod_st2.a1_st->name,(*p)->name}) != preorder.end()) break;
+                }
+                if(p == prod_st2.macro_st.states.end())    // optimization 2
+                {
+                    // search in processed for (s,S) such that p <= s && S <= P
+                    exists_S = false;
+                    for(prod_S = processed.begin(); prod_S != processed.end(); ++prod_S)
+                    {
+                        if( (preorder.find({prod_st2.a1_st->name,prod_S->a1_st->name}) != preorder.end()) &&
+                            Is_subset(prod_S->macro_st, prod_st2.macro_st, preorder) )
+                        { exists_S = true; STATS_INC(antichain_pruned); break; }
+                    }
+                    if(!exists_S)   // if not found yet
+                    {
+                        // search in next for (s,S) such that p <= s && S <= P
+                        for(prod_S = next.begin(); prod_S != next.end(); ++prod_S)
+                        {
+                            if( (preorder.find({prod_st2.a1_st->name,prod_S->a1_st->name}) != preorder.end()) &&
+                                 Is_subset(prod_S->macro_st, prod_st2.macro_st, preorder) )
+                            { exists_S = true; STATS_INC(antichain_pruned); break; }
+                        }
+                    }
+                    // if no such (s,S) was found
+                    if(!exists_S)
+                    {
+                        // remove all (s,S) from processed such that s <= p && P <= S
+                        for(prod_S = processed.begin(); prod_S != processed.end();)
+                        {
+                            if( (preorder.find({prod_S->a1_st->name,prod_st2.a1_st->name}) != preorder.end()) &&
+                                 Is_subset(prod_st2.macro_st, prod_S->macro_st, preorder))
+                            {
+                                prod_S = processed.erase(prod_S);
+                                STATS_INC(antichain_removed);
+                            }
+                            else ++prod_S;
+                        }
+                        // remove all (s,S) from next such that s <= p && P <= S
+                        for(prod_S = next.begin(); prod_S != next.end();)
+                        {
+                            if( (preorder.find({prod_S->a1_st->name,prod_st2.a1_st->name}) != preorder.end()) &&
+                                 Is_subset(prod_st2.macro_st, prod_S->macro_st, preorder))
+                            {
+                                prod_S = next.erase(prod_S);
+                                STATS_INC(antichain_removed);
+                            }
+                            else ++prod_S;
+                        }
+                        // add (p,P) to next
+                        next.push_back(prod_st2);
+                        #ifdef INCLUSION_DEBUG
+                            std::cout << "\tInclusion - pushing (into next) product state " << prod_st2.a1_st->name << ",";
+                            Print_MacroState(prod_st2.macro_st);
+                        #endif // INCLUSION_DEBUG
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------- EQUIVALENCE -----------------------------------------
+
+// Function finds or creates the node of the macro state of the nondeterministic automaton.
+// input: automaton - reference to lazy DFA
+// input: states - states of the macro state, ordered and without duplicates
+// returns: node of the macro state
+std::size_t Lazy_node(Lazy_DFA &automaton, std::vector<State *> &states)
+{
+    auto found = automaton.index.find(states);
+    if(found != automaton.index.end()) return found->second;
+    STATS_INC(equivalence_macro_states);
+    automaton.index.insert({states, automaton.macros.size()});
+    automaton.macros.push_back(states);
+    automaton.element.push_back(SIZE_MAX);
+    return automaton.macros.size() - 1;
+}
+
+// Function prepares the automaton for Equivalence algorithm. A nondeterministic automaton with an accepting implicit sink
+// is materialized (the sink would be a part of macro states), a rejecting sink is left out of macro states. Macro states
+// of an automaton with epsilon transitions are closed (Epsilon_closures).
+// input: automaton1 - reference to FA
+// input: letters - reference to common alphabet of both automatons (ordered)
+// input: automaton - reference to lazy DFA (output)
+// returns: start node
+std::size_t Prepare_lazy_DFA(FA &automaton1, const std::vector<std::string> &letters, Lazy_DFA &automaton)
+{
+    automaton.deterministic = Is_deterministic(automaton1);
+    if(!automaton.deterministic && Is_sink_final(automaton1)) Materialize_FA(automaton1);
+    for(auto a = letters.begin(); a != letters.end(); ++a)
+        automaton.own.push_back(std::find(automaton1.alphabet.begin(), automaton1.alphabet.end(), *a) != automaton1.alphabet.end());
+
+    if(automaton.deterministic)
+    {
+        for(auto st = automaton1.states.begin(); st != automaton1.states.end(); ++st)
+            automaton.states.push_back(&(*st));     // index of a state is its State::id
+        automaton.element.assign(automaton.states.size() + 2, SIZE_MAX);
+        return automaton1.start_states.empty() ? automaton.states.size() + 1 : automaton1.start_states.front()->id;
+    }
+    std::vector<State *> start;
+    automaton.epsilon = Has_epsilon(automaton1);
+    if(automaton.epsilon) Epsilon_closures(automaton1, automaton.closures);
+    for(auto st = automaton1.start_states.begin(); st != automaton1.start_states.end(); ++st)
+        if((*st)->flag != -1) start.push_back(*st);
+    std::sort(start.begin(), start.end());
+    start.erase(std::unique(start.begin(), start.end()), start.end());
+    if(automaton.epsilon) Close_epsilon(automaton.closures, start);
+    return Lazy_node(automaton, start);
+}
+
+// Function returns the successor of the node under the letter, macro states of an NFA are created on demand.
+// Letters out of the alphabet of the automaton lead to the dead state.
+// input: automaton1 - reference to FA
+// input: automaton - reference to lazy DFA of the automaton
+// input: node - node of the lazy DFA
+// input: letters - reference to common alphabet
+// input: letter - index of the letter in the common alphabet
+// returns: successor node
+std::size_t Lazy_post(const FA &automaton1, Lazy_DFA &automaton, std::size_t node, const std::vector<std::string> &letters, std::size_t letter)
+{
+    if(automaton.deterministic)
+    {
+        std::size_t sink = automaton.states.size(), dead = sink + 1;
+        if(node == dead || !automaton.own[letter]) return dead;
+        if(node == sink) return sink;
+        auto next = automaton.states[node]->transit_states_p.find(letters[letter]);
+        if(next == automaton.states[node]->transit_states_p.end() || next->second->flag == -1) return automaton1.sink ? sink : dead;
+        return next->second->id;
+    }
+    std::vector<State *> post;
+    if(automaton.own[letter])
+        for(auto st = automaton.macros[node].begin(); st != automaton.macros[node].end(); ++st)
+        {
+            auto range = (*st)->transit_states_p.equal_range(letters[letter]);
+            for(auto next = range.first; next != range.second; ++next)
+                if(next->second->flag != -1) post.push_back(next->second);
+        }
+    std::sort(post.begin(), post.end());
+    post.erase(std::unique(post.begin(), post.end()), post.end());
+    if(automaton.epsilon) Close_epsilon(automaton.closures, post);     // the same set is always closed to the same order
+    return Lazy_node(automaton, post);
+}
+
+// Function returns true if the node of the lazy DFA is accepting.
+// input: automaton1 - reference to FA
+// input: automaton - reference to lazy DFA of the automaton
+// input: node - node of the lazy DFA
+// returns: true - node is accepting
+bool Lazy_final(const FA &automaton1, const Lazy_DFA &automaton, std::size_t node)
+{
+    if(automaton.deterministic)
+    {
+        if(node < automaton.states.size()) return Is_final(automaton1, automaton.states[node]);
+        return node == automaton.states.size() && Is_sink_final(automaton1);
+    }
+    for(auto st = automaton.macros[node].begin(); st != automaton.macros[node].end(); ++st)
+        if(Is_final(automaton1, *st)) return true;
+    return false;
+}
+
+// Function implements the Hopcroft-Karp algorithm - checks if L(automaton1) = L(automaton2). Pairs of nodes of both
+// automatons are merged by union-find starting with the start nodes, successors of every merged pair under every letter
+// are merged too, the languages differ iff some merged pair has one accepting and one rejecting node. DFAs are used
+// directly (near-linear in the number of states), NFAs are determinized on the fly - only reached macro states are created.
+// Pairs are processed in breadth-first order, so the distinguishing word is short.
+// input: automaton1 - reference to first automaton (an NFA with an accepting implicit sink is materialized)
+// input: automaton2 - reference to second automaton
+// input: word - pointer to vector of letters (output), a word accepted by exactly one of the automatons, nullptr -> not needed
+// returns: true if the languages are equal, false otherwise
+bool Equivalence_FA(FA &automaton1, FA &automaton2, std::vector<std::string> *word)
+{
+    std::vector<std::string> letters = automaton1.alphabet;     // common alphabet
+    Lazy_DFA lazy1, lazy2;
+    Union_find classes;
+    std::vector<Equivalence_pair> pairs;
+
+    letters.insert(letters.end(), automaton2.alphabet.begin(), automaton2.alphabet.end());
+    std::sort(letters.begin(), letters.end());
+    letters.erase(std::unique(letters.begin(), letters.end()), letters.end());
+    std::size_t start1 = Prepare_lazy_DFA(automaton1, letters, lazy1);
+    std::size_t start2 = Prepare_lazy_DFA(automaton2, letters, lazy2);
+
+    // element of the union-find structure of the node, nodes of both automatons share the structure
+    auto element = [&](Lazy_DFA &automaton, std::size_t node)
+    {
+        if(automaton.element[node] == SIZE_MAX)
+        {
+            automaton.element[node] = classes.parent.size();
+            classes.parent.push_back(classes.parent.size());
+        }
+        return classes.find(automaton.element[node]);
+    };
+
+    classes.parent.push_back(0);
+    classes.parent.push_back(1);
+    lazy1.element[start1] = 0;
+    lazy2.element[start2] = 1;
+    classes.parent[1] = 0;
+    pairs.push_back({start1, start2, SIZE_MAX, 0});
+    STATS_INC(equivalence_pairs);
+
+    for(std::size_t i = 0; i < pairs.size(); ++i)
+    {
+        if(Lazy_final(automaton1, lazy1, pairs[i].first) != Lazy_final(automaton2, lazy2, pairs[i].second))
+        {
+            if(word != nullptr)
+            {
+                word->clear();
+                for(std::size_t j = i; pairs[j].parent != SIZE_MAX; j = pairs[j].parent)
+                    word->push_back(letters[pairs[j].letter]);
+                std::reverse(word->begin(), word->end());
+            }
+            return false;
+        }
+        for(std::size_t a = 0; a < letters.size(); ++a)
+        {
+            std::size_t next1 = Lazy_post(automaton1, lazy1, pairs[i].first, letters, a);
+            std::size_t next2 = Lazy_post(automaton2, lazy2, pairs[i].second, letters, a);
+            std::size_t root1 = element(lazy1, next1), root2 = element(lazy2, next2);
+            if(root1 == root2) continue;
+            classes.parent[root1] = root2;
+            pairs.push_back({next1, next2, i, a});
+            STATS_INC(equivalence_pairs);
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------- ADDITIONAL FUNCTIONS -----------------------------------------
+
+// Function generates the identity relation from states of automaton. It can be used for special versions of universality and inclusion checking.
+// input: automaton - reference to source automaton
+// input: preorder - reference to result identity relation
+// returns: void
+void Get_identity_relation(const FA &automaton, std::unordered_set<std::pair<std::string,std::string>, pair_hash> &preorder)
+{
+    for(auto state = automaton.states.begin(); state != automaton.states.end(); ++state)
+        preorder.insert({state->name,state->name});
+}
+
+// Function appends a copy of all states and transitions of source automaton to result automaton. Every transition is copied
+// by the index of its target (State::id, the position in the list) - no searching by names or addresses. The source is only
+// read, so one automaton can be copied by several threads at once.
+// Transitions are inserted in their sorted order with a hint, which makes the copy a single linear pass.
+// input: automaton1 - reference to source automaton
+// input: result_automaton - reference to result automaton, copied states are appended to its list of states
+// returns: vector of pointers to the copied states, index is the position of the original state in its list
+std::vector<State *> Append_FA(const FA &automaton1, FA &result_automaton)
+{
+    std::vector<State *> copied;
+    State st;
+
+    copied.reserve(automaton1.states.size());
+
+    // first pass - create copies of the states
+    for(auto s = automaton1.states.begin(); s != automaton1.states.end(); ++s)
+    {
+        st.name = s->name;
+        st.start_st = s->start_st;
+        st.final_st = s->final_st;
+        st.flag = 0;
+        st.visited = false;
+        st.id = result_automaton.states.size();
+        result_automaton.states.push_back(st);
+        copied.push_back(&result_automaton.states.back());
+        if(st.start_st) result_automaton.start_states.push_back(copied.back());
+        if(st.final_st) result_automaton.final_states.insert(copied.back());
+    }
+
+    // second pass - copy transitions, the copy of the target of a transition is found by its index
+    auto c = copied.begin();
+    for(auto s = automaton1.states.begin(); s != automaton1.states.end(); ++s, ++c)
+    {
+        for(auto const& x : s->transit_states_p)
+            (*c)->transit_states_p.emplace_hint((*c)->transit_states_p.end(), x.first, copied[x.second->id]);
+        (*c)->epsilon_p.reserve(s->epsilon_p.size());
+        for(auto target = s->epsilon_p.begin(); target != s->epsilon_p.end(); ++target)
+            (*c)->epsilon_p.push_back(copied[(*target)->id]);
+    }
+    return copied;
+}
+
+// Function implements the Union algorithm. Computes automaton1 union automaton2. States of the second automaton follow
+// the states of the first one (Append_FA copies them by State::id) and stay distinct even when the names are the same -
+// such states of the second automaton get the "_copy" suffix.
+// input: automaton1 - reference to first automaton
+// input: automaton2 - reference to second automaton, clashing state names get the "_copy" suffix too (name-keyed preorders)
+// input: result_automaton - reference to result automaton, used to save result
+// returns: void
+void Union_FA(FA &automaton1, FA &automaton2, FA &result_automaton)
+{
+    std::unordered_set<std::string> opt_s;
+    std::vector<State *> copied;
+
+    Materialize_FA(automaton1);     // algorithm works only with explicit automatons
+    Materialize_FA(automaton2);
+
+    //if(automaton1.alphabet != automaton2.alphabet) {throw Operation_error("Union: alphabets are different!");}
+    if(automaton1.alphabet.size() > automaton2.alphabet.size())
+        result_automaton.alphabet = automaton1.alphabet;
+    else
+        result_automaton.alphabet = automaton2.alphabet;
+
+    // building a new automaton that will be returned
+    result_automaton.name = automaton1.name + "+" + automaton2.name;
+
+    // copy states and transitions of both automatons
+    Append_FA(automaton1, result_automaton);
+    copied = Append_FA(automaton2, result_automaton);
+
+    // rename states of the second automaton that have the same name as a state of the first automaton
+    for(auto s = automaton1.states.begin(); s != automaton1.states.end(); ++s)
+        opt_s.insert(s->name);
+    auto c = copied.begin();
+    for(auto s = automaton2.states.begin(); s != automaton2.states.end(); ++s, ++c)
+    {
+        if(opt_s.find(s->name) != opt_s.end())
+        {
+            s->name = s->name + "_copy";
+            (*c)->name = s->name;
+        }
+    }
+    MEMORY_FOOTPRINT(result_states, Footprint_FA(result_automaton));
+}
+
+// Copy constructor of the automaton. Creates a deep copy, pointers of the copy lead into the copy.
+fa::fa(const fa &other) : name(other.name), alphabet(other.alphabet), transitions(other.transitions),
+                          negated(other.negated), sink(other.sink)
+{
+    Append_FA(other, *this);
+}
+
+// Copy assignment of the automaton. Creates a deep copy, pointers of the copy lead into the copy.
+fa &fa::operator=(const fa &other)
+{
+    if(this != &other)
+    {
+        FA copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+// Function implements Copy algorithm. Creates a copy of source automaton.
+// input: automaton1 - reference to source automaton
+// returns: A copy of a source automaton.
+FA Copy_FA(const FA &automaton1)
+{
+    return FA(automaton1);
+}
+
+// Function creates a complement of a source automaton. It does not create a new automaton, it only negates acceptance
+// of the automaton (FA::negated). The result is a complement only for a complete DFA (see Determinization_FA).
+// input: automaton1 - reference to source automaton
+// returns: void
+void Complement_FA(FA &automaton1)
+{
+    automaton1.negated = !automaton1.negated;
+}
+
+// ---------------------------------------- RANDOM AUTOMATA -----------------------------------------
+
+// Function chooses count distinct numbers from 0..range-1 (Floyd's algorithm). Modulo of the generator is used
+// instead of std::uniform_int_distribution, so the same seed gives the same automaton with every standard library.
+// input: rng - reference to random generator
+// input: count - number of chosen numbers (count <= range)
+// input: range - upper bound (exclusive)
+// returns: sorted vector of chosen numbers
+std::vector<std::uint64_t> Sample_distinct(std::mt19937_64 &rng, std::uint64_t count, std::uint64_t range)
+{
+    std::unordered_set<std::uint64_t> chosen;
+    for(std::uint64_t j = range - count; j < range; ++j)
+    {
+        std::uint64_t t = rng() % (j + 1);
+        if(!chosen.insert(t).second) chosen.insert(j);
+    }
+    std::vector<std::uint64_t> result(chosen.begin(), chosen.end());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// Function generates random automaton in the Tabakov-Vardi model. State q0 is the only start state, for every letter
+// round(density * states) distinct transitions are chosen uniformly and round(final_density * states) states
+// are final (at least one).
+// input: result_automaton - reference to FA, the automaton is replaced
+// input: config - reference to parameters of the generator
+// returns: void
+void Generate_FA(FA &result_automaton, const Random_config &config)
+{
+    std::mt19937_64 rng(config.seed);
+    std::vector<State *> index;    // states by number
+    std::uint64_t n = config.states;
+
+    result_automaton = FA();
+    result_automaton.name = "R" + std::to_string(config.states) + "_" + std::to_string(config.seed);
+    for(long a = 0; a < config.alphabet; ++a)
+        result_automaton.alphabet.push_back("a" + std::to_string(a));
+    std::sort(result_automaton.alphabet.begin(), result_automaton.alphabet.end());
+
+    for(std::uint64_t i = 0; i < n; ++i)
+    {
+        State st;
+        st.name = "q" + std::to_string(i);
+        st.visited = false;
+        st.start_st = false;
+        st.final_st = false;
+        st.flag = 0;
+        st.id = result_automaton.states.size();
+        result_automaton.states.push_back(st);
+        index.push_back(&result_automaton.states.back());
+    }
+    index[0]->start_st = true;
+    result_automaton.start_states.push_back(index[0]);
+
+    std::uint64_t finals = std::min(n, std::max<std::uint64_t>(1, std::llround(config.final_density * n)));
+    for(auto f : Sample_distinct(rng, finals, n))
+    {
+        index[f]->final_st = true;
+        result_automaton.final_states.insert(index[f]);
+    }
+
+    // transitions are numbered p * n + q
+    std::uint64_t per_letter = std::min(n * n, (std::uint64_t)std::llround(config.density * n));
+    for(auto a = result_automaton.alphabet.begin(); a != result_automaton.alphabet.end(); ++a)
+    {
+        for(auto t : Sample_distinct(rng, per_letter, n * n))
+        {
+            index[t / n]->transit_states_p.insert({*a, index[t % n]});
+        }
+    }
+}
+
+// ---------------------------------------- PROPERTIES -----------------------------------------
+
+// Function returns number of states of the automaton (deleted states are not counted, implicit sink is counted).
+// input: automaton - reference to FA
+// returns: number of states
+long Count_states(const FA &automaton)
+{
+    long count = automaton.sink ? 1 : 0;
+    for(auto j = automaton.states.begin(); j != automaton.states.end(); ++j)
+        if(j->flag != -1) ++count;
+    return count;
+}
+
+// Function returns number of explicit transitions of the automaton.
+// input: automaton - reference to FA
+// returns: number of transitions
+long Count_transitions(const FA &automaton)
+{
+    long count = 0;
+    for(auto j = automaton.states.begin(); j != automaton.states.end(); ++j)
+        count += j->transit_states_p.size() + j->epsilon_p.size();
+    return count;
+}
+
+// Function returns true if the automaton is deterministic (one start state, at most one transition for every letter).
+// input: automaton - reference to FA
+// returns: true - automaton is a DFA
+bool Is_deterministic(const FA &automaton)
+{
+    if(automaton.start_states.size() > 1 || Has_epsilon(automaton)) return false;
+    for(auto i = automaton.states.begin(); i != automaton.states.end(); ++i)
+        for(auto j = i->transit_states_p.begin(); j != i->transit_states_p.end(); j = i->transit_states_p.upper_bound(j->first))
+            if(i->transit_states_p.count(j->first) > 1) return false;
+    return true;
+}
+
+// Function returns true if the word is accepted by the DFA.
+// input: automaton - reference to DFA
+// input: word - symbols of the word
+// returns: true - word is accepted
+bool Member_DFA(const FA &automaton, const std::vector<std::string> &word)
+{
+    if(automaton.start_states.empty()) return false;
+    State *state = automaton.start_states.front();
+    for(auto a = word.begin(); a != word.end(); ++a)
+    {
+        auto next = state->transit_states_p.find(*a);
+        if(next == state->transit_states_p.end())   // missing transition leads to the implicit sink
+            return Is_sink_final(automaton) && std::find(automaton.alphabet.begin(), automaton.alphabet.end(), *a) != automaton.alphabet.end();
+        state = next->second;
+    }
+    return Is_final(automaton, state);
+}
+
+// ---------------------------------------- MEMBERSHIP -----------------------------------------
+
+// Function compiles the automaton for membership (see Bit_NFA) - states get bit indexes, the implicit sink state is
+// the last one, successors of every state under every letter become a bit mask (or a list of indexes if the masks
+// would not fit into Bit_NFA::dense_limit), automatons with at most 64 states also get byte tables.
+// input: automaton - reference to FA (NFA or DFA, deleted states are skipped)
+// input: result - reference to compiled automaton (output)
+// returns: void
+void Compile_bit_NFA(const FA &automaton, Bit_NFA &result)
+{
+    std::vector<const State *> states;
+    result = Bit_NFA();
+    for(auto st = automaton.states.begin(); st != automaton.states.end(); ++st)
+        if(st->flag != -1) states.push_back(&(*st));    // deleted states keep their index, no bit is ever set for them
+    std::size_t sink = automaton.states.size();   // index of the implicit sink state
+    result.states = sink + (automaton.sink ? 1 : 0);
+    result.words = (result.states + 63) / 64;
+    for(auto a = automaton.alphabet.begin(); a != automaton.alphabet.end(); ++a)
+        result.letters.insert({*a, result.letters.size()});
+
+    // epsilon transitions are compiled into the masks - the start set and every successor set are closed
+    Epsilon_closure closures;
+    bool epsilon = Has_epsilon(automaton);
+    if(epsilon) Epsilon_closures(automaton, closures);     // indexed by State::id too
+    auto close = [&](std::vector<std::uint32_t> &ids)
+    {
+        std::vector<State *> set;
+        bool with_sink = false;
+        for(auto q = ids.begin(); q != ids.end(); ++q)
+            if(*q == sink) with_sink = true;
+            else set.push_back(closures.states[*q]);
+        Close_epsilon(closures, set);
+        ids.clear();
+        for(auto q = set.begin(); q != set.end(); ++q)
+            ids.push_back((*q)->id);
+        if(with_sink) ids.push_back(sink);
+    };
+
+    auto set_bit = [](std::vector<std::uint64_t> &set, std::size_t offset, std::size_t q) { set[offset + q / 64] |= 1ULL << (q % 64); };
+    result.initial.assign(result.words, 0);
+    result.final.assign(result.words, 0);
+    std::vector<std::uint32_t> initial;
+    for(auto st = automaton.start_states.begin(); st != automaton.start_states.end(); ++st)
+        if((*st)->flag != -1) initial.push_back((*st)->id);
+    if(epsilon) close(initial);
+    for(auto q = initial.begin(); q != initial.end(); ++q)
+        set_bit(result.initial, 0, *q);
+    for(auto st = states.begin(); st != states.end(); ++st)
+        if(Is_final(automaton, *st)) set_bit(result.final, 0, (*st)->id);
+    if(Is_sink_final(automaton)) set_bit(result.final, 0, sink);
+
+    // successors of (letter, state) in the order of the rows
+    std::vector<std::vector<std::uint32_t>> successors(result.letters.size() * result.states);
+    for(auto st = states.begin(); st != states.end(); ++st)
+    {
+        for(auto t = (*st)->transit_states_p.begin(); t != (*st)->transit_states_p.end(); ++t)
+        {
+            auto letter = result.letters.find(t->first);
+            if(letter != result.letters.end() && t->second->flag != -1)
+                successors[letter->second * result.states + (*st)->id].push_back(t->second->id);
+        }
+        if(automaton.sink)  // missing transitions lead to the implicit sink state
+            for(auto letter = result.letters.begin(); letter != result.letters.end(); ++letter)
+                if((*st)->transit_states_p.find(letter->first) == (*st)->transit_states_p.end())
+                    successors[letter->second * result.states + (*st)->id].push_back(sink);
+    }
+    if(automaton.sink)
+        for(std::size_t letter = 0; letter < result.letters.size(); ++letter)
+            successors[letter * result.states + sink].push_back(sink);
+    if(epsilon)
+        for(auto row = successors.begin(); row != successors.end(); ++row)
+            close(*row);
+
+    if(successors.size() * result.words <= Bit_NFA::dense_limit)
+    {
+        result.post.assign(successors.size() * result.words, 0);
+        for(std::size_t row = 0; row < successors.size(); ++row)
+            for(auto q = successors[row].begin(); q != successors[row].end(); ++q)
+                set_bit(result.post, row * result.words, *q);
+    }
+    else
+    {
+        result.offsets.push_back(0);
+        for(auto row = successors.begin(); row != successors.end(); ++row)
+        {
+            result.targets.insert(result.targets.end(), row->begin(), row->end());
+            result.offsets.push_back(result.targets.size());
+        }
+    }
+
+    // byte tables - union of successors of all states of a byte of the set, built from the table without the lowest bit
+    if(result.states <= 64)
+    {
+        std::size_t bytes = (result.states + 7) / 8;
+        result.tables.assign(result.letters.size() * bytes * 256, 0);
+        for(std::size_t letter = 0; letter < result.letters.size(); ++letter)
+            for(std::size_t b = 0; b < bytes; ++b)
+            {
+                std::uint64_t *table = &result.tables[(letter * bytes + b) * 256];
+                for(std::size_t v = 1; v < 256; ++v)
+                {
+                    std::size_t q = b * 8 + __builtin_ctzll(v);
+                    table[v] = table[v & (v - 1)] | (q < result.states ? result.post[letter * result.states + q] : 0);
+                }
+            }
+    }
+}
+
+// Function computes successors of a set of states of a compiled automaton with at most 64 states.
+// input: automaton - reference to compiled automaton
+// input: letter - index of the letter
+// input: set - set of states
+// returns: set of successors
+inline std::uint64_t Bit_step(const Bit_NFA &automaton, std::size_t letter, std::uint64_t set)
+{
+    std::size_t bytes = (automaton.states + 7) / 8;
+    const std::uint64_t *table = &automaton.tables[letter * bytes * 256];
+    std::uint64_t next = 0;
+    for(std::size_t b = 0; b < bytes; ++b, set >>= 8, table += 256)
+        next |= table[set & 0xff];
+    return next;
+}
+
+// Function computes successors of a set of states of a compiled automaton (any number of states). Rows of the set bits
+// are joined by OR of whole words (vectorized by the compiler), sparse automatons set the bits of the successors.
+// input: automaton - reference to compiled automaton
+// input: letter - index of the letter
+// input: set - reference to set of states
+// input: next - reference to set of successors (output)
+// returns: void
+void Bit_step(const Bit_NFA &automaton, std::size_t letter, const std::vector<std::uint64_t> &set, std::vector<std::uint64_t> &next)
+{
+    std::fill(next.begin(), next.end(), 0);
+    for(std::size_t k = 0; k < automaton.words; ++k)
+    {
+        for(std::uint64_t bits = set[k]; bits != 0; bits &= bits - 1)
+        {
+            std::size_t row = letter * automaton.states + k * 64 + __builtin_ctzll(bits);
+            if(!automaton.post.empty())
+            {
+                const std::uint64_t *mask = &automaton.post[row * automaton.words];
+                for(std::size_t j = 0; j < automaton.words; ++j)
+                    next[j] |= mask[j];
+            }
+            else
+                for(std::size_t t = automaton.offsets[row]; t < automaton.offsets[row + 1]; ++t)
+                    next[automaton.targets[t] / 64] |= 1ULL << (automaton.targets[t] % 64);
+        }
+    }
+}
+
+// Function translates letters of the word to indexes of the compiled automaton.
+// input: automaton - reference to compiled automaton
+// input: word - reference to the word
+// input: coded - reference to indexes of the letters (output)
+// returns: false if the word contains a letter out of the alphabet (the word is not accepted)
+bool Code_word(const Bit_NFA &automaton, const std::vector<std::string> &word, std::vector<std::size_t> &coded)
+{
+    coded.clear();
+    for(auto a = word.begin(); a != word.end(); ++a)
+    {
+        auto letter = automaton.letters.find(*a);
+        if(letter == automaton.letters.end()) return false;
+        coded.push_back(letter->second);
+    }
+    return true;
+}
+
+// Function checks membership of the word in the language of a compiled automaton, the automaton is simulated on the
+// set of current states, no determinization is needed.
+// input: automaton - reference to compiled automaton (Compile_bit_NFA)
+// input: word - reference to the word
+// returns: true - word is accepted
+bool Member_NFA(const Bit_NFA &automaton, const std::vector<std::string> &word)
+{
+    std::vector<std::size_t> coded;
+    if(!Code_word(automaton, word, coded)) return false;
+    std::vector<std::uint64_t> set = automaton.initial, next(automaton.words);
+    for(auto letter = coded.begin(); letter != coded.end(); ++letter)
+    {
+        Bit_step(automaton, *letter, set, next);
+        set.swap(next);
+    }
+    for(std::size_t k = 0; k < automaton.words; ++k)
+        if(set[k] & automaton.final[k]) return true;
+    return false;
+}
+
+// Function codes letters of many words into one buffer of letter indexes of the compiled automaton.
+// input: automaton - reference to compiled automaton (Compile_bit_NFA)
+// input: words - reference to the words
+// input: coded - reference to coded words (output)
+// returns: void
+void Code_words(const Bit_NFA &automaton, const std::vector<std::vector<std::string>> &words, Coded_words &coded)
+{
+    coded.letters.clear();
+    coded.begin.assign(1, 0);
+    for(auto word = words.begin(); word != words.end(); ++word)
+    {
+        for(auto a = word->begin(); a != word->end(); ++a)
+        {
+            auto letter = automaton.letters.find(*a);
+            coded.letters.push_back(letter == automaton.letters.end() ? Coded_words::unknown : letter->second);
+        }
+        coded.begin.push_back(coded.letters.size());
+    }
+}
+
+// Function checks membership of many coded words in one pass. Automatons with at most 64 states simulate
+// Bit_NFA::lanes words at once - their independent steps are interleaved, so the latencies of the table lookups overlap.
+// input: automaton - reference to compiled automaton (Compile_bit_NFA)
+// input: coded - reference to the words coded by Code_words
+// input: accepted - reference to results, accepted[i] -> word i is accepted (output)
+// returns: void
+void Member_batch(const Bit_NFA &automaton, const Coded_words &coded, std::vector<bool> &accepted)
+{
+    std::size_t count = coded.begin.size() - 1;     // number of words
+    const std::uint32_t *letters = coded.letters.data();
+    const std::size_t *begin = coded.begin.data();
+    auto known = [&](std::size_t i) { return std::find(letters + begin[i], letters + begin[i + 1], Coded_words::unknown) == letters + begin[i + 1]; };
+    accepted.assign(count, false);
+
+    if(automaton.states > 64)
+    {
+        std::vector<std::uint64_t> set(automaton.words), next(automaton.words);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            if(!known(i)) continue;
+            set = automaton.initial;
+            for(std::size_t letter = begin[i]; letter < begin[i + 1]; ++letter)
+            {
+                Bit_step(automaton, letters[letter], set, next);
+                set.swap(next);
+            }
+            for(std::size_t k = 0; k < automaton.words && !accepted[i]; ++k)
+                accepted[i] = (set[k] & automaton.final[k]) != 0;
+        }
+        return;
+    }
+
+    std::uint64_t initial = automaton.initial.empty() ? 0 : automaton.initial[0];
+    std::uint64_t final = automaton.final.empty() ? 0 : automaton.final[0];
+    for(std::size_t first = 0; first < count; first += Bit_NFA::lanes)
+    {
+        std::size_t lanes = std::min(Bit_NFA::lanes, count - first);
+        std::uint64_t set[Bit_NFA::lanes];
+        std::size_t length = 0;
+        for(std::size_t l = 0; l < lanes; ++l)
+        {
+            set[l] = known(first + l) ? initial : 0;
+            length = std::max(length, begin[first + l + 1] - begin[first + l]);
+        }
+        for(std::size_t i = 0; i < length; ++i)
+            for(std::size_t l = 0; l < lanes; ++l)
+            {
+                std::size_t letter = begin[first + l] + i;
+                if(letter < begin[first + l + 1] && set[l] != 0) set[l] = Bit_step(automaton, letters[letter], set[l]);
+            }
+        for(std::size_t l = 0; l < lanes; ++l)
+            accepted[first + l] = (set[l] & final) != 0;
+    }
+}
+
+// Function checks membership of many words in one pass (see Code_words and the coded version).
+// input: automaton - reference to compiled automaton (Compile_bit_NFA)
+// input: words - reference to the words
+// input: accepted - reference to results, accepted[i] -> words[i] is accepted (output)
+// returns: void
+void Member_batch(const Bit_NFA &automaton, const std::vector<std::vector<std::string>> &words, std::vector<bool> &accepted)
+{
+    Coded_words coded;
+    Code_words(automaton, words, coded);
+    Member_batch(automaton, coded, accepted);
+}
+
+// ---------------------------------------- MATCHER EXPORT -----------------------------------------
+
+// Function emits a self-contained C++ header with a matcher of the deterministic automaton - constexpr tables
+// (symbol of every input byte, transitions, accepting states) and an inline function match(const uint8_t*, size_t).
+// Letters of one character are matched as that character, otherwise byte i of the input is the letter symbols[i].
+// Small automatons get a switch-based state machine, larger ones a table without branches in the loop (missing
+// transitions and bytes out of the alphabet lead to a dead state with self-loops).
+// input: automaton - reference to DFA (at most one start state, implicit sink and negation are respected)
+// input: name - name of the namespace of the matcher (sanitized to an identifier)
+// input: out - reference to output buffer
+// returns: void, throws Operation_error for a nondeterministic automaton or too many letters
+void Export_matcher(const FA &automaton, const std::string &name, Output_buffer &out)
+{
+    std::vector<const State *> states;
+    std::string id, guard;
+
+    if(!Is_deterministic(automaton)) throw Operation_error("Export: automaton is not deterministic!");
+    bool characters = std::all_of(automaton.alphabet.begin(), automaton.alphabet.end(), [](const std::string &a) { return a.size() == 1; });
+    if(automaton.alphabet.size() > 256) throw Operation_error("Export: more than 256 letters!");
+
+    for(auto c = name.begin(); c != name.end(); ++c)
+        id += std::isalnum((unsigned char)*c) ? *c : '_';
+    if(id.empty() || std::isdigit((unsigned char)id[0])) id = "dfa_" + id;
+    for(auto c = id.begin(); c != id.end(); ++c)
+        guard += std::toupper((unsigned char)*c);
+    guard += "_MATCHER_H";
+
+    std::vector<std::size_t> index(automaton.states.size());     // State::id -> row, deleted states have no row
+    for(auto st = automaton.states.begin(); st != automaton.states.end(); ++st)
+    {
+        if(st->flag == -1) continue;    // deleted state
+        index[st->id] = states.size();
+        states.push_back(&(*st));
+    }
+    std::size_t sink = states.size();                       // accepting implicit sink - a real state
+    std::size_t dead = sink + (Is_sink_final(automaton) ? 1 : 0);   // rejects the rest of the input
+    std::size_t rows = dead + 1;
+    std::size_t symbols = automaton.alphabet.size();
+    std::size_t start = dead;
+    for(auto st = automaton.start_states.begin(); st != automaton.start_states.end(); ++st)
+        if((*st)->flag != -1) start = index[(*st)->id];
+
+    // table[state * (symbols + 1) + symbol], column symbols is a byte out of the alphabet
+    std::vector<std::size_t> table(rows * (symbols + 1), dead);
+    std::vector<bool> accepting(rows, false);
+    for(auto st = states.begin(); st != states.end(); ++st)
+    {
+        accepting[index[(*st)->id]] = Is_final(automaton, *st);
+        for(std::size_t a = 0; a < symbols; ++a)
+        {
+            auto next = (*st)->transit_states_p.find(automaton.alphabet[a]);
+            if(next != (*st)->transit_states_p.end() && next->second->flag != -1) table[index[(*st)->id] * (symbols + 1) + a] = index[next->second->id];
+            else if(automaton.sink) table[index[(*st)->id] * (symbols + 1) + a] = Is_sink_final(automaton) ? sink : dead;
+        }
+    }
+    if(dead != sink)
+    {
+        accepting[sink] = true;
+        for(std::size_t a = 0; a < symbols; ++a)
+            table[sink * (symbols + 1) + a] = sink;
+    }
+    auto byte_of = [&](std::size_t a) -> std::uint64_t { return characters ? (unsigned char)automaton.alphabet[a][0] : a; };
+    const char *state_type = rows <= 256 ? "std::uint8_t" : (rows <= 65536 ? "std::uint16_t" : "std::uint32_t");
+
+    out << "// Matcher of the automaton " << automaton.name << " (" << (std::uint64_t)rows << " states, " << (std::uint64_t)symbols
+        << " symbols), generated by bakalarka.\n";
+    out << (characters ? "// Letters of the automaton are characters of the input.\n" : "// Byte i of the input is the letter symbols[i].\n");
+    out << "#ifndef " << guard << "\n#define " << guard << "\n\n#include <cstddef>\n#include <cstdint>\n\n";
+    out << "namespace " << id << "\n{\n\n";
+    out << "constexpr std::size_t states = " << (std::uint64_t)rows << ";\n";
+    out << "constexpr std::size_t start = " << (std::uint64_t)start << ";\n";
+    out << "constexpr std::size_t dead = " << (std::uint64_t)dead << ";       // rejects the rest of the input\n\n";
+    out << "// letters of the automaton\nconstexpr const char *symbols[" << (std::uint64_t)std::max<std::size_t>(symbols, 1) << "] = {";
+    for(std::size_t a = 0; a < symbols; ++a)
+    {
+        out << (a == 0 ? "\"" : ", \"");
+        for(auto c = automaton.alphabet[a].begin(); c != automaton.alphabet[a].end(); ++c)
+        {
+            if(*c == '"' || *c == '\\') out << '\\';
+            out << *c;
+        }
+        out << "\"";
+    }
+    out << "};\n\n";
+
+    out << "// input byte -> symbol, " << (std::uint64_t)symbols << " -> the byte is not a letter\n";
+    out << "constexpr " << (symbols < 256 ? "std::uint8_t" : "std::uint16_t") << " symbol_of[256] = {";
+    std::vector<std::size_t> symbol_of(256, symbols);
+    for(std::size_t a = 0; a < symbols; ++a)
+        symbol_of[byte_of(a)] = a;
+    for(std::size_t b = 0; b < 256; ++b)
+        out << (b % 32 == 0 ? "\n    " : "") << (std::uint64_t)symbol_of[b] << (b + 1 < 256 ? "," : "");
+    out << "};\n\n";
+
+    out << "constexpr bool accepting[" << (std::uint64_t)rows << "] = {";
+    for(std::size_t q = 0; q < rows; ++q)
+        out << (q % 32 == 0 ? "\n    " : "") << (accepting[q] ? "1" : "0") << (q + 1 < rows ? "," : "");
+    out << "};\n\n";
+
+    out << "// transitions - table[state][symbol]\n";
+    out << "constexpr " << state_type << " table[" << (std::uint64_t)rows << "][" << (std::uint64_t)(symbols + 1) << "] = {\n";
+    for(std::size_t q = 0; q < rows; ++q)
+    {
+        out << "    {";
+        for(std::size_t a = 0; a <= symbols; ++a)
+            out << (a == 0 ? "" : ",") << (std::uint64_t)table[q * (symbols + 1) + a];
+        out << (q + 1 < rows ? "},\n" : "}\n");
+    }
+    out << "};\n\n";
+
+    out << "// returns true if the automaton accepts the input\n";
+    out << "inline bool match(const std::uint8_t *input, std::size_t length)\n{\n";
+    if(rows <= Matcher_switch_limit)
+    {
+        out << "    std::size_t state = start;\n";
+        out << "    for(std::size_t i = 0; i < length; ++i)\n    {\n        switch(state)\n        {\n";
+        for(std::size_t q = 0; q < rows; ++q)
+        {
+            if(q == dead) continue;
+            out << "        case " << (std::uint64_t)q << ":\n            switch(input[i])\n            {\n";
+            for(std::size_t a = 0; a < symbols; ++a)
+                if(table[q * (symbols + 1) + a] != dead)
+                    out << "                case " << byte_of(a) << ": state = " << (std::uint64_t)table[q * (symbols + 1) + a] << "; break;\n";
+            out << "                default: return false;\n            }\n            break;\n";
+        }
+        out << "        default: return false;\n        }\n    }\n";
+        out << "    return accepting[state];\n}\n\n";
+    }
+    else
+    {
+        out << "    std::size_t state = start;\n";
+        out << "    for(std::size_t i = 0; i < length; ++i)\n";
+        out << "        state = table[state][symbol_of[input[i]]];\n";
+        out << "    return accepting[state];\n}\n\n";
+    }
+    out << "inline bool match(const char *input, std::size_t length) { return match(reinterpret_cast<const std::uint8_t *>(input), length); }\n\n";
+    out << "} // namespace " << id << "\n\n#endif // " << guard << "\n";
+}
+
+// ---------------------------------------- RESULT CACHE -----------------------------------------
+
+// Function computes the fingerprint of automaton - two 64-bit hashes (FNV-1a and a multiplicative one) of its alphabet,
+// flags, states (name, start, final) and transitions in the order of the representation. Results of the algorithms
+// depend on that order, so equal fingerprints mean equal results. The name of the automaton is not hashed.
+// input: automaton - reference to FA
+// returns: 32 hexadecimal digits
+std::string Fingerprint_FA(const FA &automaton)
+{
+    std::uint64_t fnv = 14695981039346656037ULL, mix = 0x9e3779b97f4a7c15ULL;
+    auto add = [&](const std::string &text)
+    {
+        for(auto c = text.begin(); c != text.end(); ++c)
+        {
+            fnv = (fnv ^ (unsigned char)*c) * 1099511628211ULL;
+            mix = ((mix ^ (unsigned char)*c) * 0xff51afd7ed558ccdULL) ^ (mix >> 29);
+        }
+        fnv = (fnv ^ 0xff) * 1099511628211ULL;      // separator (no byte of a name)
+        mix = ((mix ^ 0xff) * 0xff51afd7ed558ccdULL) ^ (mix >> 29);
+    };
+
+    add(automaton.sink ? "sink" : "");
+    add(automaton.negated ? "negated" : "");
+    for(auto a = automaton.alphabet.begin(); a != automaton.alphabet.end(); ++a)
+        add(*a);
+    for(auto st = automaton.states.begin(); st != automaton.states.end(); ++st)
+    {
+        if(st->flag == -1) continue;    // deleted state
+        add(std::string(st->final_st ? "F" : "Q") + st->name);
+        for(auto const& x : st->transit_states_p)
+            if(x.second->flag != -1)
+            {
+                add(x.first);
+                add(x.second->name);
+            }
+        for(auto target = st->epsilon_p.begin(); target != st->epsilon_p.end(); ++target)
+            if((*target)->flag != -1) add("E" + (*target)->name);
+    }
+    for(auto st = automaton.start_states.begin(); st != automaton.start_states.end(); ++st)
+        if((*st)->flag != -1) add("S" + (*st)->name);
+
+    std::string hex(32, '0');
+    for(int i = 15; i >= 0; --i, fnv >>= 4, mix >>= 4)
+    {
+        hex[i] = "0123456789abcdef"[fnv & 15];
+        hex[i + 16] = "0123456789abcdef"[mix & 15];
+    }
+    return hex;
+}
+
+// Constructor of the cache, creates the directory.
+// input: directory1 - path of the directory of the entries
+// input: limit1 - maximal size of all entries (bytes)
+Result_cache::Result_cache(const std::string &directory1, std::uintmax_t limit1) : directory(directory1), limit(limit1)
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if(!std::filesystem::is_directory(directory, error)) throw Operation_error("Cache: cannot create directory " + directory + "!");
+}
+
+// Function returns the path of the entry, the kind is the extension of the file.
+std::string Result_cache::path(const std::string &kind, const std::string &key) const
+{
+    return (std::filesystem::path(directory) / (key + "." + kind)).string();
+}
+
+// Function reads the entry. The first line of every entry holds the version of the cache, its kind and key, an entry
+// written by another version is a miss. The access time of a hit is the modification time of the file (LRU order of evict).
+// input: kind - kind of the entry
+// input: key - fingerprint of the input automaton
+// input: data - reference to string, the entry without the first line (output)
+// returns: true - hit, false - miss
+bool Result_cache::read(const std::string &kind, const std::string &key, std::string &data) const
+{
+    std::ifstream file(path(kind, key), std::ios::binary);
+    std::string header;
+    if(!file || !std::getline(file, header) || header != "bakalarka-cache v" + std::to_string(version) + " " + kind + " " + key) return false;
+    std::ostringstream text;
+    text << file.rdbuf();
+    data = text.str();
+
+    std::error_code error;
+    std::filesystem::last_write_time(path(kind, key), std::filesystem::file_time_type::clock::now(), error);
+    return true;
+}
+
+// Function writes the entry under a temporary name and renames it, then removes entries over the limit.
+// input: kind - kind of the entry
+// input: key - fingerprint of the input automaton
+// input: data - reference to the entry without the first line
+// returns: void
+void Result_cache::write(const std::string &kind, const std::string &key, const std::string &data)
+{
+    static std::atomic<unsigned long> written(0);
+    std::string target = path(kind, key);
+    std::string temporary = target + ".tmp" + std::to_string(getpid()) + "-" + std::to_string(written++);
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        file << "bakalarka-cache v" << version << " " << kind << " " << key << "\n" << data;
+        if(!file) return;       // the cache is only an optimization, failed writes are ignored
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, target, error);
+    if(error) std::filesystem::remove(temporary, error);
+    else evict();
+}
+
+// Function removes the least recently used entries (the oldest modification time) until all entries fit into the limit.
+// Only files with a kind of the cache are counted.
+// returns: void
+void Result_cache::evict()
+{
+    typedef struct {
+        std::filesystem::file_time_type time;       // last use (write time, touched by hits)
+        std::filesystem::path path;
+        std::uintmax_t size;
+    } Entry;
+    std::vector<Entry> entries;
+    std::uintmax_t total = 0;
+    std::error_code error;
+
+    for(std::filesystem::directory_iterator i(directory, error), end; !error && i != end; i.increment(error))
+    {
+        std::string extension = i->path().extension().string();
+        if(extension != ".simulation" && extension != ".reduced" && extension != ".minimal") continue;
+        std::uintmax_t size = i->file_size(error);
+        std::filesystem::file_time_type time = i->last_write_time(error);
+        if(error) { error.clear(); continue; }     // removed by another process
+        entries.push_back({time, i->path(), size});
+        total += size;
+    }
+    if(total <= limit) return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.time < b.time; });
+    for(auto i = entries.begin(); i != entries.end() && total > limit; ++i)
+    {
+        if(std::filesystem::remove(i->path, error)) total -= i->size;
+        error.clear();
+    }
+}
+
+// Function loads the simulation preorder of the automaton with the fingerprint key.
+// input: key - fingerprint of the automaton (Fingerprint_FA)
+// input: preorder - reference to relation (output, cleared by a hit)
+// returns: true - hit, false - miss
+bool Result_cache::load(const std::string &key, State_relation &preorder) const
+{
+    std::string data, first, second;
+    if(!read("simulation", key, data)) return false;
+    std::istringstream pairs(data);
+    preorder.clear();
+    while(pairs >> first >> second)
+        preorder.insert({first, second});
+    return true;
+}
+
+// Function stores the simulation preorder of the automaton with the fingerprint key, one pair of states per line.
+// input: key - fingerprint of the automaton (Fingerprint_FA)
+// input: preorder - reference to relation
+// returns: void
+void Result_cache::store(const std::string &key, const State_relation &preorder)
+{
+    std::ostringstream text;
+    {
+        Output_buffer out(text);
+        for(auto i = preorder.begin(); i != preorder.end(); ++i)
+            out << i->first << " " << i->second << "\n";
+    }
+    write("simulation", key, text.str());
+}
+
+// Function loads the derived automaton of the automaton with the fingerprint key. The name of the result is not stored,
+// the caller names it.
+// input: kind - kind of the derived automaton
+// input: key - fingerprint of the input automaton (Fingerprint_FA)
+// input: automaton - reference to FA (output)
+// returns: true - hit, false - miss
+bool Result_cache::load(const std::string &kind, const std::string &key, FA &automaton) const
+{
+    std::string data, line, letter;
+    std::vector<FA> automatons;
+    bool sink = false, negated = false;
+    if(!read(kind, key, data)) return false;
+
+    std::istringstream input(data);
+    if(!(input >> line >> sink >> negated) || line != "flags") return false;
+    try
+    {
+        parse_FA(automatons, input);
+    }
+    catch(const Parse_error &)
+    {
+        return false;
+    }
+    if(automatons.size() != 1) return false;
+
+    // parse_FA sorts the alphabet, the order of the entry (line Ops) is kept
+    input.clear();
+    input.seekg(0);
+    std::getline(input, line);
+    std::getline(input, line);
+    std::istringstream letters(line);
+    automatons[0].alphabet.clear();
+    for(letters >> letter; letters >> letter; )
+        if(letter.size() > 2 && letter.compare(letter.size() - 2, 2, ":1") == 0) automatons[0].alphabet.push_back(letter.substr(0, letter.size() - 2));
+    automatons[0].transitions.clear();
+    automatons[0].sink = sink;
+    automatons[0].negated = negated;
+    automaton = std::move(automatons[0]);
+    return true;
+}
+
+// Function stores the derived automaton of the automaton with the fingerprint key - flags (implicit sink, negation)
+// and Timbuk format with the final states of the representation.
+// input: kind - kind of the derived automaton
+// input: key - fingerprint of the input automaton (Fingerprint_FA)
+// input: automaton - reference to FA
+// returns: void
+void Result_cache::store(const std::string &kind, const std::string &key, const FA &automaton)
+{
+    std::ostringstream text;
+    {
+        Output_buffer out(text);
+        out << "flags " << (automaton.sink ? '1' : '0') << " " << (automaton.negated ? '1' : '0') << "\nOps";
+        for(auto a = automaton.alphabet.begin(); a != automaton.alphabet.end(); ++a)
+            out << " " << *a << ":1";
+        out << " l:0" << "\n\n" << "Automaton cached\nStates";
+        for(auto j = automaton.states.begin(); j != automaton.states.end(); ++j)
+            if(j->flag != -1) out << " " << j->name;
+        out << "\n" << "Final States";
+        for(auto j = automaton.states.begin(); j != automaton.states.end(); ++j)
+            if(j->flag != -1 && j->final_st) out << " " << j->name;
+        out << "\n" << "Transitions" << "\n";
+        for(auto j = automaton.start_states.begin(); j != automaton.start_states.end(); ++j)
+            if((*j)->flag != -1) out << "l -> " << (*j)->name << "\n";
+        for(auto j = automaton.states.begin(); j != automaton.states.end(); ++j)
+        {
+            if(j->flag == -1) continue; // deleted state
+            for(auto const& x : j->transit_states_p)
+                if(x.second->flag != -1) out << x.first << "(" << j->name << ") -> " << x.second->name << "\n";
+            for(auto target = j->epsilon_p.begin(); target != j->epsilon_p.end(); ++target)
+                if((*target)->flag != -1) out << Epsilon_letter << "(" << j->name << ") -> " << (*target)->name << "\n";
+        }
+    }
+    write(kind, key, text.str());
+}
+
+// --------------------------------------------------------------------------------
+//                              TREE AUTOMATA
+// --------------------------------------------------------------------------------
+
+// ---------------------------------------- PARSER AND OUTPUT -----------------------------------------
+
+// Function finds a state of the tree automaton by its name.
+// input: names - reference to hash table of state names of the automaton
+// input: name - name of the state
+// returns: index of the state, throws Parse_error for an unknown state
+std::size_t TA_state(const std::unordered_map<std::string, std::size_t> &names, const std::string &name)
+{
+    auto found = names.find(name);
+    if(found == names.end()) throw Parse_error("Parsing error: unknown state " + name + "!");
+    return found->second;
+}
+
+// Parses tree automatons in Timbuk format (symbols of any arity, transitions f(q1,...,qn) -> q and a -> q) from the
+// input stream (stdin by default) and saves them into automatons. Declared arities of the states (q:0) are ignored.
+// input: automatons - reference to vector<TA>
+// input: input - reference to input stream
+// returns: void, throws Parse_error
+void parse_TA(std::vector<TA> &automatons, std::istream &input)
+{
+    std::map<std::string, std::size_t> ranks;       // ranked alphabet of the last Ops
+    std::unordered_map<std::string, std::size_t> names;    // names of the states of the last automaton
+    std::string word;                               // word received from stdin
+    std::string left;                               // left side of the transition (it may contain spaces)
+    int state = 0;                                  // state of the parsing automaton
+
+    while(input >> word)
+    {
+        // states of the automaton
+        if(word == "Ops" && (state == 0 || state == 6)) {ranks.clear();state = 1;continue;}  // alphabet
+        else if(word == "Automaton" && (state == 1 || state == 6)) {state = 2;continue;}    // automaton name
+        else if(word == "States" && state == 2) {state = 3;continue;}                       // states
+        else if(word == "Final" && state == 3) {state = 4;continue;}
+        else if(word == "States" && state == 4) {state = 5;continue;}                       // final states
+        else if(word == "Transitions" && state == 5) {state = 6;continue;}                  // transitions
+
+        if(state == 1) // reads ranked alphabet
+        {
+            std::size_t colon = word.find(":");
+            std::string arity = (colon == std::string::npos) ? "" : word.substr(colon + 1);
+            if(arity.empty() || !std::all_of(arity.begin(), arity.end(), [](char c) { return std::isdigit((unsigned char)c); }))
+                throw Parse_error("Parsing error: symbol " + word + " without arity!");
+            ranks[word.substr(0, colon)] = std::stoul(arity);
+        }
+        else if(state == 2) // reads name of the automaton and assigns the alphabet
+        {
+            automatons.push_back(TA());
+            automatons.back().name = word;
+            automatons.back().ranks = ranks;
+            names.clear();
+        }
+        else if(state == 3) // reads a list of states
+        {
+            std::string name = word.substr(0, word.find(":"));
+            if(names.insert({name, automatons.back().states.size()}).second)
+            {
+                automatons.back().states.push_back(name);
+                automatons.back().final_st.push_back(false);
+            }
+        }
+        else if(state == 5) // reads a list of final states
+        {
+            automatons.back().final_st[TA_state(names, word.substr(0, word.find(":")))] = true;
+        }
+        else if(state == 6) // parses transitions f(q1,...,qn) -> q
+        {
+            if(word != "->") { left += word; continue; }
+            if(!(input >> word)) break;
+            TA_transition transition;
+            std::size_t bracket = left.find("(");
+            transition.symbol = left.substr(0, bracket);
+            if(bracket != std::string::npos)
+            {
+                std::string child;
+                std::istringstream list(left.substr(bracket + 1, left.rfind(")") - bracket - 1));
+                while(std::getline(list, child, ','))
+                    transition.children.push_back(TA_state(names, child));
+            }
+            transition.target = TA_state(names, word);
+            auto rank = automatons.back().ranks.find(transition.symbol);
+            if(rank == automatons.back().ranks.end() || rank->second != transition.children.size())
+                throw Parse_error("Parsing error: wrong arity of " + left + "!");
+            automatons.back().transitions.push_back(transition);
+            left.clear();
+        }
+    }
+
+    if(state != 6 || !left.empty()) {throw Parse_error("Parsing error!");}    // parsing must end with transitions
+    for(auto autom = automatons.begin(); autom != automatons.end(); ++autom)
+        Index_TA(*autom);
+}
+
+// Function prints the tree automaton in Timbuk format.
+// input: automaton - reference to TA
+// input: out - reference to output buffer
+// returns: void
+void Print_TA(const TA &automaton, Output_buffer &out)
+{
+    out << "Ops";
+    for(auto a = automaton.ranks.begin(); a != automaton.ranks.end(); ++a)
+        out << " " << a->first << ":" << (std::uint64_t)a->second;
+    out << "\n\n" << "Automaton " << automaton.name << "\n" << "States";
+    for(auto q = automaton.states.begin(); q != automaton.states.end(); ++q)
+        out << " " << *q;
+    out << "\n" << "Final States";
+    for(std::size_t q = 0; q < automaton.states.size(); ++q)
+        if(automaton.final_st[q]) out << " " << automaton.states[q];
+    out << "\n" << "Transitions" << "\n";
+    for(auto t = automaton.transitions.begin(); t != automaton.transitions.end(); ++t)
+    {
+        out << t->symbol;
+        for(std::size_t i = 0; i < t->children.size(); ++i)
+            out << (i == 0 ? "(" : ",") << automaton.states[t->children[i]];
+        if(!t->children.empty()) out << ")";
+        out << " -> " << automaton.states[t->target] << "\n";
+    }
+    out << "\n";
+}
+
+// Function rebuilds the indexes of the transition table - transitions by symbol and children (lookup), by symbol and
+// the transitions in which every state appears as a child (parents), used by the incremental fixpoint computations.
+// input: automaton - reference to TA
+// returns: void
+void Index_TA(TA &automaton)
+{
+    automaton.lookup.clear();
+    automaton.by_symbol.clear();
+    automaton.parents.assign(automaton.states.size(), std::vector<std::size_t>());
+    for(std::size_t t = 0; t < automaton.transitions.size(); ++t)
+    {
+        const TA_transition &transition = automaton.transitions[t];
+        automaton.lookup[{transition.symbol, transition.children}].push_back(t);
+        automaton.by_symbol[transition.symbol].push_back(t);
+        for(auto child = transition.children.begin(); child != transition.children.end(); ++child)
+            automaton.parents[*child].push_back(t);
+    }
+}
+
+// ---------------------------------------- EMPTINESS AND USELESS STATES -----------------------------------------
+
+// Function computes the states reachable bottom-up (states of the roots of some trees). Every transition counts its
+// children that are not reached yet, a newly reached state decrements only the transitions in which it is a child.
+// input: automaton - reference to TA
+// returns: reached[q] -> state q is reachable
+std::vector<bool> Reachable_TA(const TA &automaton)
+{
+    std::vector<bool> reached(automaton.states.size(), false);
+    std::vector<std::size_t> missing(automaton.transitions.size());     // positions of children not reached yet
+    std::stack<std::size_t> W;
+
+    auto reach = [&](std::size_t q) { if(!reached[q]) { reached[q] = true; W.push(q); } };
+    for(std::size_t t = 0; t < automaton.transitions.size(); ++t)
+    {
+        missing[t] = automaton.transitions[t].children.size();
+        if(missing[t] == 0) reach(automaton.transitions[t].target);     // leaves
+    }
+    while(!W.empty())
+    {
+        std::size_t q = W.top();
+        W.pop();
+        STATS_INC(emptiness_visited);
+        for(auto t = automaton.parents[q].begin(); t != automaton.parents[q].end(); ++t)
+            if(--missing[*t] == 0) reach(automaton.transitions[*t].target);
+    }
+    return reached;
+}
+
+// Function checks if the language of the tree automaton is empty - no final state is reachable bottom-up.
+// input: automaton - reference to TA
+// returns: true - language is empty, false - it is not empty
+bool Emptiness_TA(const TA &automaton)
+{
+    std::vector<bool> reached = Reachable_TA(automaton);
+    for(std::size_t q = 0; q < automaton.states.size(); ++q)
+        if(reached[q] && automaton.final_st[q]) return false;
+    return true;
+}
+
+// Function removes useless states of the tree automaton - states that are not reachable bottom-up and states that
+// cannot be extended to an accepted tree (not reachable top-down from a reachable final state).
+// input: automaton - reference to TA
+// returns: void
+void Remove_useless_TA(TA &automaton)
+{
+    std::vector<bool> reached = Reachable_TA(automaton);
+    std::vector<bool> useful(automaton.states.size(), false);
+    std::vector<std::vector<std::size_t>> by_target(automaton.states.size());   // transitions with reachable children
+    std::vector<std::size_t> renamed(automaton.states.size());
+    std::stack<std::size_t> W;
+    TA result;
+
+    for(std::size_t t = 0; t < automaton.transitions.size(); ++t)
+    {
+        const TA_transition &transition = automaton.transitions[t];
+        if(std::all_of(transition.children.begin(), transition.children.end(), [&](std::size_t q) { return reached[q]; }))
+            by_target[transition.target].push_back(t);
+    }
+    for(std::size_t q = 0; q < automaton.states.size(); ++q)
+        if(reached[q] && automaton.final_st[q]) { useful[q] = true; W.push(q); }
+    while(!W.empty())
+    {
+        std::size_t q = W.top();
+        W.pop();
+        for(auto t = by_target[q].begin(); t != by_target[q].end(); ++t)
+            for(auto child = automaton.transitions[*t].children.begin(); child != automaton.transitions[*t].children.end(); ++child)
+                if(!useful[*child]) { useful[*child] = true; W.push(*child); }
+    }
+
+    result.name = automaton.name;
+    result.ranks = automaton.ranks;
+    for(std::size_t q = 0; q < automaton.states.size(); ++q)
+    {
+        if(!useful[q]) continue;
+        renamed[q] = result.states.size();
+        result.states.push_back(automaton.states[q]);
+        result.final_st.push_back(automaton.final_st[q]);
+    }
+    for(auto t = automaton.transitions.begin(); t != automaton.transitions.end(); ++t)
+    {
+        if(!useful[t->target] || !std::all_of(t->children.begin(), t->children.end(), [&](std::size_t q) { return useful[q]; })) continue;
+        result.transitions.push_back(*t);
+        result.transitions.back().target = renamed[t->target];
+        for(auto child = result.transitions.back().children.begin(); child != result.transitions.back().children.end(); ++child)
+            *child = renamed[*child];
+    }
+    Index_TA(result);
+    automaton = std::move(result);
+}
+
+// ---------------------------------------- PRODUCT -----------------------------------------
+
+// Function computes the product (intersection) of two tree automata bottom-up, only reachable pairs of states are created.
+// A new pair (p,q) is combined only with transitions of automaton1 with p as a child and transitions of automaton2
+// with q at the same position, the transition of the product is created when all pairs of its children exist.
+// input: automaton1 - reference to first automaton
+// input: automaton2 - reference to second automaton
+// input: result_automaton - reference to result automaton
+// returns: void
+void Intersection_TA(const TA &automaton1, const TA &automaton2, TA &result_automaton)
+{
+    std::map<std::pair<std::size_t,std::size_t>, std::size_t> pairs;      // (state1, state2) -> state of the product
+    std::vector<std::pair<std::size_t,std::size_t>> components;             // state of the product -> (state1, state2)
+    std::set<std::pair<std::size_t,std::size_t>> created;                   // pairs of transitions already in the product
+    std::queue<std::size_t> W;
+
+    result_automaton.name = automaton1.name + "&" + automaton2.name;
+    for(auto a = automaton1.ranks.begin(); a != automaton1.ranks.end(); ++a)
+    {
+        auto b = automaton2.ranks.find(a->first);
+        if(b != automaton2.ranks.end() && b->second == a->second) result_automaton.ranks.insert(*a);
+    }
+
+    auto state = [&](std::size_t p, std::size_t q) -> std::size_t
+    {
+        auto found = pairs.insert({{p, q}, result_automaton.states.size()});
+        if(found.second)
+        {
+            STATS_INC(product_states);
+            result_automaton.states.push_back("[" + automaton1.states[p] + "|" + automaton2.states[q] + "]");
+            result_automaton.final_st.push_back(automaton1.final_st[p] && automaton2.final_st[q]);
+            components.push_back({p, q});
+            W.push(found.first->second);
+        }
+        return found.first->second;
+    };
+    auto add = [&](std::size_t t1, std::size_t t2)
+    {
+        if(!created.insert({t1, t2}).second) return;
+        const TA_transition &tr1 = automaton1.transitions[t1], &tr2 = automaton2.transitions[t2];
+        TA_transition transition;
+        transition.symbol = tr1.symbol;
+        for(std::size_t i = 0; i < tr1.children.size(); ++i)
+            transition.children.push_back(pairs.at({tr1.children[i], tr2.children[i]}));
+        transition.target = state(tr1.target, tr2.target);
+        result_automaton.transitions.push_back(transition);
+        STATS_INC(product_transitions);
+    };
+
+    // leaves
+    for(auto a = result_automaton.ranks.begin(); a != result_automaton.ranks.end(); ++a)
+    {
+        if(a->second != 0) continue;
+        auto leaves1 = automaton1.by_symbol.find(a->first), leaves2 = automaton2.by_symbol.find(a->first);
+        if(leaves1 == automaton1.by_symbol.end() || leaves2 == automaton2.by_symbol.end()) continue;
+        for(auto t1 = leaves1->second.begin(); t1 != leaves1->second.end(); ++t1)
+            for(auto t2 = leaves2->second.begin(); t2 != leaves2->second.end(); ++t2)
+                add(*t1, *t2);
+    }
+
+    // main loop - until queue is empty
+    while(!W.empty())
+    {
+        std::size_t p = components[W.front()].first, q = components[W.front()].second;
+        W.pop();
+        for(auto t1 = automaton1.parents[p].begin(); t1 != automaton1.parents[p].end(); ++t1)
+        {
+            const TA_transition &tr1 = automaton1.transitions[*t1];
+            for(auto t2 = automaton2.parents[q].begin(); t2 != automaton2.parents[q].end(); ++t2)
+            {
+                const TA_transition &tr2 = automaton2.transitions[*t2];
+                if(tr1.symbol != tr2.symbol || tr1.children.size() != tr2.children.size()) continue;
+                bool complete = true;   // all pairs of children are states of the product
+                for(std::size_t i = 0; i < tr1.children.size() && complete; ++i)
+                    complete = pairs.find({tr1.children[i], tr2.children[i]}) != pairs.end();
+                if(complete) add(*t1, *t2);
+            }
+        }
+    }
+    Index_TA(result_automaton);
+}
+
+// ---------------------------------------- DETERMINIZATION -----------------------------------------
+
+// Function computes the states reachable by the symbol from a tuple of macro states. Transitions are either looked up
+// for every tuple of states of the macro states or filtered from all transitions of the symbol, whichever is smaller.
+// input: automaton - reference to TA
+// input: symbol - reference to the symbol
+// input: children - reference to the tuple of macro states
+// input: result - reference to the macro state of the targets (output)
+// returns: void
+void Post_TA(const TA &automaton, const std::string &symbol, const std::vector<const TA_macro *> &children, TA_macro &result)
+{
+    auto transitions = automaton.by_symbol.find(symbol);
+    result.states.clear();
+    result.member.assign(automaton.states.size(), false);
+    if(transitions == automaton.by_symbol.end()) return;
+
+    auto target = [&](std::size_t t)
+    {
+        std::size_t q = automaton.transitions[t].target;
+        if(!result.member[q]) { result.member[q] = true; result.states.push_back(q); }
+    };
+
+    double tuples = 1;
+    for(auto child = children.begin(); child != children.end(); ++child)
+        tuples *= (*child)->states.size();
+    if(tuples < transitions->second.size())
+    {
+        std::vector<std::size_t> position(children.size(), 0);
+        std::pair<std::string, std::vector<std::size_t>> key(symbol, std::vector<std::size_t>(children.size()));
+        if(tuples == 0) return;
+        while(true)
+        {
+            for(std::size_t i = 0; i < children.size(); ++i)
+                key.second[i] = children[i]->states[position[i]];
+            auto found = automaton.lookup.find(key);
+            if(found != automaton.lookup.end())
+                for(auto t = found->second.begin(); t != found->second.end(); ++t)
+                    target(*t);
+            std::size_t i = 0;
+            while(i < children.size() && ++position[i] == children[i]->states.size()) position[i++] = 0;
+            if(i == children.size()) break;
+        }
+    }
+    else
+    {
+        for(auto t = transitions->second.begin(); t != transitions->second.end(); ++t)
+        {
+            const std::vector<std::size_t> &states = automaton.transitions[*t].children;
+            bool enabled = true;
+            for(std::size_t i = 0; i < states.size() && enabled; ++i)
+                enabled = children[i]->member[states[i]];
+            if(enabled) target(*t);
+        }
+    }
+    std::sort(result.states.begin(), result.states.end());
+}
+
+// Function implements bottom-up determinization of the tree automaton (subset construction). A new macro state is
+// combined only with tuples of already processed macro states that contain it.
+// input: automaton1 - reference to source automaton
+// input: result_automaton - reference to result automaton (deterministic, not complete - empty macro state is left out)
+// returns: void
+void Determinization_TA(const TA &automaton1, TA &result_automaton)
+{
+    std::map<std::vector<std::size_t>, std::size_t> opt_Q;     // macro state -> state of the result
+    std::vector<TA_macro> macro;                                // state of the result -> macro state
+    std::vector<std::size_t> processed;                         // processed states of the result
+    std::queue<std::size_t> W;
+    TA_macro post;
+
+    result_automaton.name = "det" + automaton1.name;
+    result_automaton.ranks = automaton1.ranks;
+
+    // returns the state of the macro state, a new one is pushed to W
+    auto state = [&](const TA_macro &set) -> std::size_t
+    {
+        auto found = opt_Q.insert({set.states, result_automaton.states.size()});
+        if(!found.second) { STATS_INC(det_duplicates); return found.first->second; }
+        STATS_INC(det_macro_states);
+        std::string name = "|";
+        bool final = false;
+        for(auto q = set.states.begin(); q != set.states.end(); ++q)
+        {
+            name += automaton1.states[*q] + "|";
+            if(automaton1.final_st[*q]) final = true;
+        }
+        result_automaton.states.push_back(name);
+        result_automaton.final_st.push_back(final);
+        macro.push_back(set);
+        W.push(found.first->second);
+        return found.first->second;
+    };
+    auto add = [&](const std::string &symbol, const std::vector<std::size_t> &children)
+    {
+        std::vector<const TA_macro *> sets;
+        for(auto child = children.begin(); child != children.end(); ++child)
+            sets.push_back(&macro[*child]);
+        Post_TA(automaton1, symbol, sets, post);
+        if(post.states.empty()) return;
+        std::size_t target = state(post);   // may reallocate macro, sets are not used after it
+        result_automaton.transitions.push_back({symbol, children, target});
+    };
+
+    // leaves
+    for(auto a = automaton1.ranks.begin(); a != automaton1.ranks.end(); ++a)
+        if(a->second == 0) add(a->first, {});
+
+    // main loop - until queue is empty
+    while(!W.empty())
+    {
+        std::size_t current = W.front();
+        W.pop();
+        processed.push_back(current);
+        for(auto a = automaton1.ranks.begin(); a != automaton1.ranks.end(); ++a)
+        {
+            std::size_t arity = a->second;
+            // tuples of processed macro states with the first occurrence of current at position first
+            for(std::size_t first = 0; first < arity; ++first)
+            {
+                std::vector<std::size_t> position(arity, 0), children(arity);
+                bool next = (first == 0 || processed.size() > 1);   // positions before first need another macro state
+                while(next)
+                {
+                    for(std::size_t i = 0; i < arity; ++i)
+                        children[i] = (i == first) ? current : processed[position[i]];
+                    add(a->first, children);
+
+                    next = false;
+                    for(std::size_t i = 0; i < arity && !next; ++i)
+                    {
+                        if(i == first) continue;
+                        std::size_t bound = (i < first) ? processed.size() - 1 : processed.size();     // current is processed.back()
+                        if(++position[i] < bound) next = true;
+                        else position[i] = 0;
+                    }
+                }
+            }
+        }
+    }
+    Index_TA(result_automaton);
+}
+
+// ---------------------------------------- INCLUSION -----------------------------------------
+
+// Function implements the antichain Inclusion algorithm of tree automata. Explores bottom-up pairs (p, S) - a tree
+// reaches state p of automaton1 and exactly the macro state S of automaton2. A pair (p, S) subsumes (p, S') with S <= S',
+// only minimal pairs are kept. Inclusion does not hold if a pair with final p and rejecting S is found.
+// input: automaton1 - reference to first automaton
+// input: automaton2 - reference to second automaton
+// returns: true if L(automaton1) is subset of L(automaton2), false otherwise
+bool Inclusion_TA(const TA &automaton1, const TA &automaton2)
+{
+    std::vector<std::vector<TA_macro>> processed(automaton1.states.size());     // state of automaton1 -> processed macro states
+    std::vector<TA_product> next, created;      // pairs to process, pairs created from one processed pair
+    TA_product product;
+
+    auto subset = [](const TA_macro &subs, const TA_macro &super)
+    {
+        STATS_INC(subset_calls);
+        return std::includes(super.states.begin(), super.states.end(), subs.states.begin(), subs.states.end());
+    };
+    // returns false if the pair is a counterexample, pairs subsumed by the new pair are removed
+    auto insert = [&](TA_product &pair) -> bool
+    {
+        std::vector<TA_macro> &same = processed[pair.state];
+        for(auto S = same.begin(); S != same.end(); ++S)
+            if(subset(*S, pair.macro)) { STATS_INC(antichain_pruned); return true; }
+        for(auto S = next.begin(); S != next.end(); ++S)
+            if(S->state == pair.state && subset(S->macro, pair.macro)) { STATS_INC(antichain_pruned); return true; }
+
+        if(automaton1.final_st[pair.state] && std::none_of(pair.macro.states.begin(), pair.macro.states.end(),
+                                                         [&](std::size_t q) { return automaton2.final_st[q]; }))
+            return false;
+
+        std::size_t before = same.size() + next.size();
+        same.erase(std::remove_if(same.begin(), same.end(), [&](const TA_macro &S) { return subset(pair.macro, S); }), same.end());
+        next.erase(std::remove_if(next.begin(), next.end(), [&](const TA_product &S)
+                                  { return S.state == pair.state && subset(pair.macro, S.macro); }), next.end());
+        STATS_ADD(antichain_removed, before - same.size() - next.size());
+        next.push_back(std::move(pair));
+        return true;
+    };
+
+    // leaves
+    for(auto t = automaton1.transitions.begin(); t != automaton1.transitions.end(); ++t)
+    {
+        if(!t->children.empty()) continue;
+        product.state = t->target;
+        Post_TA(automaton2, t->symbol, {}, product.macro);
+        if(!insert(product)) return false;
+    }
+
+    // main loop
+    while(!next.empty())
+    {
+        TA_product current = std::move(next.back());
+        next.pop_back();
+        processed[current.state].push_back(current.macro);
+        STATS_INC(antichain_processed);
+
+        created.clear();
+        for(auto t = automaton1.parents[current.state].begin(); t != automaton1.parents[current.state].end(); ++t)
+        {
+            const TA_transition &transition = automaton1.transitions[*t];
+            std::vector<std::size_t> position(transition.children.size(), 0);
+            std::vector<const TA_macro *> children(transition.children.size());
+            if(t != automaton1.parents[current.state].begin() && *(t - 1) == *t) continue;     // positions of one transition are adjacent
+
+            // current is at position at, other positions use processed macro states of their states
+            for(std::size_t at = 0; at < transition.children.size(); ++at)
+            {
+                if(transition.children[at] != current.state) continue;
+                bool next_tuple = true;
+                for(std::size_t i = 0; i < transition.children.size(); ++i)
+                    if(i != at && processed[transition.children[i]].empty()) next_tuple = false;
+                std::fill(position.begin(), position.end(), 0);
+                while(next_tuple)
+                {
+                    for(std::size_t i = 0; i < transition.children.size(); ++i)
+                        children[i] = (i == at) ? &processed[current.state].back() : &processed[transition.children[i]][position[i]];
+                    product.state = transition.target;
+                    Post_TA(automaton2, transition.symbol, children, product.macro);
+                    created.push_back(product);
+
+                    next_tuple = false;
+                    for(std::size_t i = 0; i < transition.children.size() && !next_tuple; ++i)
+                    {
+                        if(i == at) continue;
+                        if(++position[i] < processed[transition.children[i]].size()) next_tuple = true;
+                        else position[i] = 0;
+                    }
+                }
+            }
+        }
+        for(auto pair = created.begin(); pair != created.end(); ++pair)
+            if(!insert(*pair)) return false;
+    }
+    return true;
+}
+
+// --------------------------------------------------------------------------------
+//                              AUTOMATON INTERFACE
+// --------------------------------------------------------------------------------
+// The shared automaton is only read. Algorithms that change the representation of their operands (explicit sink,
+// numbering of the states, reversing) work on private copies, so copies of one Automaton can be used by several threads.
+
+Automaton::Automaton(FA automaton1) : automaton(std::move(automaton1)) {}
+
+// Function parses all automatons of the input stream.
+// input: input - reference to input stream (Timbuk format)
+// returns: vector of automatons, throws Parse_error
+std::vector<Automaton> Automaton::parse(std::istream &input)
+{
+    std::vector<FA> automatons;
+    std::vector<Automaton> result;
+    parse_FA(automatons, input);
+    for(auto autom = automatons.begin(); autom != automatons.end(); ++autom)
+        result.push_back(Automaton(std::move(*autom)));
+    return result;
+}
+
+void Automaton::serialize(std::ostream &out) const { Print_timbuk(automaton.read(), out); }
+
+void Automaton::export_matcher(std::ostream &out) const
+{
+    Output_buffer buffer(out);
+    Export_matcher(automaton.read(), automaton.read().name, buffer);
+}
+
+std::string Automaton::to_string() const
+{
+    std::ostringstream out;
+    serialize(out);
+    return out.str();
+}
+
+Automaton Automaton::random(const Random_config &config)
+{
+    FA result_automaton;
+    Generate_FA(result_automaton, config);
+    return Automaton(std::move(result_automaton));
+}
+
+const FA &Automaton::get() const { return automaton.read(); }
+const std::string &Automaton::name() const { return automaton.read().name; }
+long Automaton::states() const { return Count_states(automaton.read()); }
+long Automaton::transitions() const { return Count_transitions(automaton.read()); }
+bool Automaton::is_deterministic() const { return Is_deterministic(automaton.read()); }
+
+bool Automaton::is_empty() const { return Emptiness_test(automaton.read()); }
+
+bool Automaton::is_universal() const
+{
+    FA work = automaton.read();
+    State_relation preorder;
+    Preorder(work, preorder);
+    return Universality_NFA(work, preorder);
+}
+
+// Union_FA renames clashing states of the second operand, so inclusion works on copies of both automatons.
+bool Automaton::is_included_in(const Automaton &other) const
+{
+    FA first = automaton.read(), second = other.automaton.read(), united;
+    State_relation preorder;
+    Union_FA(first, second, united);
+    Preorder(united, preorder);
+    return Inclusion_NFA(first, second, preorder);
+}
+
+// Hopcroft-Karp on copies of both automatons (Equivalence_FA materializes the states).
+bool Automaton::is_equivalent_to(const Automaton &other, std::vector<std::string> *word) const
+{
+    FA first = automaton.read(), second = other.automaton.read();
+    return Equivalence_FA(first, second, word);
+}
+
+// Function simulates the automaton on the word (set of current states), works for NFA and DFA.
+// input: word - symbols of the word
+// returns: true - word is accepted
+bool Automaton::accepts(const std::vector<std::string> &word) const
+{
+    Bit_NFA compiled;
+    Compile_bit_NFA(automaton.read(), compiled);
+    return Member_NFA(compiled, word);
+}
+
+// Function checks membership of many words, the automaton is compiled once (see Member_batch).
+// input: words - words, symbols of every word
+// returns: accepted[i] -> words[i] is accepted
+std::vector<bool> Automaton::accepts_all(const std::vector<std::vector<std::string>> &words) const
+{
+    Bit_NFA compiled;
+    std::vector<bool> accepted;
+    Compile_bit_NFA(automaton.read(), compiled);
+    Member_batch(compiled, words, accepted);
+    return accepted;
+}
+
+State_relation Automaton::simulation() const
+{
+    FA work = automaton.read();
+    State_relation preorder;
+    Preorder(work, preorder);
+    return preorder;
+}
+
+Automaton Automaton::intersection(const Automaton &other) const
+{
+    FA first = automaton.read(), second = other.automaton.read(), result_automaton;
+    Intersection_FA(first, second, result_automaton);
+    return Automaton(std::move(result_automaton));
+}
+
+Automaton Automaton::intersection(const std::vector<Automaton> &automatons)
+{
+    std::list<FA> copies;
+    std::vector<FA *> operands;
+    FA result_automaton;
+    for(auto autom = automatons.begin(); autom != automatons.end(); ++autom)
+    {
+        copies.push_back(autom->automaton.read());
+        operands.push_back(&copies.back());
+    }
+    Intersection_k_FA(operands, result_automaton);
+    return Automaton(std::move(result_automaton));
+}
+
+// both operands are copied, Union_FA renames clashing states of the second one
+Automaton Automaton::union_with(const Automaton &other) const
+{
+    FA first = automaton.read(), second = other.automaton.read(), result_automaton;
+    Union_FA(first, second, result_automaton);
+    return Automaton(std::move(result_automaton));
+}
+
+Automaton Automaton::determinize(bool complete, bool simulation) const
+{
+    FA work = automaton.read(), result_automaton;
+    if(simulation)
+    {
+        State_relation preorder;
+        Preorder(work, preorder);
+        Determinization_FA(work, result_automaton, complete, &preorder);
+    }
+    else Determinization_FA(work, result_automaton, complete);
+    return Automaton(std::move(result_automaton));
+}
+
+Automaton Automaton::minimize(Minimalization_method method) const
+{
+    FA work = automaton.read(), result_automaton;
+    Minimalization_NFA(work, result_automaton, method);
+    return Automaton(std::move(result_automaton));
+}
+
+// complement is correct only for a complete DFA, DFA is completed by the implicit sink
+// (an automaton without start states is completed by determinization, it gets the start sink)
+Automaton Automaton::complement() const
+{
+    Automaton result;
+    if(automaton.read().start_states.size() == 1 && Is_deterministic(automaton.read()))
+    {
+        result = *this;
+        result.automaton.write().sink = true;
+    }
+    else result = determinize(true);
+    Complement_FA(result.automaton.write());
+    return result;
+}
+
+Automaton Automaton::trim() const
+{
+    FA result_automaton;
+    Remove_useless_states(automaton.read(), result_automaton);
+    return Automaton(std::move(result_automaton));
+}
+
+Automaton Automaton::reduce() const
+{
+    FA result_automaton;
+    Reduction_NFA(automaton.read(), result_automaton);
+    return Automaton(std::move(result_automaton));
+}
+
+Automaton Automaton::bisimulation_reduce(bool backward) const
+{
+    FA result_automaton;
+    Bisimulation_NFA(automaton.read(), result_automaton, backward);
+    return Automaton(std::move(result_automaton));
+}